@@ -36,6 +36,7 @@ void pull_parser_examples();
 void data_model_examples();
 void staj_iterator_examples();
 void bson_examples();
+void json_document_reader_examples();
 
 void comment_example()
 {
@@ -560,6 +561,8 @@ int main()
 
         staj_iterator_examples();
 
+        json_document_reader_examples();
+
         cbor_examples();
 
         readme_examples();
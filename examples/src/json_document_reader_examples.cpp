@@ -0,0 +1,51 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_document_reader.hpp>
+#include <string>
+#include <sstream>
+
+using namespace jsoncons;
+
+namespace {
+
+// Newline delimited JSON
+const std::string ndjson_example = R"({"id" : 1, "name" : "Tom", "tags" : ["a"]}
+{"id" : 2, "name" : "Catherine", "tags" : []}
+{"id" : 3, "name" : "William", "tags" : ["b","c"]}
+)";
+
+void read_documents_example()
+{
+    std::istringstream is(ndjson_example);
+    json_document_reader reader(is);
+
+    json record;
+    while (reader.read_next(record))
+    {
+        std::cout << record["id"] << ": " << record["name"] << "\n";
+    }
+    std::cout << "\n";
+}
+
+void document_iterator_example()
+{
+    json_string_document_reader reader(ndjson_example);
+
+    for (const auto& record : json_string_document_iterator(reader))
+    {
+        std::cout << record["tags"] << "\n";
+    }
+    std::cout << "\n";
+}
+
+}
+
+void json_document_reader_examples()
+{
+    std::cout << "\njson_document_reader examples\n\n";
+    read_documents_example();
+    document_iterator_example();
+    std::cout << std::endl;
+}
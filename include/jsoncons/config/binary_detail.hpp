@@ -156,6 +156,39 @@ static inline bool add_check_overflow(size_t v1, size_t v2, size_t *r)
 
 }
 
+// The byte order of scalar types
+
+enum class endian
+{
+#if defined(_MSC_VER)
+    little = 0,
+    big = 1,
+    native = little
+#else
+    little = __ORDER_LITTLE_ENDIAN__,
+    big = __ORDER_BIG_ENDIAN__,
+    native = __BYTE_ORDER__
+#endif
+};
+
+// Reverses the byte order of an integral or floating point value
+
+template<class T>
+typename std::enable_if<std::is_arithmetic<T>::value,T>::type
+byte_swap(T val)
+{
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &val, sizeof(T));
+    for (size_t i = 0; i < sizeof(T)/2; ++i)
+    {
+        uint8_t c = bytes[i];
+        bytes[i] = bytes[sizeof(T)-1-i];
+        bytes[sizeof(T)-1-i] = c;
+    }
+    std::memcpy(&val, bytes, sizeof(T));
+    return val;
+}
+
 inline 
 uint16_t encode_half(double val)
 {
@@ -10,6 +10,7 @@
 #include <string>
 #include <tuple>
 #include <array>
+#include <vector>
 #include <memory>
 #include <type_traits> // std::enable_if
 #include <jsoncons/json_content_handler.hpp>
@@ -47,6 +48,203 @@ void encode_stream(const T&val, basic_json_content_handler<CharT>& writer);
 
 namespace jsoncons {
 
+namespace detail {
+
+// A std::vector of typed array elements, that is written and read as a typed array
+template <class T>
+struct is_typed_array_vector : std::false_type {};
+
+template <class T, class Allocator>
+struct is_typed_array_vector<std::vector<T,Allocator>> 
+    : std::integral_constant<bool,is_typed_array_element<T>::value> {};
+
+// Decodes an array of numbers into a std::vector of typed array elements, 
+// a typed array is copied in one piece
+template <class CharT, class T>
+class typed_array_decoder final : public basic_json_content_handler<CharT>
+{
+public:
+    typedef typename T::value_type value_type;
+    using typename basic_json_content_handler<CharT>::string_view_type;
+private:
+    T result_;
+    size_t level_;
+    bool is_valid_;
+public:
+    typed_array_decoder()
+        : level_(0), is_valid_(true)
+    {
+    }
+
+    // False if the content was not an array of numbers
+    bool is_valid() const
+    {
+        return is_valid_;
+    }
+
+    T get_result()
+    {
+        return std::move(result_);
+    }
+private:
+    void do_flush() override
+    {
+    }
+
+    template <class U>
+    bool assign(const U* data, size_t size)
+    {
+        if (level_ > 0)
+        {
+            is_valid_ = false;
+            return false;
+        }
+        result_.assign(data, data + size);
+        return true;
+    }
+
+    template <class U>
+    bool push_back(U value)
+    {
+        if (level_ != 1)
+        {
+            is_valid_ = false;
+            return false;
+        }
+        result_.push_back(static_cast<value_type>(value));
+        return true;
+    }
+
+    bool invalid()
+    {
+        is_valid_ = false;
+        return false;
+    }
+
+    bool do_begin_array(semantic_tag_type, const serializing_context&) override
+    {
+        return ++level_ == 1 || invalid();
+    }
+
+    bool do_begin_array(size_t length, semantic_tag_type, const serializing_context&) override
+    {
+        if (++level_ != 1)
+        {
+            return invalid();
+        }
+        result_.reserve(length);
+        return true;
+    }
+
+    bool do_end_array(const serializing_context&) override
+    {
+        --level_;
+        return true;
+    }
+
+    bool do_begin_object(semantic_tag_type, const serializing_context&) override
+    {
+        return invalid();
+    }
+
+    bool do_end_object(const serializing_context&) override
+    {
+        return invalid();
+    }
+
+    bool do_name(const string_view_type&, const serializing_context&) override
+    {
+        return invalid();
+    }
+
+    bool do_null_value(semantic_tag_type, const serializing_context&) override
+    {
+        return invalid();
+    }
+
+    bool do_string_value(const string_view_type&, semantic_tag_type, const serializing_context&) override
+    {
+        return invalid();
+    }
+
+    bool do_byte_string_value(const byte_string_view&, byte_string_chars_format, semantic_tag_type, const serializing_context&) override
+    {
+        return invalid();
+    }
+
+    bool do_bool_value(bool, semantic_tag_type, const serializing_context&) override
+    {
+        return invalid();
+    }
+
+    bool do_int64_value(int64_t value, semantic_tag_type, const serializing_context&) override
+    {
+        return push_back(value);
+    }
+
+    bool do_uint64_value(uint64_t value, semantic_tag_type, const serializing_context&) override
+    {
+        return push_back(value);
+    }
+
+    bool do_double_value(double value, const floating_point_options&, semantic_tag_type, const serializing_context&) override
+    {
+        return push_back(value);
+    }
+
+    bool do_typed_array(const uint8_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+
+    bool do_typed_array(const uint16_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+
+    bool do_typed_array(const uint32_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+
+    bool do_typed_array(const uint64_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+
+    bool do_typed_array(const int8_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+
+    bool do_typed_array(const int16_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+
+    bool do_typed_array(const int32_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+
+    bool do_typed_array(const int64_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+
+    bool do_typed_array(const float* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+
+    bool do_typed_array(const double* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return assign(data, size);
+    }
+};
+
+}
+
 template <class T, class Enable = void>
 struct conversion_traits
 {
@@ -94,6 +292,19 @@ struct conversion_traits<T,
 
     template <class CharT>
     static void encode(const T& val, basic_json_content_handler<CharT>& writer)
+    {
+        encode(val, writer, jsoncons::detail::is_typed_array_vector<T>());
+        writer.flush();
+    }
+private:
+    template <class CharT>
+    static void encode(const T& val, basic_json_content_handler<CharT>& writer, std::true_type)
+    {
+        writer.typed_array(val.data(), val.size());
+    }
+
+    template <class CharT>
+    static void encode(const T& val, basic_json_content_handler<CharT>& writer, std::false_type)
     {
         writer.begin_array();
         for (auto it = std::begin(val); it != std::end(val); ++it)
@@ -101,7 +312,6 @@ struct conversion_traits<T,
             conversion_traits<value_type>::encode(*it,writer);
         }
         writer.end_array();
-        writer.flush();
     }
 };
 // std::array
@@ -8,6 +8,8 @@
 #define JSONCONS_JSON_CONTENT_HANDLER_HPP
 
 #include <string>
+#include <cstdint>
+#include <type_traits> // std::enable_if
 #include <jsoncons/json_exception.hpp>
 #include <jsoncons/jsoncons_utilities.hpp>
 #include <jsoncons/bignum.hpp>
@@ -33,6 +35,20 @@ enum class semantic_tag_type : uint8_t
     big_float
 };
 
+namespace detail {
+
+// The element types of typed arrays
+template <class T>
+struct is_typed_array_element : std::integral_constant<bool, 
+    std::is_same<T,uint8_t>::value || std::is_same<T,uint16_t>::value || 
+    std::is_same<T,uint32_t>::value || std::is_same<T,uint64_t>::value ||
+    std::is_same<T,int8_t>::value || std::is_same<T,int16_t>::value || 
+    std::is_same<T,int32_t>::value || std::is_same<T,int64_t>::value ||
+    std::is_same<T,float>::value || std::is_same<T,double>::value> 
+{};
+
+}
+
 template <class CharT>
 class basic_json_content_handler
 {
@@ -178,6 +194,17 @@ public:
         return do_null_value(tag, context);
     }
 
+    // An array of size numbers of the same type, T is one of uint8_t, uint16_t, 
+    // uint32_t, uint64_t, int8_t, int16_t, int32_t, int64_t, float and double
+    template <class T>
+    typename std::enable_if<jsoncons::detail::is_typed_array_element<T>::value,bool>::type
+    typed_array(const T* data, size_t size, 
+                semantic_tag_type tag = semantic_tag_type::none,
+                const serializing_context& context=null_serializing_context())
+    {
+        return do_typed_array(data, size, tag, context);
+    }
+
 #if !defined(JSONCONS_NO_DEPRECATED)
 
     bool begin_document()
@@ -296,6 +323,90 @@ private:
                                  const serializing_context& context) = 0;
 
     virtual bool do_bool_value(bool value, semantic_tag_type tag, const serializing_context& context) = 0;
+
+    // By default, typed arrays are written as arrays of their elements
+
+    virtual bool do_typed_array(const uint8_t* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    virtual bool do_typed_array(const uint16_t* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    virtual bool do_typed_array(const uint32_t* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    virtual bool do_typed_array(const uint64_t* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    virtual bool do_typed_array(const int8_t* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    virtual bool do_typed_array(const int16_t* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    virtual bool do_typed_array(const int32_t* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    virtual bool do_typed_array(const int64_t* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    virtual bool do_typed_array(const float* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    virtual bool do_typed_array(const double* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        return write_typed_array_elements(data, size, tag, context);
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_unsigned<T>::value,bool>::type
+    write_typed_array_element(T value, const serializing_context& context)
+    {
+        return do_uint64_value(value, semantic_tag_type::none, context);
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_signed<T>::value && std::is_integral<T>::value,bool>::type
+    write_typed_array_element(T value, const serializing_context& context)
+    {
+        return do_int64_value(value, semantic_tag_type::none, context);
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_floating_point<T>::value,bool>::type
+    write_typed_array_element(T value, const serializing_context& context)
+    {
+        return do_double_value(value, floating_point_options(), semantic_tag_type::none, context);
+    }
+
+    template <class T>
+    bool write_typed_array_elements(const T* data, size_t size, semantic_tag_type tag, const serializing_context& context)
+    {
+        do_begin_array(size, tag, context);
+        for (size_t i = 0; i < size; ++i)
+        {
+            write_typed_array_element(data[i], context);
+        }
+        return do_end_array(context);
+    }
 };
 
 template <class CharT>
@@ -0,0 +1,365 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_JSON_DOCUMENT_READER_HPP
+#define JSONCONS_JSON_DOCUMENT_READER_HPP
+
+#include <memory> // std::allocator, std::addressof
+#include <string>
+#include <vector>
+#include <system_error>
+#include <iterator> // std::input_iterator_tag
+#include <utility> // std::move
+#include <jsoncons/source.hpp>
+#include <jsoncons/json_exception.hpp>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons/parse_error_handler.hpp>
+#include <jsoncons/json_parser.hpp>
+#include <jsoncons/json_decoder.hpp>
+#include <jsoncons/basic_json.hpp>
+
+namespace jsoncons {
+
+// Reads a sequence of JSON texts separated by optional whitespace, for
+// example newline delimited JSON. The parser, its buffers, the input buffer
+// and the decoder are kept from one document to the next, so after the
+// first few documents only the values themselves are allocated.
+template<class Json,class Source=jsoncons::text_stream_source<typename Json::char_type>,class Allocator=std::allocator<char>>
+class basic_json_document_reader
+{
+public:
+    typedef Json value_type;
+    typedef typename Json::char_type char_type;
+    typedef Source source_type;
+    typedef Allocator allocator_type;
+private:
+    typedef typename std::allocator_traits<allocator_type>:: template rebind_alloc<char_type> char_allocator_type;
+
+    static const size_t default_max_buffer_length = 16384;
+
+    default_parse_error_handler default_err_handler_;
+    json_decoder<Json> decoder_;
+    basic_json_parser<char_type,Allocator> parser_;
+
+    source_type source_;
+    bool eof_;
+    std::vector<char_type,char_allocator_type> buffer_;
+    size_t buffer_length_;
+    bool begin_;
+
+    // Noncopyable and nonmoveable
+    basic_json_document_reader(const basic_json_document_reader&) = delete;
+    basic_json_document_reader& operator=(const basic_json_document_reader&) = delete;
+
+public:
+    explicit basic_json_document_reader(source_type source)
+        : basic_json_document_reader(std::move(source),
+                                     basic_json_options<char_type>(),
+                                     default_err_handler_)
+    {
+    }
+
+    basic_json_document_reader(source_type source,
+                               const basic_json_read_options<char_type>& options)
+        : basic_json_document_reader(std::move(source),
+                                     options,
+                                     default_err_handler_)
+    {
+    }
+
+    basic_json_document_reader(source_type source,
+                               parse_error_handler& err_handler)
+        : basic_json_document_reader(std::move(source),
+                                     basic_json_options<char_type>(),
+                                     err_handler)
+    {
+    }
+
+    basic_json_document_reader(source_type source,
+                               const basic_json_read_options<char_type>& options,
+                               parse_error_handler& err_handler)
+       : parser_(options,err_handler),
+         source_(std::move(source)),
+         eof_(false),
+         buffer_length_(default_max_buffer_length),
+         begin_(true)
+    {
+        buffer_.reserve(buffer_length_);
+    }
+
+    size_t buffer_length() const
+    {
+        return buffer_length_;
+    }
+
+    void buffer_length(size_t length)
+    {
+        buffer_length_ = length;
+        buffer_.reserve(buffer_length_);
+    }
+
+    size_t line_number() const
+    {
+        return parser_.line_number();
+    }
+
+    size_t column_number() const
+    {
+        return parser_.column_number();
+    }
+
+    bool eof() const
+    {
+        return eof_;
+    }
+
+    // Reads the next document into val, returns false if there are no more
+    bool read_next(Json& val)
+    {
+        std::error_code ec;
+        bool result = read_next(val, ec);
+        if (ec)
+        {
+            throw serialization_error(ec,parser_.line_number(),parser_.column_number());
+        }
+        return result;
+    }
+
+    bool read_next(Json& val, std::error_code& ec)
+    {
+        if (!read_next(decoder_, ec))
+        {
+            return false;
+        }
+        val = decoder_.get_result();
+        return true;
+    }
+
+    // Sends the events of the next document to handler, returns false if there are no more
+    bool read_next(basic_json_content_handler<char_type>& handler)
+    {
+        std::error_code ec;
+        bool result = read_next(handler, ec);
+        if (ec)
+        {
+            throw serialization_error(ec,parser_.line_number(),parser_.column_number());
+        }
+        return result;
+    }
+
+    bool read_next(basic_json_content_handler<char_type>& handler, std::error_code& ec)
+    {
+        try
+        {
+            skip_whitespace(ec);
+            if (ec || eof_)
+            {
+                return false;
+            }
+            parser_.reset();
+            while (!parser_.finished())
+            {
+                if (parser_.source_exhausted())
+                {
+                    if (!source_.eof())
+                    {
+                        read_buffer(ec);
+                        if (ec) return false;
+                    }
+                    else
+                    {
+                        eof_ = true;
+                    }
+                }
+                parser_.parse_some(handler, ec);
+                if (ec) return false;
+            }
+            return true;
+        }
+        catch (const serialization_error& e)
+        {
+            ec = e.code();
+            return false;
+        }
+    }
+
+private:
+
+    void skip_whitespace(std::error_code& ec)
+    {
+        while (!eof_)
+        {
+            if (parser_.source_exhausted())
+            {
+                if (source_.is_error())
+                {
+                    ec = json_errc::source_error;
+                    return;
+                }
+                if (!source_.eof())
+                {
+                    read_buffer(ec);
+                    if (ec) return;
+                }
+                else
+                {
+                    eof_ = true;
+                }
+            }
+            else
+            {
+                parser_.skip_whitespace();
+                if (!parser_.source_exhausted())
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    void read_buffer(std::error_code& ec)
+    {
+        buffer_.clear();
+        buffer_.resize(buffer_length_);
+        size_t count = source_.read(buffer_.data(), buffer_length_);
+        buffer_.resize(static_cast<size_t>(count));
+        if (buffer_.size() == 0)
+        {
+            eof_ = true;
+        }
+        else if (begin_)
+        {
+            auto result = unicons::skip_bom(buffer_.begin(), buffer_.end());
+            if (result.ec != unicons::encoding_errc())
+            {
+                ec = result.ec;
+                return;
+            }
+            size_t offset = result.it - buffer_.begin();
+            parser_.update(buffer_.data()+offset,buffer_.size()-offset);
+            begin_ = false;
+        }
+        else
+        {
+            parser_.update(buffer_.data(),buffer_.size());
+        }
+    }
+};
+
+template<class Json,class Source=jsoncons::text_stream_source<typename Json::char_type>,class Allocator=std::allocator<char>>
+class basic_json_document_iterator
+{
+    basic_json_document_reader<Json,Source,Allocator>* reader_;
+    Json value_;
+public:
+    typedef Json value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Json* pointer;
+    typedef Json& reference;
+    typedef std::input_iterator_tag iterator_category;
+
+    basic_json_document_iterator() noexcept
+        : reader_(nullptr)
+    {
+    }
+
+    basic_json_document_iterator(basic_json_document_reader<Json,Source,Allocator>& reader)
+        : reader_(std::addressof(reader))
+    {
+        next();
+    }
+
+    basic_json_document_iterator(basic_json_document_reader<Json,Source,Allocator>& reader,
+                                 std::error_code& ec)
+        : reader_(std::addressof(reader))
+    {
+        next(ec);
+    }
+
+    const Json& operator*() const
+    {
+        return value_;
+    }
+
+    const Json* operator->() const
+    {
+        return &value_;
+    }
+
+    basic_json_document_iterator& operator++()
+    {
+        next();
+        return *this;
+    }
+
+    basic_json_document_iterator& increment(std::error_code& ec)
+    {
+        next(ec);
+        return *this;
+    }
+
+    basic_json_document_iterator operator++(int) // postfix increment
+    {
+        basic_json_document_iterator temp(*this);
+        next();
+        return temp;
+    }
+
+    friend bool operator==(const basic_json_document_iterator& a, const basic_json_document_iterator& b)
+    {
+        return a.reader_ == b.reader_;
+    }
+
+    friend bool operator!=(const basic_json_document_iterator& a, const basic_json_document_iterator& b)
+    {
+        return !(a == b);
+    }
+
+private:
+    void next()
+    {
+        if (!reader_->read_next(value_))
+        {
+            reader_ = nullptr;
+        }
+    }
+
+    void next(std::error_code& ec)
+    {
+        if (!reader_->read_next(value_, ec) || ec)
+        {
+            reader_ = nullptr;
+        }
+    }
+};
+
+template<class Json,class Source,class Allocator>
+basic_json_document_iterator<Json,Source,Allocator> begin(basic_json_document_iterator<Json,Source,Allocator> iter) noexcept
+{
+    return iter;
+}
+
+template<class Json,class Source,class Allocator>
+basic_json_document_iterator<Json,Source,Allocator> end(const basic_json_document_iterator<Json,Source,Allocator>&) noexcept
+{
+    return basic_json_document_iterator<Json,Source,Allocator>();
+}
+
+typedef basic_json_document_reader<json> json_document_reader;
+typedef basic_json_document_reader<json,jsoncons::string_source<char>> json_string_document_reader;
+typedef basic_json_document_reader<ojson> ojson_document_reader;
+typedef basic_json_document_reader<ojson,jsoncons::string_source<char>> ojson_string_document_reader;
+typedef basic_json_document_reader<wjson> wjson_document_reader;
+typedef basic_json_document_reader<wjson,jsoncons::string_source<wchar_t>> wjson_string_document_reader;
+
+typedef basic_json_document_iterator<json> json_document_iterator;
+typedef basic_json_document_iterator<json,jsoncons::string_source<char>> json_string_document_iterator;
+typedef basic_json_document_iterator<ojson> ojson_document_iterator;
+typedef basic_json_document_iterator<ojson,jsoncons::string_source<char>> ojson_string_document_iterator;
+
+}
+
+#endif
@@ -318,6 +318,55 @@ private:
         return destination_handler_.null_value(tag, context);
     }
 
+    bool do_typed_array(const uint8_t* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
+
+    bool do_typed_array(const uint16_t* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
+
+    bool do_typed_array(const uint32_t* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
+
+    bool do_typed_array(const uint64_t* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
+
+    bool do_typed_array(const int8_t* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
+
+    bool do_typed_array(const int16_t* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
+
+    bool do_typed_array(const int32_t* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
+
+    bool do_typed_array(const int64_t* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
+
+    bool do_typed_array(const float* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
+
+    bool do_typed_array(const double* data, size_t size, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return destination_handler_.typed_array(data, size, tag, context);
+    }
 };
 
 typedef basic_utf8_adaptor<char> json_filter;
@@ -143,6 +143,13 @@ enum class json_parse_state : uint8_t
     fa,  
     fal,  
     fals,  
+    skip,
+    skip_string,
+    skip_escape,
+    skip_slash,
+    skip_slash_slash,
+    skip_slash_star,
+    skip_slash_star_star,
     cr,
     lf,
     done
@@ -173,6 +180,7 @@ class basic_json_parser : private serializing_context
     int initial_stack_capacity_;
     size_t max_nesting_depth_;
     size_t nesting_depth_;
+    size_t skip_depth_;
     uint32_t cp_;
     uint32_t cp2_;
     uint8_t precision_;
@@ -224,6 +232,7 @@ public:
          initial_stack_capacity_(default_initial_stack_capacity_),
          max_nesting_depth_(options.max_nesting_depth()),
          nesting_depth_(0), 
+         skip_depth_(0),
          cp_(0),
          cp2_(0),
          precision_(0), 
@@ -279,6 +288,12 @@ public:
         return done_;
     }
 
+    // The number of objects and arrays that are open
+    size_t level() const
+    {
+        return nesting_depth_;
+    }
+
     bool stopped() const
     {
         return !continue_;
@@ -476,6 +491,47 @@ public:
         }
     }
 
+    // Steps over the rest of the innermost open object or array, tracking 
+    // only nesting depth, strings and comments, and reports its end_object 
+    // or end_array. Names and values inside are neither converted nor validated.
+    void skip_to_end_of_container()
+    {
+        JSONCONS_ASSERT(nesting_depth_ > 0);
+        // Resolve a line break or comment that was pending when the parser stopped
+        while (state_ == json_parse_state::cr || state_ == json_parse_state::lf)
+        {
+            if (state_ == json_parse_state::lf)
+            {
+                ++line_;
+                column_ = 1;
+            }
+            state_ = pop_state();
+        }
+        switch (state_)
+        {
+            case json_parse_state::slash:
+                pop_state();
+                state_ = json_parse_state::skip_slash;
+                break;
+            case json_parse_state::slash_slash:
+                pop_state();
+                state_ = json_parse_state::skip_slash_slash;
+                break;
+            case json_parse_state::slash_star:
+                pop_state();
+                state_ = json_parse_state::skip_slash_star;
+                break;
+            case json_parse_state::slash_star_star:
+                pop_state();
+                state_ = json_parse_state::skip_slash_star_star;
+                break;
+            default:
+                state_ = json_parse_state::skip;
+                break;
+        }
+        skip_depth_ = 1;
+    }
+
     void reset()
     {
         state_stack_.clear();
@@ -1625,6 +1681,16 @@ public:
                 ++input_ptr_;
                 ++column_;
                 break;
+            case json_parse_state::skip:
+            case json_parse_state::skip_string:
+            case json_parse_state::skip_escape:
+            case json_parse_state::skip_slash:
+            case json_parse_state::skip_slash_slash:
+            case json_parse_state::skip_slash_star:
+            case json_parse_state::skip_slash_star_star:
+                skip_container(handler, ec);
+                if (ec) return;
+                break;
             default:
                 JSONCONS_ASSERT(false);
                 break;
@@ -1632,6 +1698,134 @@ public:
         }
     }
 
+    void skip_container(basic_json_content_handler<CharT>& handler, std::error_code& ec)
+    {
+        const CharT* local_input_end = input_end_;
+        while (input_ptr_ < local_input_end)
+        {
+            switch (state_)
+            {
+                case json_parse_state::skip:
+                    switch (*input_ptr_)
+                    {
+                        case '\"':
+                            state_ = json_parse_state::skip_string;
+                            break;
+                        case '{':
+                        case '[':
+                            ++skip_depth_;
+                            break;
+                        case '}':
+                            if (--skip_depth_ == 0)
+                            {
+                                end_object(handler, ec);
+                                if (ec) return;
+                                ++input_ptr_;
+                                ++column_;
+                                return;
+                            }
+                            break;
+                        case ']':
+                            if (--skip_depth_ == 0)
+                            {
+                                end_array(handler, ec);
+                                if (ec) return;
+                                ++input_ptr_;
+                                ++column_;
+                                return;
+                            }
+                            break;
+                        case '/':
+                            state_ = json_parse_state::skip_slash;
+                            break;
+                        case '\n':
+                            ++line_;
+                            column_ = 0;
+                            break;
+                        default:
+                            break;
+                    }
+                    break;
+                case json_parse_state::skip_string:
+                    switch (*input_ptr_)
+                    {
+                        case '\"':
+                            state_ = json_parse_state::skip;
+                            break;
+                        case '\\':
+                            state_ = json_parse_state::skip_escape;
+                            break;
+                        default:
+                            break;
+                    }
+                    break;
+                case json_parse_state::skip_escape:
+                    state_ = json_parse_state::skip_string;
+                    break;
+                case json_parse_state::skip_slash:
+                    switch (*input_ptr_)
+                    {
+                        case '/':
+                            state_ = json_parse_state::skip_slash_slash;
+                            break;
+                        case '*':
+                            state_ = json_parse_state::skip_slash_star;
+                            break;
+                        default:
+                            // not a comment, look at the character again
+                            state_ = json_parse_state::skip;
+                            continue;
+                    }
+                    break;
+                case json_parse_state::skip_slash_slash:
+                    if (*input_ptr_ == '\n')
+                    {
+                        ++line_;
+                        column_ = 0;
+                        state_ = json_parse_state::skip;
+                    }
+                    break;
+                case json_parse_state::skip_slash_star:
+                    switch (*input_ptr_)
+                    {
+                        case '*':
+                            state_ = json_parse_state::skip_slash_star_star;
+                            break;
+                        case '\n':
+                            ++line_;
+                            column_ = 0;
+                            break;
+                        default:
+                            break;
+                    }
+                    break;
+                case json_parse_state::skip_slash_star_star:
+                    switch (*input_ptr_)
+                    {
+                        case '/':
+                            state_ = json_parse_state::skip;
+                            break;
+                        case '*':
+                            break;
+                        case '\n':
+                            ++line_;
+                            column_ = 0;
+                            state_ = json_parse_state::skip_slash_star;
+                            break;
+                        default:
+                            state_ = json_parse_state::skip_slash_star;
+                            break;
+                    }
+                    break;
+                default:
+                    JSONCONS_ASSERT(false);
+                    break;
+            }
+            ++input_ptr_;
+            ++column_;
+        }
+    }
+
     void parse_true(basic_json_content_handler<CharT>& handler, std::error_code& ec)
     {
         if (JSONCONS_LIKELY(input_end_ - input_ptr_ >= 4))
@@ -94,12 +94,13 @@ private:
         return false;
     }
 
-    bool do_byte_string_value(const byte_string_view&, 
+    bool do_byte_string_value(const byte_string_view& s, 
                               byte_string_chars_format,
-                              semantic_tag_type,
+                              semantic_tag_type tag,
                               const serializing_context&) override
     {
-        JSONCONS_UNREACHABLE();
+        event_ = basic_staj_event<CharT>(s, tag);
+        return false;
     }
 
     bool do_int64_value(int64_t value, 
@@ -436,76 +437,9 @@ public:
     void accept(basic_json_content_handler<CharT>& handler,
                 std::error_code& ec) override
     {
-        switch (event_handler_.event().event_type())
+        if (!jsoncons::detail::replay_staj_event(event_handler_.event(), handler, *this))
         {
-            case staj_event_type::begin_array:
-                if (!handler.begin_array(semantic_tag_type::none, *this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::end_array:
-                if (!handler.end_array(*this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::begin_object:
-                if (!handler.begin_object(semantic_tag_type::none, *this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::end_object:
-                if (!handler.end_object(*this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::name:
-                if (!handler.name(event_handler_.event().template as<jsoncons::basic_string_view<CharT>>(), *this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::string_value:
-                if (!handler.string_value(event_handler_.event().template as<jsoncons::basic_string_view<CharT>>(), semantic_tag_type::none, *this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::null_value:
-                if (!handler.null_value(semantic_tag_type::none, *this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::bool_value:
-                if (!handler.bool_value(event_handler_.event().template as<bool>(), semantic_tag_type::none, *this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::int64_value:
-                if (!handler.int64_value(event_handler_.event().template as<int64_t>(), semantic_tag_type::none, *this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::uint64_value:
-                if (!handler.uint64_value(event_handler_.event().template as<uint64_t>(), semantic_tag_type::none, *this))
-                {
-                    return;
-                }
-                break;
-            case staj_event_type::double_value:
-                if (!handler.double_value(event_handler_.event().template as<double>(), semantic_tag_type::none, *this))
-                {
-                    return;
-                }
-                break;
-            default:
-                break;
+            return;
         }
         do
         {
@@ -661,6 +595,15 @@ public:
         return parser_.column_number();
     }
 private:
+    void do_skip_to_end_of_container(std::error_code& ec) override
+    {
+        if (parser_.level() == 0)
+        {
+            return;
+        }
+        parser_.skip_to_end_of_container();
+        read_next(ec);
+    }
 };
 
 typedef basic_json_staj_reader<char,std::allocator<char>> json_staj_reader;
@@ -279,6 +279,48 @@ public:
     }
 };
 
+// unchecked_buffer_result
+
+// Writes to memory that is known to be large enough, without checking 
+// for the end
+
+class unchecked_buffer_result 
+{
+public:
+    typedef uint8_t value_type;
+    typedef uint8_t* output_type;
+private:
+    output_type p_;
+
+    // Noncopyable
+    unchecked_buffer_result(const unchecked_buffer_result&) = delete;
+    unchecked_buffer_result& operator=(const unchecked_buffer_result&) = delete;
+public:
+    unchecked_buffer_result(unchecked_buffer_result&&) = default;
+
+    unchecked_buffer_result(output_type p)
+        : p_(p)
+    {
+    }
+
+    unchecked_buffer_result& operator=(unchecked_buffer_result&&) = default;
+
+    void flush()
+    {
+    }
+
+    void insert(const uint8_t* s, size_t length)
+    {
+        std::memcpy(p_, s, length);
+        p_ += length;
+    }
+
+    void push_back(uint8_t ch)
+    {
+        *p_++ = ch;
+    }
+};
+
 }
 
 #endif
@@ -643,6 +643,21 @@ public:
         return len;
     }
 
+    // Moves past the next length bytes and returns a pointer to them in the buffer, 
+    // without copying. Returns nullptr if fewer than length bytes remain.
+    const value_type* read_in_place(size_t length)
+    {
+        if ((size_t)(input_end_ - input_ptr_) < length)
+        {
+            input_ptr_ = input_end_;
+            eof_ = true;
+            return nullptr;
+        }
+        const value_type* p = input_ptr_;
+        input_ptr_ += length;
+        return p;
+    }
+
     template <class OutputIt>
     typename std::enable_if<!std::is_same<OutputIt,value_type*>::value,size_t>::type
     read(OutputIt d_first, size_t count)
@@ -16,6 +16,7 @@
 #include <jsoncons/json_exception.hpp>
 #include <jsoncons/json_content_handler.hpp>
 #include <jsoncons/bignum.hpp>
+#include <jsoncons/byte_string.hpp>
 #include <jsoncons/parse_error_handler.hpp>
 #include <jsoncons/serializing_context.hpp>
 #include <jsoncons/result.hpp>
@@ -98,6 +99,13 @@ public:
         value_.string_data_ = data;
     }
 
+    basic_staj_event(const byte_string_view& s,
+        semantic_tag_type semantic_tag = semantic_tag_type::none)
+        : event_type_(staj_event_type::byte_string_value), semantic_tag_(semantic_tag), length_(s.length())
+    {
+        value_.byte_string_data_ = s.data();
+    }
+
     template<class T, class CharT_ = CharT>
     typename std::enable_if<jsoncons::detail::is_string_like<T>::value && std::is_same<typename T::value_type, CharT_>::value, T>::type
         as() const
@@ -173,6 +181,28 @@ public:
         return s;
     }
 
+    template<class T>
+    typename std::enable_if<std::is_same<T, byte_string_view>::value, T>::type
+        as() const
+    {
+        if (event_type_ != staj_event_type::byte_string_value)
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a byte string"));
+        }
+        return T(value_.byte_string_data_, length_);
+    }
+
+    template<class T>
+    typename std::enable_if<std::is_same<T, byte_string>::value, T>::type
+        as() const
+    {
+        if (event_type_ != staj_event_type::byte_string_value)
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a byte string"));
+        }
+        return T(value_.byte_string_data_, length_);
+    }
+
     template<class T>
     typename std::enable_if<jsoncons::detail::is_integer_like<T>::value, T>::type
         as() const
@@ -380,8 +410,122 @@ public:
     virtual void next(std::error_code& ec) = 0;
 
     virtual const serializing_context& context() const = 0;
+
+    // If the current event is begin_array or begin_object, advances to the 
+    // matching end_array or end_object event
+    void skip()
+    {
+        std::error_code ec;
+        skip(ec);
+        if (ec)
+        {
+            throw serialization_error(ec,context().line_number(),context().column_number());
+        }
+    }
+
+    void skip(std::error_code& ec)
+    {
+        switch (current().event_type())
+        {
+            case staj_event_type::begin_array:
+            case staj_event_type::begin_object:
+                skip_to_end_of_container(ec);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Advances to the end_array or end_object event of the innermost 
+    // open container
+    void skip_to_end_of_container()
+    {
+        std::error_code ec;
+        skip_to_end_of_container(ec);
+        if (ec)
+        {
+            throw serialization_error(ec,context().line_number(),context().column_number());
+        }
+    }
+
+    void skip_to_end_of_container(std::error_code& ec)
+    {
+        do_skip_to_end_of_container(ec);
+    }
+private:
+    // Readers override this to step over the container without 
+    // constructing events
+    virtual void do_skip_to_end_of_container(std::error_code& ec)
+    {
+        size_t level = 1;
+        while (!done())
+        {
+            next(ec);
+            if (ec)
+            {
+                return;
+            }
+            switch (current().event_type())
+            {
+                case staj_event_type::begin_array:
+                case staj_event_type::begin_object:
+                    ++level;
+                    break;
+                case staj_event_type::end_array:
+                case staj_event_type::end_object:
+                    if (--level == 0)
+                    {
+                        return;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
 };
 
+namespace detail {
+
+// Sends a single event to a content handler
+template<class CharT>
+bool replay_staj_event(const basic_staj_event<CharT>& event,
+                       basic_json_content_handler<CharT>& handler,
+                       const serializing_context& context)
+{
+    switch (event.event_type())
+    {
+        case staj_event_type::begin_array:
+            return handler.begin_array(event.semantic_tag(), context);
+        case staj_event_type::end_array:
+            return handler.end_array(context);
+        case staj_event_type::begin_object:
+            return handler.begin_object(event.semantic_tag(), context);
+        case staj_event_type::end_object:
+            return handler.end_object(context);
+        case staj_event_type::name:
+            return handler.name(event.template as<jsoncons::basic_string_view<CharT>>(), context);
+        case staj_event_type::string_value:
+            return handler.string_value(event.template as<jsoncons::basic_string_view<CharT>>(), event.semantic_tag(), context);
+        case staj_event_type::byte_string_value:
+            return handler.byte_string_value(event.template as<byte_string_view>(), byte_string_chars_format::none, event.semantic_tag(), context);
+        case staj_event_type::null_value:
+            return handler.null_value(event.semantic_tag(), context);
+        case staj_event_type::bool_value:
+            return handler.bool_value(event.template as<bool>(), event.semantic_tag(), context);
+        case staj_event_type::int64_value:
+            return handler.int64_value(event.template as<int64_t>(), event.semantic_tag(), context);
+        case staj_event_type::uint64_value:
+            return handler.uint64_value(event.template as<uint64_t>(), event.semantic_tag(), context);
+        case staj_event_type::double_value:
+            return handler.double_value(event.template as<double>(), event.semantic_tag(), context);
+        default:
+            return true;
+    }
+}
+
+}
+
 template<class CharT>
 class basic_staj_filter
 {
@@ -128,10 +128,8 @@ private:
         stack_.pop_back();
         if (stack_.empty())
         {
-            for (auto c : buffer_)
-            {
-                result_.push_back(c);
-            }
+            result_.insert(buffer_.data(), buffer_.size());
+            buffer_.clear();
         }
         return true;
     }
@@ -159,10 +157,8 @@ private:
         stack_.pop_back();
         if (stack_.empty())
         {
-            for (auto c : buffer_)
-            {
-                result_.push_back(c);
-            }
+            result_.insert(buffer_.data(), buffer_.size());
+            buffer_.clear();
         }
         return true;
     }
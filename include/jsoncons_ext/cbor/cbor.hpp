@@ -18,9 +18,114 @@
 #include <jsoncons_ext/cbor/cbor_reader.hpp>
 #include <jsoncons_ext/cbor/cbor_serializer.hpp>
 #include <jsoncons_ext/cbor/cbor_view.hpp>
+#include <jsoncons_ext/cbor/cbor_sequence_reader.hpp>
 
 namespace jsoncons { namespace cbor {
 
+namespace detail {
+
+// The number of bytes in the initial byte and argument of a data item
+inline
+size_t header_length(uint64_t value)
+{
+    if (value <= 0x17)
+    {
+        return 1;
+    }
+    else if (value <= 0xff)
+    {
+        return 2;
+    }
+    else if (value <= 0xffff)
+    {
+        return 3;
+    }
+    else if (value <= 0xffffffff)
+    {
+        return 5;
+    }
+    else
+    {
+        return 9;
+    }
+}
+
+// Adds the number of bytes that basic_cbor_serializer writes for j, without 
+// stringrefs or canonical ordering, to length, and returns true. Returns false 
+// if j holds a value that is not sized here, a semantically tagged value, a
+// byte string, whose tag depends on its encoding hint, or wide characters, 
+// and then j is encoded without sizing it first. 
+template<class Json>
+bool encoded_size(const Json& j, size_t& length)
+{
+    if (!std::is_same<typename Json::char_type,char>::value || j.semantic_tag() != semantic_tag_type::none)
+    {
+        return false;
+    }
+    switch (j.structure_tag())
+    {
+        case structure_tag_type::null_tag:
+        case structure_tag_type::bool_tag:
+            length += 1;
+            return true;
+        case structure_tag_type::int64_tag:
+        {
+            int64_t val = j.template as_integer<int64_t>();
+            length += header_length(val >= 0 ? static_cast<uint64_t>(val) : static_cast<uint64_t>(-1 - val));
+            return true;
+        }
+        case structure_tag_type::uint64_tag:
+            length += header_length(j.template as_integer<uint64_t>());
+            return true;
+        case structure_tag_type::double_tag:
+        {
+            double val = j.as_double();
+            length += (double)(float)val == val ? 5 : 9;
+            return true;
+        }
+        case structure_tag_type::short_string_tag:
+        case structure_tag_type::long_string_tag:
+        {
+            size_t n = j.as_string_view().length();
+            length += header_length(n) + n;
+            return true;
+        }
+        case structure_tag_type::empty_object_tag:
+            length += 1;
+            return true;
+        case structure_tag_type::object_tag:
+        {
+            length += header_length(j.size());
+            for (const auto& member : j.object_range())
+            {
+                size_t n = member.key().length();
+                length += header_length(n) + n;
+                if (!encoded_size(member.value(), length))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case structure_tag_type::array_tag:
+        {
+            length += header_length(j.size());
+            for (const auto& item : j.array_range())
+            {
+                if (!encoded_size(item, length))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+}
+
 // encode_cbor
 
 template<class Json>
@@ -32,13 +137,67 @@ void encode_cbor(const Json& j, std::basic_ostream<typename Json::char_type>& os
 }
 
 template<class Json>
-void encode_cbor(const Json& j, std::vector<uint8_t>& v)
+typename std::enable_if<!jsoncons::detail::is_typed_array_vector<Json>::value>::type
+encode_cbor(const Json& j, std::vector<uint8_t>& v)
+{
+    encode_cbor(j, v, cbor_options::default_options());
+}
+
+template<class Json>
+void encode_cbor(const Json& j, std::basic_ostream<typename Json::char_type>& os, const cbor_options& options)
 {
     typedef typename Json::char_type char_type;
-    basic_cbor_serializer<char_type,jsoncons::buffer_result> serializer(v);
+    basic_cbor_serializer<char_type> serializer(os, options);
     j.dump(serializer);
 }
 
+template<class Json>
+typename std::enable_if<!jsoncons::detail::is_typed_array_vector<Json>::value>::type
+encode_cbor(const Json& j, std::vector<uint8_t>& v, const cbor_options& options)
+{
+    typedef typename Json::char_type char_type;
+
+    // Size the encoding first, so that v is resized once and then 
+    // written without capacity checks
+    size_t length = 0;
+    if (options.pack_strings() || options.canonical() || !detail::encoded_size(j, length))
+    {
+        basic_cbor_serializer<char_type,jsoncons::buffer_result> serializer(v, options);
+        j.dump(serializer);
+        return;
+    }
+    size_t offset = v.size();
+    v.resize(offset + length);
+    try
+    {
+        basic_cbor_serializer<char_type,jsoncons::unchecked_buffer_result> serializer(v.data() + offset, options);
+        j.dump(serializer);
+    }
+    catch (...)
+    {
+        v.resize(offset);
+        throw;
+    }
+}
+
+// A std::vector of numbers is encoded as a typed array (RFC 8746)
+
+template<class T>
+typename std::enable_if<jsoncons::detail::is_typed_array_vector<T>::value>::type
+encode_cbor(const T& val, std::ostream& os)
+{
+    cbor_serializer serializer(os);
+    serializer.typed_array(val.data(), val.size());
+}
+
+template<class T>
+typename std::enable_if<jsoncons::detail::is_typed_array_vector<T>::value>::type
+encode_cbor(const T& val, std::vector<uint8_t>& v)
+{
+    cbor_buffer_serializer serializer(v);
+    serializer.typed_array(val.data(), val.size());
+}
+
 // decode_cbor
 
 template<class Json>
@@ -49,6 +208,13 @@ decode_cbor(const cbor_view& v)
     basic_cbor_reader<jsoncons::buffer_source> parser(jsoncons::buffer_source(v.buffer(),v.buflen()), decoder);
     std::error_code ec;
     parser.read(ec);
+    if (ec == cbor_errc::stringref_too_large)
+    {
+        // v may refer to strings of a stringref namespace that encloses it
+        jsoncons::json_decoder<Json> view_decoder;
+        v.dump(view_decoder);
+        return view_decoder.get_result();
+    }
     if (ec)
     {
         throw serialization_error(ec,parser.line_number(),parser.column_number());
@@ -65,10 +231,58 @@ decode_cbor(const cbor_view& v)
     basic_cbor_reader<jsoncons::buffer_source> parser(jsoncons::buffer_source(v.buffer(),v.buflen()), adaptor);
     std::error_code ec;
     parser.read(ec);
+    if (ec == cbor_errc::stringref_too_large)
+    {
+        // v may refer to strings of a stringref namespace that encloses it
+        jsoncons::json_decoder<Json> view_decoder;
+        basic_utf8_adaptor<typename Json::char_type> view_adaptor(view_decoder);
+        v.dump(view_adaptor);
+        return view_decoder.get_result();
+    }
+    if (ec)
+    {
+        throw serialization_error(ec,parser.line_number(),parser.column_number());
+    }
+    return decoder.get_result();
+}
+
+// A typed array, or an array of numbers, is decoded into a std::vector of numbers
+
+template<class T>
+typename std::enable_if<jsoncons::detail::is_typed_array_vector<T>::value,T>::type 
+decode_cbor(const cbor_view& v)
+{
+    jsoncons::detail::typed_array_decoder<char,T> decoder;
+    basic_cbor_reader<jsoncons::buffer_source> parser(jsoncons::buffer_source(v.buffer(),v.buflen()), decoder);
+    std::error_code ec;
+    parser.read(ec);
     if (ec)
     {
         throw serialization_error(ec,parser.line_number(),parser.column_number());
     }
+    if (!decoder.is_valid())
+    {
+        JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an array of numbers"));
+    }
+    return decoder.get_result();
+}
+
+template<class T>
+typename std::enable_if<jsoncons::detail::is_typed_array_vector<T>::value,T>::type 
+decode_cbor(std::istream& is)
+{
+    jsoncons::detail::typed_array_decoder<char,T> decoder;
+    cbor_reader parser(is, decoder);
+    std::error_code ec;
+    parser.read(ec);
+    if (ec)
+    {
+        throw serialization_error(ec,parser.line_number(),parser.column_number());
+    }
+    if (!decoder.is_valid())
+    {
+        JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an array of numbers"));
+    }
     return decoder.get_result();
 }
 
@@ -107,6 +321,73 @@ decode_cbor(std::basic_istream<typename Json::char_type>& is)
     return decoder.get_result();
 }
   
+// Encodes an already encoded data item again in canonical form 
+// (RFC 8949 section 4.2.1), see cbor_options::canonical
+inline
+void canonicalize_cbor(const cbor_view& v, std::vector<uint8_t>& result)
+{
+    cbor_buffer_serializer serializer(result, cbor_options().canonical(true));
+    v.dump(serializer);
+}
+
+// CBOR sequences (RFC 8742)
+
+// Appends a data item to a CBOR sequence
+template<class Json>
+void encode_cbor_sequence(const Json& j, std::vector<uint8_t>& v)
+{
+    encode_cbor(j, v);
+}
+
+template<class Json>
+void encode_cbor_sequence(const Json& j, std::vector<uint8_t>& v, const cbor_options& options)
+{
+    encode_cbor(j, v, options);
+}
+
+template<class Json>
+void encode_cbor_sequence(const Json& j, std::ostream& os)
+{
+    encode_cbor(j, os);
+}
+
+// Appends the values in a range to a CBOR sequence, one data item each
+template<class InputIt>
+void encode_cbor_sequence(InputIt first, InputIt last, std::vector<uint8_t>& v)
+{
+    for (; first != last; ++first)
+    {
+        encode_cbor(*first, v);
+    }
+}
+
+template<class Json>
+std::vector<Json> decode_cbor_sequence(const std::vector<uint8_t>& v, size_t max_threads = 1)
+{
+    cbor_sequence_reader reader(v);
+    return reader.decode<Json>(max_threads);
+}
+
+template<class Json>
+std::vector<Json> decode_cbor_sequence(std::istream& is)
+{
+    std::vector<Json> values;
+    jsoncons::json_decoder<Json> decoder;
+    basic_utf8_adaptor<typename Json::char_type> adaptor(decoder);
+    cbor_reader parser(is, adaptor);
+    while (is.peek() != std::char_traits<char>::eof())
+    {
+        std::error_code ec;
+        parser.read(ec);
+        if (ec)
+        {
+            throw serialization_error(ec,parser.line_number(),parser.column_number());
+        }
+        values.push_back(decoder.get_result());
+    }
+    return values;
+}
+
 #if !defined(JSONCONS_NO_DEPRECATED)
 template<class Json>
 std::vector<uint8_t> encode_cbor(const Json& j)
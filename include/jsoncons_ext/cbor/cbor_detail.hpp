@@ -13,6 +13,7 @@
 #include <iterator> // std::forward_iterator_tag
 #include <limits> // std::numeric_limits
 #include <utility> // std::move
+#include <unordered_map>
 #include <jsoncons/json.hpp>
 #include <jsoncons/json_content_handler.hpp>
 #include <jsoncons/config/binary_detail.hpp>
@@ -335,8 +336,12 @@ std::vector<uint8_t> get_byte_string(Source& source, std::error_code& ec)
             {
                 return v;
             }
-            v.reserve(length);
-            source.read(std::back_inserter(v), length);
+            v.resize(length);
+            if (length > 0)
+            {
+                // In one piece, rather than byte by byte
+                source.read(v.data(), length);
+            }
             if (source.eof())
             {
                 ec = cbor_errc::unexpected_eof;
@@ -349,6 +354,125 @@ std::vector<uint8_t> get_byte_string(Source& source, std::error_code& ec)
     return v;
 }
 
+// Reads the length bytes of a definite length string into buffer, and returns 
+// a pointer to them
+template <class Source>
+const uint8_t* read_string_bytes(Source& source, size_t length, std::vector<uint8_t>& buffer, std::error_code& ec)
+{
+    buffer.resize(length);
+    if (length > 0)
+    {
+        source.read(buffer.data(), length);
+    }
+    if (source.eof())
+    {
+        ec = cbor_errc::unexpected_eof;
+        return nullptr;
+    }
+    return buffer.data();
+}
+
+// The bytes are already in memory, return a pointer into the source buffer
+inline
+const uint8_t* read_string_bytes(jsoncons::buffer_source& source, size_t length, std::vector<uint8_t>&, std::error_code& ec)
+{
+    const uint8_t* p = source.read_in_place(length);
+    if (p == nullptr)
+    {
+        ec = cbor_errc::unexpected_eof;
+    }
+    return p;
+}
+
+template <class Source>
+void append_string_chunks(Source& source, std::vector<uint8_t>& buffer, std::error_code& ec)
+{
+    source.ignore(1);
+    bool done = false;
+    while (!done)
+    {
+        int test = source.peek();
+        switch (test)
+        {
+            case Source::traits_type::eof():
+                ec = cbor_errc::unexpected_eof;
+                return;
+            case 0xff:
+                done = true;
+                break;
+            default:
+                if (get_additional_information_value((uint8_t)test) == additional_info::indefinite_length)
+                {
+                    append_string_chunks(source, buffer, ec);
+                }
+                else
+                {
+                    size_t length = get_length(source, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    size_t offset = buffer.size();
+                    buffer.resize(offset + length);
+                    if (length > 0)
+                    {
+                        source.read(buffer.data() + offset, length);
+                    }
+                    if (source.eof())
+                    {
+                        ec = cbor_errc::unexpected_eof;
+                        return;
+                    }
+                }
+                if (ec)
+                {
+                    return;
+                }
+                break;
+        }
+    }
+    source.ignore(1);
+}
+
+// Reads a text or byte string and returns a view of its bytes. The view 
+// is into the source buffer for definite length strings when the source 
+// is in memory, otherwise into buffer, which is reused between calls.
+// The view is valid until the next read from source or use of buffer.
+template <class Source>
+byte_string_view get_string_view(Source& source, std::vector<uint8_t>& buffer, std::error_code& ec)
+{
+    int c = source.peek();
+    if (c == Source::traits_type::eof())
+    {
+        ec = cbor_errc::unexpected_eof;
+        return byte_string_view();
+    }
+    JSONCONS_ASSERT(get_major_type((uint8_t)c) == cbor_major_type::text_string || get_major_type((uint8_t)c) == cbor_major_type::byte_string);
+
+    if (get_additional_information_value((uint8_t)c) == additional_info::indefinite_length)
+    {
+        buffer.clear();
+        append_string_chunks(source, buffer, ec);
+        if (ec)
+        {
+            return byte_string_view();
+        }
+        return byte_string_view(buffer.data(), buffer.size());
+    }
+
+    size_t length = get_length(source, ec);
+    if (ec)
+    {
+        return byte_string_view();
+    }
+    const uint8_t* p = read_string_bytes(source, length, buffer, ec);
+    if (ec)
+    {
+        return byte_string_view();
+    }
+    return byte_string_view(p, length);
+}
+
 template <class Source>
 std::string get_text_string(Source& source, std::error_code& ec)
 {
@@ -877,7 +1001,11 @@ void walk(Source& source, std::error_code& ec)
         }
         case cbor_major_type::semantic_tag:
         {
-            source.ignore(1);
+            get_uint64_value(source, ec);
+            if (ec)
+            {
+                return;
+            }
             walk(source, ec);
             break;
         }
@@ -929,8 +1057,9 @@ void walk(Source& source, std::error_code& ec)
     }
 }
 
+// If bignum_bytes is not null, it receives the bytes of a bignum mantissa
 template <class Source>
-std::string get_array_as_decimal_string(Source& source, std::error_code& ec)
+std::string get_array_as_decimal_string(Source& source, std::error_code& ec, std::vector<uint8_t>* bignum_bytes = nullptr)
 {
     std::string s;
     cbor_major_type major_type;
@@ -1035,6 +1164,10 @@ std::string get_array_as_decimal_string(Source& source, std::error_code& ec)
                     bignum n(-1, v.data(), v.size());
                     n.dump(s);
                 }
+                if (bignum_bytes != nullptr)
+                {
+                    *bignum_bytes = std::move(v);
+                }
             }
             break;
         }
@@ -1093,6 +1226,315 @@ std::string get_array_as_decimal_string(Source& source, std::error_code& ec)
     return s;
 }
 
+inline
+bool is_typed_array_tag(uint64_t tag)
+{
+    return tag >= 0x40 && tag <= 0x57;
+}
+
+template <class T, class Source>
+void read_typed_array(Source& source, size_t length, bool little_endian, 
+                      json_content_handler& handler, const serializing_context& context, 
+                      std::error_code& ec)
+{
+    std::vector<T> v(length/sizeof(T));
+    if (length > 0)
+    {
+        source.read(reinterpret_cast<uint8_t*>(v.data()), length);
+    }
+    if (source.eof())
+    {
+        ec = cbor_errc::unexpected_eof;
+        return;
+    }
+    if (sizeof(T) > 1 && little_endian != (jsoncons::detail::endian::native == jsoncons::detail::endian::little))
+    {
+        for (auto& x : v)
+        {
+            x = jsoncons::detail::byte_swap(x);
+        }
+    }
+    handler.typed_array(v.data(), v.size(), semantic_tag_type::none, context);
+}
+
+// Reads the length bytes of the byte string of a typed array (RFC 8746) with 
+// the given tag directly into an array of its elements, and writes them to 
+// handler with a single typed_array event. Arrays of half precision floats 
+// are written as arrays of doubles. The bytes of an unsupported typed array 
+// (128 bit floats), or of one whose length is not a multiple of the element 
+// size, are written as a byte string.
+template <class Source>
+void read_typed_array(Source& source, uint64_t tag, size_t length, 
+                      json_content_handler& handler, const serializing_context& context, 
+                      std::error_code& ec)
+{
+    JSONCONS_ASSERT(is_typed_array_tag(tag));
+
+    const bool is_float = (tag & 0x10) != 0;
+    const bool is_signed = (tag & 0x08) != 0;
+    const bool little_endian = (tag & 0x04) != 0;
+    const uint8_t ll = tag & 0x03;
+    const size_t element_size = is_float ? (size_t(2) << ll) : (size_t(1) << ll);
+
+    // Tag 76 is reserved
+    if ((is_float && ll == 3) || (!is_float && is_signed && ll == 0 && little_endian) || length % element_size != 0)
+    {
+        std::vector<uint8_t> v(length);
+        if (length > 0)
+        {
+            source.read(v.data(), length);
+        }
+        if (source.eof())
+        {
+            ec = cbor_errc::unexpected_eof;
+            return;
+        }
+        handler.byte_string_value(byte_string_view(v.data(), v.size()), byte_string_chars_format::none, semantic_tag_type::none, context);
+        return;
+    }
+
+    if (is_float)
+    {
+        switch (ll)
+        {
+            case 0:
+            {
+                std::vector<uint16_t> halves(length/2);
+                if (length > 0)
+                {
+                    source.read(reinterpret_cast<uint8_t*>(halves.data()), length);
+                }
+                if (source.eof())
+                {
+                    ec = cbor_errc::unexpected_eof;
+                    return;
+                }
+                std::vector<double> v(halves.size());
+                const bool swap = little_endian != (jsoncons::detail::endian::native == jsoncons::detail::endian::little);
+                for (size_t i = 0; i < v.size(); ++i)
+                {
+                    v[i] = jsoncons::detail::decode_half(swap ? jsoncons::detail::byte_swap(halves[i]) : halves[i]);
+                }
+                handler.typed_array(v.data(), v.size(), semantic_tag_type::none, context);
+                break;
+            }
+            case 1:
+                read_typed_array<float>(source, length, little_endian, handler, context, ec);
+                break;
+            default:
+                read_typed_array<double>(source, length, little_endian, handler, context, ec);
+                break;
+        }
+        return;
+    }
+
+    // Tag 68 is a clamped uint8 array
+    switch (ll)
+    {
+        case 0:
+            if (is_signed)
+            {
+                read_typed_array<int8_t>(source, length, little_endian, handler, context, ec);
+            }
+            else
+            {
+                read_typed_array<uint8_t>(source, length, little_endian, handler, context, ec);
+            }
+            break;
+        case 1:
+            if (is_signed)
+            {
+                read_typed_array<int16_t>(source, length, little_endian, handler, context, ec);
+            }
+            else
+            {
+                read_typed_array<uint16_t>(source, length, little_endian, handler, context, ec);
+            }
+            break;
+        case 2:
+            if (is_signed)
+            {
+                read_typed_array<int32_t>(source, length, little_endian, handler, context, ec);
+            }
+            else
+            {
+                read_typed_array<uint32_t>(source, length, little_endian, handler, context, ec);
+            }
+            break;
+        default:
+            if (is_signed)
+            {
+                read_typed_array<int64_t>(source, length, little_endian, handler, context, ec);
+            }
+            else
+            {
+                read_typed_array<uint64_t>(source, length, little_endian, handler, context, ec);
+            }
+            break;
+    }
+}
+
+// Finds the string that a stringref (tag 25) refers to, by reading the items 
+// that precede the stringref from the beginning of the outermost item, and 
+// collecting the strings of the enclosing stringref namespaces (tag 256)
+class stringref_resolver
+{
+    typedef std::pair<const uint8_t*,const uint8_t*> item_type;
+
+    const uint8_t* ref_;
+    const uint8_t* last_;
+    std::vector<std::vector<item_type>> namespaces_;
+    item_type result_;
+public:
+    // ref is the stringref, and last the end of the buffer that holds the 
+    // items from first to ref
+    stringref_resolver(const uint8_t* ref, const uint8_t* last)
+        : ref_(ref), last_(last), result_(nullptr, nullptr)
+    {
+    }
+
+    // Sets first and last to the string item, with its header, that the 
+    // stringref refers to
+    void resolve(const uint8_t* first, const uint8_t*& result_first, const uint8_t*& result_last, std::error_code& ec)
+    {
+        namespaces_.clear();
+        if (read(first, ec) != nullptr && !ec)
+        {
+            ec = cbor_errc::stringref_too_large;
+        }
+        result_first = result_.first;
+        result_last = result_.second;
+    }
+private:
+    // Reads the item at p and returns its end, or nullptr if reading stopped 
+    // at the stringref or on an error
+    const uint8_t* read(const uint8_t* p, std::error_code& ec)
+    {
+        if (p >= last_)
+        {
+            ec = cbor_errc::unexpected_eof;
+            return nullptr;
+        }
+        jsoncons::buffer_source source(p, last_ - p);
+        if (p == ref_)
+        {
+            uint64_t tag = get_uint64_value(source, ec);
+            if (ec)
+            {
+                return nullptr;
+            }
+            uint64_t index = get_uint64_value(source, ec);
+            if (ec)
+            {
+                return nullptr;
+            }
+            if (tag != 25 || namespaces_.empty() || index >= namespaces_.back().size())
+            {
+                ec = cbor_errc::stringref_too_large;
+                return nullptr;
+            }
+            result_ = namespaces_.back()[(size_t)index];
+            return nullptr;
+        }
+
+        const uint8_t info = get_additional_information_value(*p);
+        switch (get_major_type(*p))
+        {
+            case cbor_major_type::semantic_tag:
+            {
+                uint64_t tag = get_uint64_value(source, ec);
+                if (ec)
+                {
+                    return nullptr;
+                }
+                const uint8_t* q = p + source.position() - 1;
+                if (tag != 256)
+                {
+                    return read(q, ec);
+                }
+                namespaces_.emplace_back();
+                q = read(q, ec);
+                if (q != nullptr)
+                {
+                    namespaces_.pop_back();
+                }
+                return q;
+            }
+            case cbor_major_type::byte_string:
+            case cbor_major_type::text_string:
+            {
+                size_t length = 0;
+                if (info == additional_info::indefinite_length)
+                {
+                    length = get_major_type(*p) == cbor_major_type::text_string ? get_text_string(source, ec).size() : get_byte_string(source, ec).size();
+                }
+                else
+                {
+                    length = get_length(source, ec);
+                    source.ignore(length);
+                }
+                if (ec)
+                {
+                    return nullptr;
+                }
+                const uint8_t* endp = p + source.position() - 1;
+                if (!namespaces_.empty() && length >= min_length_for_stringref(namespaces_.back().size()))
+                {
+                    namespaces_.back().emplace_back(p, endp);
+                }
+                return endp;
+            }
+            case cbor_major_type::array:
+            case cbor_major_type::map:
+            {
+                const size_t factor = get_major_type(*p) == cbor_major_type::map ? 2 : 1;
+                const bool indefinite = info == additional_info::indefinite_length;
+                size_t length = 0;
+                if (indefinite)
+                {
+                    source.ignore(1);
+                }
+                else
+                {
+                    length = get_length(source, ec)*factor;
+                    if (ec)
+                    {
+                        return nullptr;
+                    }
+                }
+                const uint8_t* q = p + source.position() - 1;
+                for (size_t i = 0; indefinite ? (q < last_ && *q != 0xff) : i < length; ++i)
+                {
+                    q = read(q, ec);
+                    if (q == nullptr)
+                    {
+                        return nullptr;
+                    }
+                }
+                if (indefinite)
+                {
+                    if (q >= last_)
+                    {
+                        ec = cbor_errc::unexpected_eof;
+                        return nullptr;
+                    }
+                    ++q;
+                }
+                return q;
+            }
+            default:
+            {
+                walk(source, ec);
+                if (ec)
+                {
+                    return nullptr;
+                }
+                return p + source.position() - 1;
+            }
+        }
+    }
+};
+
 template <class T>
 class cbor_array_iterator
 {
@@ -1226,6 +1668,10 @@ public:
 
     std::string key() const
     {
+        if (get_major_type(*key_begin_) == cbor_major_type::semantic_tag)
+        {
+            return T(key_begin_, key_end_ - key_begin_, base_relative_).as_string();
+        }
         jsoncons::buffer_source source(key_begin_, key_end_ - key_begin_);
         std::error_code ec;
         std::string s = get_text_string(source,ec);
@@ -1379,6 +1825,341 @@ public:
     }
 };
 
+// Offsets of the items of the arrays and maps in a CBOR buffer, built in one
+// pass over the buffer, so that elements and member values can be located 
+// without walking the items before them. The strings that stringrefs refer 
+// to are recorded in the same pass.
+class cbor_view_index
+{
+public:
+    typedef basic_string_view<char> string_view_type;
+    typedef std::pair<const uint8_t*,const uint8_t*> item_type;
+
+    struct key_hash
+    {
+        size_t operator()(const string_view_type& s) const
+        {
+            size_t h = 14695981039346656037ULL;
+            for (char c : s)
+            {
+                h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+            }
+            return h;
+        }
+    };
+
+    struct node
+    {
+        // The beginning of each item, keys and values alternating for maps, 
+        // followed by the end of the last item
+        std::vector<const uint8_t*> items;
+        // For each array element or map value, the position of its node plus one 
+        // if it is an array or map, otherwise 0
+        std::vector<size_t> nested;
+        // The position of the member with each key, only for maps with more than 
+        // max_unhashed_members members
+        std::unordered_map<string_view_type,size_t,key_hash> members;
+        bool is_map;
+
+        size_t size() const
+        {
+            return is_map ? nested.size() : items.size() - 1;
+        }
+    };
+
+    static const size_t max_unhashed_members = 8;
+private:
+    const uint8_t* base_;
+    const uint8_t* last_;
+    std::vector<node> nodes_;
+    std::vector<std::unique_ptr<std::string>> keys_;
+    std::vector<std::vector<item_type>> namespaces_;
+    std::unordered_map<const uint8_t*,item_type> stringrefs_;
+public:
+    // Indexes the arrays and maps in the item at the beginning of data, base is 
+    // the beginning of the outermost item, from which stringrefs to strings
+    // outside the item are resolved
+    cbor_view_index(const uint8_t* data, size_t length, const uint8_t* base)
+        : base_(base), last_(data + length)
+    {
+        std::error_code ec;
+        size_t pos = 0;
+        const uint8_t* endp = read_item(data, pos, ec);
+        if (ec)
+        {
+            throw serialization_error(ec, endp - data + 1);
+        }
+        namespaces_.clear();
+        for (auto& n : nodes_)
+        {
+            hash_members(n);
+        }
+    }
+
+    cbor_view_index(const cbor_view_index&) = delete;
+    cbor_view_index& operator=(const cbor_view_index&) = delete;
+
+    const node* root() const
+    {
+        return nodes_.empty() ? nullptr : &nodes_[0];
+    }
+
+    const node* nested(const node& n, size_t i) const
+    {
+        return n.nested[i] == 0 ? nullptr : &nodes_[n.nested[i]-1];
+    }
+
+    // Sets first and last to the string that the stringref at ref refers to
+    void resolve(const uint8_t* ref, const uint8_t*& first, const uint8_t*& last, std::error_code& ec) const
+    {
+        auto it = stringrefs_.find(ref);
+        if (it != stringrefs_.end())
+        {
+            first = it->second.first;
+            last = it->second.second;
+            return;
+        }
+        stringref_resolver resolver(ref, last_);
+        resolver.resolve(base_, first, last, ec);
+    }
+
+    // Returns the position of the first member with key name, or the size of the map
+    size_t find(const node& n, const string_view_type& name) const
+    {
+        const size_t count = n.nested.size();
+        if (count > max_unhashed_members)
+        {
+            auto it = n.members.find(name);
+            return it != n.members.end() ? it->second : count;
+        }
+        std::string buffer;
+        for (size_t i = 0; i < count; ++i)
+        {
+            string_view_type key;
+            if (get_key(n.items[2*i], n.items[2*i+1], buffer, key) && key == name)
+            {
+                return i;
+            }
+        }
+        return count;
+    }
+private:
+    // Gets a text string key, as a view of the buffer if it has a definite length, 
+    // otherwise decoded into buffer
+    bool get_key(const uint8_t* first, const uint8_t* last, std::string& buffer, string_view_type& key) const
+    {
+        std::error_code ec;
+        while (first < last && get_major_type(*first) == cbor_major_type::semantic_tag)
+        {
+            jsoncons::buffer_source source(first, last - first);
+            uint64_t tag = get_uint64_value(source, ec);
+            if (ec)
+            {
+                return false;
+            }
+            if (tag == 25)
+            {
+                resolve(first, first, last, ec);
+                if (ec)
+                {
+                    return false;
+                }
+                break;
+            }
+            first += source.position() - 1;
+        }
+        if (first >= last || get_major_type(*first) != cbor_major_type::text_string)
+        {
+            return false;
+        }
+        jsoncons::buffer_source source(first, last - first);
+        if (get_additional_information_value(*first) == additional_info::indefinite_length)
+        {
+            buffer = get_text_string(source, ec);
+            if (ec)
+            {
+                return false;
+            }
+            key = string_view_type(buffer);
+            return true;
+        }
+        size_t length = get_length(source, ec);
+        if (ec)
+        {
+            return false;
+        }
+        const uint8_t* s = first + source.position() - 1;
+        key = string_view_type(reinterpret_cast<const char*>(s), length);
+        return true;
+    }
+
+    // Reads the item at p and returns its end. If the item is an array or map, 
+    // pos is set to the position of its node plus one, otherwise to 0.
+    const uint8_t* read_item(const uint8_t* p, size_t& pos, std::error_code& ec)
+    {
+        pos = 0;
+        if (p >= last_)
+        {
+            ec = cbor_errc::unexpected_eof;
+            return p;
+        }
+        jsoncons::buffer_source source(p, last_ - p);
+        const uint8_t info = get_additional_information_value(*p);
+        switch (get_major_type(*p))
+        {
+            case cbor_major_type::semantic_tag:
+            {
+                uint64_t tag = get_uint64_value(source, ec);
+                if (ec)
+                {
+                    return p;
+                }
+                const uint8_t* q = p + source.position() - 1;
+                if (tag == 25)
+                {
+                    uint64_t index = get_uint64_value(source, ec);
+                    if (!ec && !namespaces_.empty() && index < namespaces_.back().size())
+                    {
+                        stringrefs_.emplace(p, namespaces_.back()[(size_t)index]);
+                    }
+                    return p + source.position() - 1;
+                }
+                if (tag == 256)
+                {
+                    namespaces_.emplace_back();
+                    q = read_item(q, pos, ec);
+                    namespaces_.pop_back();
+                    return q;
+                }
+                return read_item(q, pos, ec);
+            }
+            case cbor_major_type::byte_string:
+            case cbor_major_type::text_string:
+            {
+                size_t length = 0;
+                if (info == additional_info::indefinite_length)
+                {
+                    length = get_major_type(*p) == cbor_major_type::text_string ? get_text_string(source, ec).size() : get_byte_string(source, ec).size();
+                }
+                else
+                {
+                    length = get_length(source, ec);
+                    source.ignore(length);
+                }
+                const uint8_t* endp = p + source.position() - 1;
+                if (!namespaces_.empty() && length >= min_length_for_stringref(namespaces_.back().size()))
+                {
+                    namespaces_.back().emplace_back(p, endp);
+                }
+                return endp;
+            }
+            case cbor_major_type::array:
+            case cbor_major_type::map:
+            {
+                pos = nodes_.size() + 1;
+                return index_container(p, source, ec);
+            }
+            default:
+            {
+                walk(source, ec);
+                return p + source.position() - 1;
+            }
+        }
+    }
+
+    // Indexes the array or map at p, and returns its end
+    const uint8_t* index_container(const uint8_t* p, jsoncons::buffer_source& source, std::error_code& ec)
+    {
+        const size_t pos = nodes_.size();
+        nodes_.emplace_back();
+
+        std::vector<const uint8_t*> items;
+        std::vector<size_t> nested;
+        const bool is_map = get_major_type(*p) == cbor_major_type::map;
+        const bool indefinite = get_additional_information_value(*p) == additional_info::indefinite_length;
+
+        size_t length = 0;
+        if (indefinite)
+        {
+            source.ignore(1);
+        }
+        else
+        {
+            length = get_length(source, ec);
+            if (ec)
+            {
+                return p;
+            }
+            if (is_map)
+            {
+                length *= 2;
+            }
+        }
+        items.reserve(length+1);
+        nested.reserve(is_map ? length/2 : length);
+
+        const uint8_t* q = p + source.position() - 1;
+        for (size_t i = 0; indefinite ? (q < last_ && *q != 0xff) : i < length; ++i)
+        {
+            items.push_back(q);
+            size_t child = 0;
+            q = read_item(q, child, ec);
+            if (ec)
+            {
+                return q;
+            }
+            if (!is_map || i % 2 == 1)
+            {
+                nested.push_back(child);
+            }
+        }
+        if (is_map && items.size() % 2 != 0)
+        {
+            ec = cbor_errc::unexpected_eof;
+            return q;
+        }
+        items.push_back(q);
+        if (indefinite)
+        {
+            if (q >= last_)
+            {
+                ec = cbor_errc::unexpected_eof;
+                return q;
+            }
+            ++q;
+        }
+
+        node& n = nodes_[pos];
+        n.is_map = is_map;
+        n.items = std::move(items);
+        n.nested = std::move(nested);
+        return q;
+    }
+
+    void hash_members(node& n)
+    {
+        if (!n.is_map || n.nested.size() <= max_unhashed_members)
+        {
+            return;
+        }
+        n.members.reserve(n.nested.size());
+        std::string buffer;
+        for (size_t i = 0; i < n.nested.size(); ++i)
+        {
+            string_view_type key;
+            if (get_key(n.items[2*i], n.items[2*i+1], buffer, key))
+            {
+                if (key.data() == buffer.data())
+                {
+                    keys_.emplace_back(new std::string(buffer));
+                    key = string_view_type(*keys_.back());
+                }
+                n.members.emplace(key, i);
+            }
+        }
+    }
+};
+
 } // namespace detail
 
 }}
@@ -20,7 +20,8 @@ enum class cbor_errc
     invalid_decimal,
     invalid_utf8_text_string,
     too_many_items,
-    too_few_items
+    too_few_items,
+    stringref_too_large
 };
 
 class cbor_error_category_impl
@@ -47,6 +48,8 @@ public:
                 return "Too many items were added to a CBOR map or array of known length";
             case cbor_errc::too_few_items:
                 return "Too few items were added to a CBOR map or array of known length";
+            case cbor_errc::stringref_too_large:
+                return "String reference exceeds the strings of its namespace";
            default:
                 return "Unknown CBOR parser error";
         }
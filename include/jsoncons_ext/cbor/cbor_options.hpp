@@ -0,0 +1,62 @@
+// Copyright 2019 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CBOR_CBOR_OPTIONS_HPP
+#define JSONCONS_CBOR_CBOR_OPTIONS_HPP
+
+namespace jsoncons { namespace cbor {
+
+class cbor_options
+{
+    bool pack_strings_;
+    bool canonical_;
+public:
+    static const cbor_options& default_options()
+    {
+        static cbor_options options{};
+        return options;
+    }
+
+//  Constructors
+
+    cbor_options()
+        : pack_strings_(false), canonical_(false)
+    {
+    }
+
+//  Properties
+
+    // If true, a top level array or map is encoded as a stringref namespace (tag 256), 
+    // and strings that repeat an earlier string in it as stringrefs (tag 25)
+    bool pack_strings() const
+    {
+        return pack_strings_;
+    }
+
+    cbor_options& pack_strings(bool value)
+    {
+        pack_strings_ = value;
+        return *this;
+    }
+
+    // If true, data items are encoded deterministically (RFC 8949 section 4.2.1): 
+    // arrays and maps with definite lengths, the items of maps in the bytewise 
+    // order of their encoded keys, and floating point numbers in the shortest 
+    // form that holds them exactly. Stringrefs are not used.
+    bool canonical() const
+    {
+        return canonical_;
+    }
+
+    cbor_options& canonical(bool value)
+    {
+        canonical_ = value;
+        return *this;
+    }
+};
+
+}}
+#endif
@@ -25,10 +25,15 @@ namespace jsoncons { namespace cbor {
 template <class Source>
 class basic_cbor_reader : public serializing_context
 {
+    // A string of a stringref namespace, a text string or a byte string
+    typedef std::pair<cbor_major_type,std::string> stringref_type;
+
     Source source_;
     json_content_handler& handler_;
     size_t nesting_depth_;
     std::string buffer_;
+    std::vector<uint8_t> string_buffer_;
+    std::vector<std::vector<stringref_type>> stringref_namespaces_;
 public:
     basic_cbor_reader(Source source, json_content_handler& handler)
        : source_(std::move(source)),
@@ -69,7 +74,7 @@ private:
         }   
 
         bool has_cbor_tag = false;
-        uint8_t cbor_tag = 0;
+        uint64_t cbor_tag = 0;
 
         cbor_major_type major_type;
         uint8_t info;
@@ -88,8 +93,19 @@ private:
         if (major_type == cbor_major_type::semantic_tag)
         {
             has_cbor_tag = true;
-            cbor_tag = info;
-            source_.ignore(1);
+            cbor_tag = jsoncons::cbor::detail::get_uint64_value(source_, ec);
+            if (ec)
+            {
+                return;
+            }
+            if (cbor_tag == 256)
+            {
+                // stringref namespace
+                stringref_namespaces_.emplace_back();
+                read_internal(ec);
+                stringref_namespaces_.pop_back();
+                return;
+            }
             c = source_.peek();
             switch (c)
             {
@@ -113,7 +129,24 @@ private:
                     return;
                 }
 
-                if (has_cbor_tag && cbor_tag == 1)
+                if (has_cbor_tag && cbor_tag == 25)
+                {
+                    const stringref_type* ref = get_stringref(val, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    if (ref->first == cbor_major_type::text_string)
+                    {
+                        handler_.string_value(basic_string_view<char>(ref->second.data(),ref->second.length()), semantic_tag_type::none, *this);
+                    }
+                    else
+                    {
+                        handler_.byte_string_value(byte_string_view(reinterpret_cast<const uint8_t*>(ref->second.data()), ref->second.length()), 
+                                                   byte_string_chars_format::none, semantic_tag_type::none, *this);
+                    }
+                }
+                else if (has_cbor_tag && cbor_tag == 1)
                 {
                     handler_.uint64_value(val, semantic_tag_type::timestamp, *this);
                 }
@@ -142,13 +175,40 @@ private:
             }
             case cbor_major_type::byte_string:
             {
-                std::vector<uint8_t> v = jsoncons::cbor::detail::get_byte_string(source_, ec);
+                const bool is_typed_array = has_cbor_tag && jsoncons::cbor::detail::is_typed_array_tag(cbor_tag);
+                if (is_typed_array && info != additional_info::indefinite_length && stringref_namespaces_.empty())
+                {
+                    // Read straight into the typed array
+                    size_t length = jsoncons::cbor::detail::get_length(source_, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    jsoncons::cbor::detail::read_typed_array(source_, cbor_tag, length, handler_, *this, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    break;
+                }
+
+                byte_string_view v = jsoncons::cbor::detail::get_string_view(source_, string_buffer_, ec);
                 if (ec)
                 {
                     return;
                 }
+                add_stringref(cbor_major_type::byte_string, v.begin(), v.end());
 
-                if (has_cbor_tag)
+                if (is_typed_array)
+                {
+                    jsoncons::buffer_source bytes(v.data(), v.size());
+                    jsoncons::cbor::detail::read_typed_array(bytes, cbor_tag, v.size(), handler_, *this, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                }
+                else if (has_cbor_tag)
                 {
                     switch (cbor_tag)
                     {
@@ -170,40 +230,42 @@ private:
                             }
                         case 0x15:
                             {
-                                handler_.byte_string_value(byte_string_view(v.data(), v.size()), byte_string_chars_format::base64url, semantic_tag_type::none, *this);
+                                handler_.byte_string_value(v, byte_string_chars_format::base64url, semantic_tag_type::none, *this);
                                 break;
                             }
                         case 0x16:
                             {
-                                handler_.byte_string_value(byte_string_view(v.data(), v.size()), byte_string_chars_format::base64, semantic_tag_type::none, *this);
+                                handler_.byte_string_value(v, byte_string_chars_format::base64, semantic_tag_type::none, *this);
                                 break;
                             }
                         case 0x17:
                             {
-                                handler_.byte_string_value(byte_string_view(v.data(), v.size()), byte_string_chars_format::base16, semantic_tag_type::none, *this);
+                                handler_.byte_string_value(v, byte_string_chars_format::base16, semantic_tag_type::none, *this);
                                 break;
                             }
                         default:
-                            handler_.byte_string_value(byte_string_view(v.data(), v.size()), byte_string_chars_format::none, semantic_tag_type::none, *this);
+                            handler_.byte_string_value(v, byte_string_chars_format::none, semantic_tag_type::none, *this);
                             break;
                     }
                 }
                 else
                 {
-                    handler_.byte_string_value(byte_string_view(v.data(), v.size()), byte_string_chars_format::none, semantic_tag_type::none, *this);
+                    handler_.byte_string_value(v, byte_string_chars_format::none, semantic_tag_type::none, *this);
                 }
                 break;
             }
             case cbor_major_type::text_string:
             {
-                std::string s = jsoncons::cbor::detail::get_text_string(source_, ec);
+                byte_string_view v = jsoncons::cbor::detail::get_string_view(source_, string_buffer_, ec);
                 if (ec)
                 {
                     return;
                 }
+                add_stringref(cbor_major_type::text_string, v.begin(), v.end());
+                basic_string_view<char> s(reinterpret_cast<const char*>(v.data()), v.length());
                 if (has_cbor_tag && cbor_tag == 0)
                 {
-                    handler_.string_value(basic_string_view<char>(s.data(),s.length()), semantic_tag_type::date_time, *this);
+                    handler_.string_value(s, semantic_tag_type::date_time, *this);
                 }
                 else
                 {
@@ -213,7 +275,7 @@ private:
                         ec = cbor_errc::invalid_utf8_text_string;
                         return;
                     }
-                    handler_.string_value(basic_string_view<char>(s.data(),s.length()), semantic_tag_type::none, *this);
+                    handler_.string_value(s, semantic_tag_type::none, *this);
                 }
                 break;
             }
@@ -236,11 +298,13 @@ private:
                 }
                 if (tag == semantic_tag_type::big_decimal)
                 {
-                    std::string s = jsoncons::cbor::detail::get_array_as_decimal_string(source_, ec);
+                    std::vector<uint8_t> bignum_bytes;
+                    std::string s = jsoncons::cbor::detail::get_array_as_decimal_string(source_, ec, &bignum_bytes);
                     if (ec)
                     {
                         return;
                     }
+                    add_stringref(cbor_major_type::byte_string, bignum_bytes.begin(), bignum_bytes.end());
                     handler_.string_value(s, semantic_tag_type::big_decimal);
                 }
                 else
@@ -440,30 +504,75 @@ private:
         {
             case cbor_major_type::text_string:
             {
-                std::string s = jsoncons::cbor::detail::get_text_string(source_,ec);
+                byte_string_view v = jsoncons::cbor::detail::get_string_view(source_, string_buffer_, ec);
                 if (ec)
                 {
                     return;
                 }
+                add_stringref(cbor_major_type::text_string, v.begin(), v.end());
+                basic_string_view<char> s(reinterpret_cast<const char*>(v.data()), v.length());
                 auto result = unicons::validate(s.begin(),s.end());
                 if (result.ec != unicons::conv_errc())
                 {
                     ec = cbor_errc::invalid_utf8_text_string;
                     return;
                 }
-                handler_.name(basic_string_view<char>(s.data(),s.length()), *this);
+                handler_.name(s, *this);
                 break;
             }
             case cbor_major_type::byte_string:
             {
-                std::vector<uint8_t> v = jsoncons::cbor::detail::get_byte_string(source_,ec);
+                byte_string_view v = jsoncons::cbor::detail::get_string_view(source_, string_buffer_, ec);
                 if (ec)
                 {
                     return;
                 }
-                std::string s;
-                encode_base64url(v.data(),v.size(),s);
-                handler_.name(basic_string_view<char>(s.data(),s.length()), *this);
+                add_stringref(cbor_major_type::byte_string, v.begin(), v.end());
+                buffer_.clear();
+                encode_base64url(v.data(),v.size(),buffer_);
+                handler_.name(basic_string_view<char>(buffer_.data(),buffer_.length()), *this);
+                break;
+            }
+            case cbor_major_type::semantic_tag:
+            {
+                uint64_t tag = jsoncons::cbor::detail::get_uint64_value(source_, ec);
+                if (ec)
+                {
+                    return;
+                }
+                if (tag == 256)
+                {
+                    stringref_namespaces_.emplace_back();
+                    read_name(ec);
+                    stringref_namespaces_.pop_back();
+                    return;
+                }
+                if (tag != 25)
+                {
+                    // The name is the tagged item
+                    read_name(ec);
+                    return;
+                }
+                uint64_t index = jsoncons::cbor::detail::get_uint64_value(source_, ec);
+                if (ec)
+                {
+                    return;
+                }
+                const stringref_type* ref = get_stringref(index, ec);
+                if (ec)
+                {
+                    return;
+                }
+                if (ref->first == cbor_major_type::text_string)
+                {
+                    handler_.name(basic_string_view<char>(ref->second.data(),ref->second.length()), *this);
+                }
+                else
+                {
+                    std::string s;
+                    encode_base64url(reinterpret_cast<const uint8_t*>(ref->second.data()),ref->second.length(),s);
+                    handler_.name(basic_string_view<char>(s.data(),s.length()), *this);
+                }
                 break;
             }
             default:
@@ -471,8 +580,10 @@ private:
                 std::string s;
                 json_string_serializer serializer(s);
                 basic_cbor_reader<Source> reader(std::move(source_), serializer);
+                reader.stringref_namespaces_ = std::move(stringref_namespaces_);
                 reader.read(ec);
                 source_ = std::move(reader.source_);
+                stringref_namespaces_ = std::move(reader.stringref_namespaces_);
                 auto result = unicons::validate(s.begin(),s.end());
                 if (result.ec != unicons::conv_errc())
                 {
@@ -483,6 +594,30 @@ private:
             }
         }
     }
+
+    // Adds a string to the current stringref namespace, if it is long enough
+    template <class Iterator>
+    void add_stringref(cbor_major_type major_type, Iterator first, Iterator last)
+    {
+        if (!stringref_namespaces_.empty())
+        {
+            auto& strings = stringref_namespaces_.back();
+            if ((size_t)std::distance(first, last) >= jsoncons::cbor::detail::min_length_for_stringref(strings.size()))
+            {
+                strings.emplace_back(major_type, std::string(first, last));
+            }
+        }
+    }
+
+    const stringref_type* get_stringref(uint64_t index, std::error_code& ec) const
+    {
+        if (stringref_namespaces_.empty() || index >= stringref_namespaces_.back().size())
+        {
+            ec = cbor_errc::stringref_too_large;
+            return nullptr;
+        }
+        return &stringref_namespaces_.back()[(size_t)index];
+    }
 };
 
 typedef basic_cbor_reader<jsoncons::binary_stream_source> cbor_reader;
@@ -0,0 +1,230 @@
+// Copyright 2019 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CBOR_CBOR_SEQUENCE_READER_HPP
+#define JSONCONS_CBOR_CBOR_SEQUENCE_READER_HPP
+
+#include <vector>
+#include <thread> // std::thread
+#include <exception> // std::exception_ptr
+#include <algorithm> // std::min
+#include <type_traits> // std::enable_if
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_filter.hpp>
+#include <jsoncons/source.hpp>
+#include <jsoncons_ext/cbor/cbor_error.hpp>
+#include <jsoncons_ext/cbor/cbor_detail.hpp>
+#include <jsoncons_ext/cbor/cbor_reader.hpp>
+#include <jsoncons_ext/cbor/cbor_view.hpp>
+
+namespace jsoncons { namespace cbor {
+
+// A CBOR sequence (RFC 8742), the concatenation of zero or more complete
+// CBOR data items, held in a buffer. The constructor finds where each item
+// begins by walking over the items without decoding them. The items can
+// then be read one at a time, in order, or in contiguous ranges on separate
+// threads. The buffer must outlive the reader.
+class cbor_sequence_reader
+{
+    const uint8_t* data_;
+    size_t length_;
+    // The offset of each item, followed by length_
+    std::vector<size_t> offsets_;
+public:
+    cbor_sequence_reader(const uint8_t* data, size_t length)
+        : data_(data), length_(length)
+    {
+        std::error_code ec;
+        size_t position = find_items(ec);
+        if (ec)
+        {
+            throw serialization_error(ec,position);
+        }
+    }
+
+    cbor_sequence_reader(const uint8_t* data, size_t length, std::error_code& ec)
+        : data_(data), length_(length)
+    {
+        find_items(ec);
+    }
+
+    cbor_sequence_reader(const std::vector<uint8_t>& v)
+        : cbor_sequence_reader(v.data(), v.size())
+    {
+    }
+
+    size_t size() const
+    {
+        return offsets_.size() - 1;
+    }
+
+    cbor_view operator[](size_t i) const
+    {
+        return cbor_view(data_ + offsets_[i], offsets_[i+1] - offsets_[i]);
+    }
+
+    // Writes the items first to last-1 to handler, in order
+    void read(size_t first, size_t last, json_content_handler& handler, std::error_code& ec) const
+    {
+        for (size_t i = first; i < last && !ec; ++i)
+        {
+            read_item(i, handler, ec);
+        }
+    }
+
+    void read(json_content_handler& handler, std::error_code& ec) const
+    {
+        read(0, size(), handler, ec);
+    }
+
+    // Splits the items into handlers.size() contiguous ranges of about the
+    // same number of items, and writes the k'th range to *handlers[k], on a
+    // thread of its own. Each handler receives its items in order. If reading
+    // fails, ec is set to the error of the earliest range that failed.
+    void read(const std::vector<json_content_handler*>& handlers, std::error_code& ec) const
+    {
+        std::vector<std::error_code> errors(handlers.size());
+        run_partitions(handlers.size(), [&](size_t k, size_t first, size_t last)
+        {
+            read(first, last, *handlers[k], errors[k]);
+        });
+        for (const auto& e : errors)
+        {
+            if (e)
+            {
+                ec = e;
+                return;
+            }
+        }
+    }
+
+    // Decodes the items into json values, on up to max_threads threads.
+    // Throws serialization_error if an item cannot be decoded.
+    template <class Json>
+    std::vector<Json> decode(size_t max_threads = 1) const
+    {
+        std::vector<Json> values(size());
+        size_t count = (std::max)((size_t)1, (std::min)(max_threads, size()));
+        std::vector<std::error_code> errors(count);
+        std::vector<size_t> positions(count);
+        run_partitions(count, [&](size_t k, size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; ++i)
+            {
+                json_decoder<Json> decoder;
+                positions[k] = decode_item(i, decoder, errors[k]);
+                if (errors[k])
+                {
+                    return;
+                }
+                values[i] = decoder.get_result();
+            }
+        });
+        for (size_t k = 0; k < count; ++k)
+        {
+            if (errors[k])
+            {
+                throw serialization_error(errors[k],positions[k]);
+            }
+        }
+        return values;
+    }
+private:
+    size_t find_items(std::error_code& ec)
+    {
+        jsoncons::buffer_source source(data_, length_);
+        size_t offset = 0;
+        while (offset < length_)
+        {
+            offsets_.push_back(offset);
+            jsoncons::cbor::detail::walk(source, ec);
+            if (!ec && source.eof())
+            {
+                ec = cbor_errc::unexpected_eof;
+            }
+            if (ec)
+            {
+                offsets_.clear();
+                break;
+            }
+            // position() is one based
+            offset = source.position() - 1;
+        }
+        offsets_.push_back(length_);
+        return source.position();
+    }
+
+    // Returns the position in the sequence reached
+    size_t read_item(size_t i, json_content_handler& handler, std::error_code& ec) const
+    {
+        cbor_buffer_reader reader(jsoncons::buffer_source(data_ + offsets_[i], offsets_[i+1] - offsets_[i]), handler);
+        reader.read(ec);
+        return offsets_[i] + reader.column_number();
+    }
+
+    template <class Json>
+    typename std::enable_if<std::is_same<typename Json::char_type,char>::value,size_t>::type
+    decode_item(size_t i, json_decoder<Json>& decoder, std::error_code& ec) const
+    {
+        return read_item(i, decoder, ec);
+    }
+
+    template <class Json>
+    typename std::enable_if<!std::is_same<typename Json::char_type,char>::value,size_t>::type
+    decode_item(size_t i, json_decoder<Json>& decoder, std::error_code& ec) const
+    {
+        basic_utf8_adaptor<typename Json::char_type> adaptor(decoder);
+        return read_item(i, adaptor, ec);
+    }
+
+    // Calls f(k, first, last) for count contiguous ranges of the items,
+    // the first on the calling thread and the others on threads of their own
+    template <class F>
+    void run_partitions(size_t count, F f) const
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        std::vector<std::exception_ptr> exceptions(count);
+        auto run = [&](size_t k)
+        {
+            size_t first = k*size()/count;
+            size_t last = (k+1)*size()/count;
+            try
+            {
+                f(k, first, last);
+            }
+            catch (...)
+            {
+                exceptions[k] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(count-1);
+        for (size_t k = 1; k < count; ++k)
+        {
+            threads.emplace_back(run, k);
+        }
+        run(0);
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+        for (auto& e : exceptions)
+        {
+            if (e)
+            {
+                std::rethrow_exception(e);
+            }
+        }
+    }
+};
+
+}}
+
+#endif
@@ -11,7 +11,12 @@
 #include <vector>
 #include <limits> // std::numeric_limits
 #include <memory>
+#include <unordered_map>
 #include <utility> // std::move
+#include <algorithm> // std::stable_sort, std::lexicographical_compare
+#include <cmath> // std::isnan
+#include <cstring> // std::memcpy
+#include <type_traits> // std::is_same
 #include <jsoncons/json_exception.hpp>
 #include <jsoncons/jsoncons_utilities.hpp>
 #include <jsoncons/json_content_handler.hpp>
@@ -19,11 +24,43 @@
 #include <jsoncons/result.hpp>
 #include <jsoncons/detail/parse_number.hpp>
 #include <jsoncons_ext/cbor/cbor_error.hpp>
+#include <jsoncons_ext/cbor/cbor_options.hpp>
 
 namespace jsoncons { namespace cbor {
 
 enum class cbor_container_type {object, indefinite_length_object, array, indefinite_length_array};
 
+namespace detail {
+
+// The minimum length of a string that is added to a stringref namespace 
+// holding count strings, shorter strings would not be shortened by a stringref
+inline
+size_t min_length_for_stringref(uint64_t count)
+{
+    if (count < 24)
+    {
+        return 3;
+    }
+    else if (count < 256)
+    {
+        return 4;
+    }
+    else if (count < 65536)
+    {
+        return 5;
+    }
+    else if (count < 4294967296ull)
+    {
+        return 7;
+    }
+    else
+    {
+        return 11;
+    }
+}
+
+}
+
 template<class CharT,class Result=jsoncons::binary_stream_result>
 class basic_cbor_serializer final : public basic_json_content_handler<CharT>
 {
@@ -40,9 +77,13 @@ private:
         cbor_container_type type_;
         size_t length_;
         size_t count_;
+        // In canonical mode, the offset in the arena of the first item,
+        // and the index in keys_ of the first key of a map
+        size_t offset_;
+        size_t first_key_;
 
-        stack_item(cbor_container_type type, size_t length = 0)
-           : type_(type), length_(length), count_(0)
+        stack_item(cbor_container_type type, size_t length = 0, size_t offset = 0, size_t first_key = 0)
+           : type_(type), length_(length), count_(0), offset_(offset), first_key_(first_key)
         {
         }
 
@@ -67,15 +108,98 @@ private:
         }
 
     };
+    // Writes to the result, or in canonical mode to the arena, where the 
+    // items of maps are put in order before the top level data item is 
+    // written to the result
+    class output
+    {
+        Result result_;
+        std::vector<uint8_t> arena_;
+        bool canonical_;
+    public:
+        typedef uint8_t value_type;
+
+        output(Result&& result, bool canonical)
+            : result_(std::move(result)), canonical_(canonical)
+        {
+        }
+
+        std::vector<uint8_t>& arena()
+        {
+            return arena_;
+        }
+
+        void push_back(uint8_t c)
+        {
+            if (canonical_)
+            {
+                arena_.push_back(c);
+            }
+            else
+            {
+                result_.push_back(c);
+            }
+        }
+
+        void insert(const uint8_t* s, size_t length)
+        {
+            if (canonical_)
+            {
+                arena_.insert(arena_.end(), s, s + length);
+            }
+            else
+            {
+                result_.insert(s, length);
+            }
+        }
+
+        // Writes the arena to the result
+        void commit()
+        {
+            result_.insert(arena_.data(), arena_.size());
+            arena_.clear();
+        }
+
+        void flush()
+        {
+            result_.flush();
+        }
+    };
+
     std::vector<stack_item> stack_;
-    Result result_;
+    cbor_options options_;
+    output output_;
+
+    // In canonical mode, the offsets of the first and last+1 bytes of the 
+    // keys of the open maps in the arena, and scratch space for reordering 
+    // map items and writing lengths
+    std::vector<size_t> keys_;
+    std::vector<size_t> order_;
+    std::vector<uint8_t> scratch_;
+
+    // The strings of the current stringref namespace, and their indexes
+    bool stringref_namespace_;
+    std::unordered_map<std::string,size_t> text_stringrefs_;
+    std::unordered_map<std::string,size_t> byte_stringrefs_;
+    size_t next_stringref_;
 
     // Noncopyable and nonmoveable
     basic_cbor_serializer(const basic_cbor_serializer&) = delete;
     basic_cbor_serializer& operator=(const basic_cbor_serializer&) = delete;
 public:
     explicit basic_cbor_serializer(result_type result)
-       : result_(std::move(result))
+       : options_(cbor_options::default_options()),
+         output_(std::move(result), options_.canonical()),
+         stringref_namespace_(false),
+         next_stringref_(0)
+    {
+    }
+
+    basic_cbor_serializer(result_type result, const cbor_options& options)
+       : options_(options),
+         output_(std::move(result), options_.canonical()),
+         stringref_namespace_(false),
+         next_stringref_(0)
     {
     }
 
@@ -83,7 +207,7 @@ public:
     {
         try
         {
-            result_.flush();
+            output_.flush();
         }
         catch (...)
         {
@@ -95,54 +219,29 @@ private:
 
     void do_flush() override
     {
-        result_.flush();
+        output_.flush();
     }
 
     bool do_begin_object(semantic_tag_type, const serializing_context&) override
     {
+        begin_stringref_namespace();
+        if (options_.canonical())
+        {
+            // The length is written when the map ends
+            stack_.push_back(stack_item(cbor_container_type::indefinite_length_object, 0, output_.arena().size(), keys_.size()));
+            return true;
+        }
         stack_.push_back(stack_item(cbor_container_type::indefinite_length_object));
         
-        result_.push_back(0xbf);
+        output_.push_back(0xbf);
         return true;
     }
 
     bool do_begin_object(size_t length, semantic_tag_type, const serializing_context&) override
     {
-        stack_.push_back(stack_item(cbor_container_type::object, length));
-
-        if (length <= 0x17)
-        {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0xa0 + length), 
-                                  std::back_inserter(result_));
-        } 
-        else if (length <= 0xff)
-        {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0xb8), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(length), 
-                                  std::back_inserter(result_));
-        } 
-        else if (length <= 0xffff)
-        {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0xb9), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint16_t>(length), 
-                                  std::back_inserter(result_));
-        } 
-        else if (length <= 0xffffffff)
-        {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0xba), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint32_t>(length), 
-                                  std::back_inserter(result_));
-        } 
-        else if (length <= 0xffffffffffffffff)
-        {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0xbb), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint64_t>(length), 
-                                  std::back_inserter(result_));
-        }
+        begin_stringref_namespace();
+        write_header(0xa0, length, output_);
+        stack_.push_back(stack_item(cbor_container_type::object, length, output_.arena().size(), keys_.size()));
 
         return true;
     }
@@ -150,9 +249,21 @@ private:
     bool do_end_object(const serializing_context&) override
     {
         JSONCONS_ASSERT(!stack_.empty());
+        if (options_.canonical())
+        {
+            sort_map_items(stack_.back());
+            keys_.resize(stack_.back().first_key_);
+        }
         if (stack_.back().is_indefinite_length())
         {
-            result_.push_back(0xff);
+            if (options_.canonical())
+            {
+                insert_header(0xa0, stack_.back());
+            }
+            else
+            {
+                output_.push_back(0xff);
+            }
         }
         else
         {
@@ -167,6 +278,10 @@ private:
         }
 
         stack_.pop_back();
+        if (stack_.empty())
+        {
+            stringref_namespace_ = false;
+        }
         end_value();
 
         return true;
@@ -174,51 +289,30 @@ private:
 
     bool do_begin_array(semantic_tag_type, const serializing_context&) override
     {
+        begin_stringref_namespace();
+        if (options_.canonical())
+        {
+            // The length is written when the array ends
+            stack_.push_back(stack_item(cbor_container_type::indefinite_length_array, 0, output_.arena().size()));
+            return true;
+        }
         stack_.push_back(stack_item(cbor_container_type::indefinite_length_array));
-        result_.push_back(0x9f);
+        output_.push_back(0x9f);
         return true;
     }
 
     bool do_begin_array(size_t length, semantic_tag_type tag, const serializing_context&) override
     {
-        if (length == 2 && tag == semantic_tag_type::big_float)
+        if (tag != semantic_tag_type::big_decimal)
         {
-            result_.push_back(0xc5);
+            begin_stringref_namespace();
         }
-        stack_.push_back(stack_item(cbor_container_type::array, length));
-        if (length <= 0x17)
-        {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x80 + length), 
-                                  std::back_inserter(result_));
-        } 
-        else if (length <= 0xff)
-        {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x98), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(length), 
-                                  std::back_inserter(result_));
-        } 
-        else if (length <= 0xffff)
-        {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x99), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint16_t>(length), 
-                                  std::back_inserter(result_));
-        } 
-        else if (length <= 0xffffffff)
-        {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x9a), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint32_t>(length), 
-                                  std::back_inserter(result_));
-        } 
-        else if (length <= 0xffffffffffffffff)
+        if (length == 2 && tag == semantic_tag_type::big_float)
         {
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x9b), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint64_t>(length), 
-                                  std::back_inserter(result_));
+            output_.push_back(0xc5);
         }
+        write_header(0x80, length, output_);
+        stack_.push_back(stack_item(cbor_container_type::array, length, output_.arena().size()));
         return true;
     }
 
@@ -228,7 +322,14 @@ private:
 
         if (stack_.back().is_indefinite_length())
         {
-            result_.push_back(0xff);
+            if (options_.canonical())
+            {
+                insert_header(0x80, stack_.back());
+            }
+            else
+            {
+                output_.push_back(0xff);
+            }
         }
         else
         {
@@ -243,6 +344,10 @@ private:
         }
 
         stack_.pop_back();
+        if (stack_.empty())
+        {
+            stringref_namespace_ = false;
+        }
         end_value();
 
         return true;
@@ -250,26 +355,206 @@ private:
 
     bool do_name(const string_view_type& name, const serializing_context&) override
     {
-        write_string(name);
+        if (options_.canonical())
+        {
+            keys_.push_back(output_.arena().size());
+            write_string(name);
+            keys_.push_back(output_.arena().size());
+        }
+        else
+        {
+            write_string(name);
+        }
         return true;
     }
 
+    // Writes the initial byte and length of an array (0x80) or map (0xa0)
+    template <class Container>
+    static void write_header(uint8_t initial_byte, uint64_t length, Container& c)
+    {
+        if (length <= 0x17)
+        {
+            jsoncons::detail::to_big_endian(static_cast<uint8_t>(initial_byte + length), 
+                                  std::back_inserter(c));
+        } 
+        else if (length <= 0xff)
+        {
+            jsoncons::detail::to_big_endian(static_cast<uint8_t>(initial_byte + 0x18), 
+                                  std::back_inserter(c));
+            jsoncons::detail::to_big_endian(static_cast<uint8_t>(length), 
+                                  std::back_inserter(c));
+        } 
+        else if (length <= 0xffff)
+        {
+            jsoncons::detail::to_big_endian(static_cast<uint8_t>(initial_byte + 0x19), 
+                                  std::back_inserter(c));
+            jsoncons::detail::to_big_endian(static_cast<uint16_t>(length), 
+                                  std::back_inserter(c));
+        } 
+        else if (length <= 0xffffffff)
+        {
+            jsoncons::detail::to_big_endian(static_cast<uint8_t>(initial_byte + 0x1a), 
+                                  std::back_inserter(c));
+            jsoncons::detail::to_big_endian(static_cast<uint32_t>(length), 
+                                  std::back_inserter(c));
+        } 
+        else
+        {
+            jsoncons::detail::to_big_endian(static_cast<uint8_t>(initial_byte + 0x1b), 
+                                  std::back_inserter(c));
+            jsoncons::detail::to_big_endian(static_cast<uint64_t>(length), 
+                                  std::back_inserter(c));
+        }
+    }
+
+    // In canonical mode, writes the header of an array or map that was 
+    // begun without a length in front of its items
+    void insert_header(uint8_t initial_byte, const stack_item& item)
+    {
+        scratch_.clear();
+        write_header(initial_byte, item.count(), scratch_);
+        output_.arena().insert(output_.arena().begin() + item.offset_, scratch_.begin(), scratch_.end());
+    }
+
+    // In canonical mode, puts the items of the map that ends at the end of 
+    // the arena in the bytewise lexicographic order of their encoded keys 
+    // (RFC 8949 section 4.2.1), by moving their encoded bytes. Maps that are 
+    // already in order are left in place.
+    void sort_map_items(const stack_item& item)
+    {
+        const size_t first = item.first_key_;
+        const size_t n = (keys_.size() - first)/2;
+        const uint8_t* data = output_.arena().data();
+        auto key_less = [&](size_t a, size_t b)
+        {
+            return std::lexicographical_compare(data + keys_[first+2*a], data + keys_[first+2*a+1],
+                                                data + keys_[first+2*b], data + keys_[first+2*b+1]);
+        };
+
+        bool sorted = true;
+        for (size_t i = 1; sorted && i < n; ++i)
+        {
+            sorted = !key_less(i, i-1);
+        }
+        if (sorted)
+        {
+            return;
+        }
+
+        order_.resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            order_[i] = i;
+        }
+        if (n <= 16)
+        {
+            // Insertion sort, which is stable and does not allocate
+            for (size_t i = 1; i < n; ++i)
+            {
+                size_t x = order_[i];
+                size_t j = i;
+                for (; j > 0 && key_less(x, order_[j-1]); --j)
+                {
+                    order_[j] = order_[j-1];
+                }
+                order_[j] = x;
+            }
+        }
+        else
+        {
+            std::stable_sort(order_.begin(), order_.end(), key_less);
+        }
+
+        scratch_.clear();
+        for (size_t i : order_)
+        {
+            size_t start = keys_[first+2*i];
+            size_t end = i+1 < n ? keys_[first+2*(i+1)] : output_.arena().size();
+            scratch_.insert(scratch_.end(), data + start, data + end);
+        }
+        std::memcpy(output_.arena().data() + keys_[first], scratch_.data(), scratch_.size());
+    }
+
     bool do_null_value(semantic_tag_type tag, const serializing_context&) override
     {
         if (tag == semantic_tag_type::undefined)
         {
-            result_.push_back(0xf7);
+            output_.push_back(0xf7);
         }
         else
         {
-            result_.push_back(0xf6);
+            output_.push_back(0xf6);
         }
 
         end_value();
         return true;
     }
 
-    void write_string(const string_view_type& sv)
+    // Opens a stringref namespace (tag 256) around a top level array or map
+    void begin_stringref_namespace()
+    {
+        if (stack_.empty() && options_.pack_strings() && !options_.canonical())
+        {
+            output_.push_back(0xd9);
+            output_.push_back(0x01);
+            output_.push_back(0x00);
+            stringref_namespace_ = true;
+            text_stringrefs_.clear();
+            byte_stringrefs_.clear();
+            next_stringref_ = 0;
+        }
+    }
+
+    // Writes a stringref (tag 25) in place of a string that is in the 
+    // current stringref namespace and returns true, or else adds the string 
+    // to the namespace if it is long enough. Strings that cannot be replaced 
+    // by a stringref, because they are part of another tagged item, are 
+    // still added, so that the indexes agree with those of a decoder.
+    bool write_stringref(std::unordered_map<std::string,size_t>& stringrefs, 
+                         const uint8_t* data, size_t length, 
+                         bool allow_stringref)
+    {
+        if (!stringref_namespace_)
+        {
+            return false;
+        }
+        std::string key(data, data + length);
+        if (allow_stringref)
+        {
+            auto it = stringrefs.find(key);
+            if (it != stringrefs.end())
+            {
+                output_.push_back(0xd8);
+                output_.push_back(0x19);
+                write_uint64_value(it->second);
+                return true;
+            }
+        }
+        if (length >= jsoncons::cbor::detail::min_length_for_stringref(next_stringref_))
+        {
+            stringrefs.emplace(std::move(key), next_stringref_);
+            ++next_stringref_;
+        }
+        return false;
+    }
+
+    void write_string(const string_view_type& sv, bool allow_stringref = true)
+    {
+        write_string(sv, allow_stringref, std::is_same<CharT,char>());
+    }
+
+    // UTF-8 text is validated and written as is
+    void write_string(const string_view_type& sv, bool allow_stringref, std::true_type)
+    {
+        auto result = unicons::validate(sv.begin(), sv.end());
+        if (result.ec != unicons::conv_errc())
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Illegal unicode"));
+        }
+        write_text_string(reinterpret_cast<const uint8_t*>(sv.data()), sv.length(), allow_stringref);
+    }
+
+    void write_string(const string_view_type& sv, bool allow_stringref, std::false_type)
     {
         std::vector<uint8_t> target;
         auto result = unicons::convert(
@@ -279,47 +564,52 @@ private:
         {
             JSONCONS_THROW(json_exception_impl<std::runtime_error>("Illegal unicode"));
         }
+        write_text_string(target.data(), target.size(), allow_stringref);
+    }
+
+    void write_text_string(const uint8_t* data, size_t length, bool allow_stringref)
+    {
+        if (write_stringref(text_stringrefs_, data, length, allow_stringref))
+        {
+            return;
+        }
 
-        const size_t length = target.size();
         if (length <= 0x17)
         {
             // fixstr stores a byte array whose length is upto 31 bytes
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x60 + length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
         else if (length <= 0xff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x78), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
         else if (length <= 0xffff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x79), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint16_t>(length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
         else if (length <= 0xffffffff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x7a), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint32_t>(length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
         else if (length <= 0xffffffffffffffff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x7b), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint64_t>(length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
 
-        for (auto c : target)
-        {
-            result_.push_back(c);
-        }
+        output_.insert(data, length);
     }
 
     void write_bignum(const string_view_type& sv)
@@ -329,54 +619,55 @@ private:
         std::vector<uint8_t> data;
         n.dump(signum, data);
         size_t length = data.size();
+        write_stringref(byte_stringrefs_, data.data(), length, false);
 
         if (signum == -1)
         {
-            result_.push_back(0xc3);
+            output_.push_back(0xc3);
         }
         else
         {
-            result_.push_back(0xc2);
+            output_.push_back(0xc2);
         }
 
         if (length <= 0x17)
         {
             // fixstr stores a byte array whose length is upto 31 bytes
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x40 + length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
         else if (length <= 0xff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x58), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
         else if (length <= 0xffff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x59), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint16_t>(length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
         else if (length <= 0xffffffff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x5a), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint32_t>(length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
         else if (length <= 0xffffffffffffffff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x5b), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint64_t>(length), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
 
         for (auto c : data)
         {
-            result_.push_back(c);
+            output_.push_back(c);
         }
     }
 
@@ -474,8 +765,8 @@ private:
             }
         }
 
-        result_.push_back(0xc4);
-        do_begin_array((size_t)2, semantic_tag_type::none, context);
+        output_.push_back(0xc4);
+        do_begin_array((size_t)2, semantic_tag_type::big_decimal, context);
         if (exponent.length() > 0)
         {
             auto result = jsoncons::detail::to_integer<int64_t>(exponent.data(), exponent.length());
@@ -517,8 +808,8 @@ private:
             }
             case semantic_tag_type::date_time:
             {
-                result_.push_back(0xc0);
-                write_string(sv);
+                output_.push_back(0xc0);
+                write_string(sv, false);
                 end_value();
                 break;
             }
@@ -540,55 +831,154 @@ private:
         switch (encoding_hint)
         {
             case byte_string_chars_format::base64url:
-                result_.push_back(0xd5);
+                output_.push_back(0xd5);
                 break;
             case byte_string_chars_format::base64:
-                result_.push_back(0xd6);
+                output_.push_back(0xd6);
                 break;
             case byte_string_chars_format::base16:
-                result_.push_back(0xd7);
+                output_.push_back(0xd7);
                 break;
             default:
                 break;
         }
-        if (b.length() <= 0x17)
+        if (write_stringref(byte_stringrefs_, b.data(), b.length(), encoding_hint == byte_string_chars_format::none))
+        {
+            end_value();
+            return true;
+        }
+        write_byte_string_length(b.length());
+        output_.insert(b.data(), b.length());
+
+        end_value();
+        return true;
+    }
+
+    void write_byte_string_length(size_t length)
+    {
+        if (length <= 0x17)
         {
             // fixstr stores a byte array whose length is upto 31 bytes
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x40 + b.length()), 
-                                  std::back_inserter(result_));
+            jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x40 + length), 
+                                  std::back_inserter(output_));
         }
-        else if (b.length() <= 0xff)
+        else if (length <= 0xff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x58), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint8_t>(b.length()), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
+            jsoncons::detail::to_big_endian(static_cast<uint8_t>(length), 
+                                  std::back_inserter(output_));
         }
-        else if (b.length() <= 0xffff)
+        else if (length <= 0xffff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x59), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint16_t>(b.length()), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
+            jsoncons::detail::to_big_endian(static_cast<uint16_t>(length), 
+                                  std::back_inserter(output_));
         }
-        else if (b.length() <= 0xffffffff)
+        else if (length <= 0xffffffff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x5a), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint32_t>(b.length()), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
+            jsoncons::detail::to_big_endian(static_cast<uint32_t>(length), 
+                                  std::back_inserter(output_));
         }
-        else if (b.length() <= 0xffffffffffffffff)
+        else if (length <= 0xffffffffffffffff)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x5b), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(static_cast<uint64_t>(b.length()), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
+            jsoncons::detail::to_big_endian(static_cast<uint64_t>(length), 
+                                  std::back_inserter(output_));
         }
+    }
+
+    // Typed arrays (RFC 8746) are written in the byte order of the host, 
+    // as a tag followed by a byte string that holds the elements
+
+    bool do_typed_array(const uint8_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x40);
+    }
 
-        for (auto c : b)
+    bool do_typed_array(const uint16_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x41);
+    }
+
+    bool do_typed_array(const uint32_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x42);
+    }
+
+    bool do_typed_array(const uint64_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x43);
+    }
+
+    bool do_typed_array(const int8_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x48);
+    }
+
+    bool do_typed_array(const int16_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x49);
+    }
+
+    bool do_typed_array(const int32_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x4a);
+    }
+
+    bool do_typed_array(const int64_t* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x4b);
+    }
+
+    bool do_typed_array(const float* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x51);
+    }
+
+    bool do_typed_array(const double* data, size_t size, semantic_tag_type, const serializing_context&) override
+    {
+        return write_typed_array(data, size, 0x52);
+    }
+
+    // big_endian_tag is the tag of the big endian typed array, the tag of 
+    // the little endian array with elements of more than one byte is 4 more.
+    // In canonical mode typed arrays are always big endian, so that the 
+    // encoding does not depend on the host.
+    template <class T>
+    bool write_typed_array(const T* data, size_t size, uint8_t big_endian_tag)
+    {
+        const bool swap = sizeof(T) > 1 && options_.canonical() && 
+                          jsoncons::detail::endian::native == jsoncons::detail::endian::little;
+        uint8_t tag = big_endian_tag;
+        if (sizeof(T) > 1 && !options_.canonical() && jsoncons::detail::endian::native == jsoncons::detail::endian::little)
         {
-            result_.push_back(c);
+            tag += 4;
+        }
+        output_.push_back(0xd8);
+        output_.push_back(tag);
+
+        const size_t length = size*sizeof(T);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+        write_stringref(byte_stringrefs_, bytes, length, false);
+        write_byte_string_length(length);
+        if (swap)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                T x = jsoncons::detail::byte_swap(data[i]);
+                uint8_t buf[sizeof(T)];
+                std::memcpy(buf, &x, sizeof(T));
+                output_.insert(buf, sizeof(T));
+            }
+        }
+        else
+        {
+            output_.insert(bytes, length);
         }
 
         end_value();
@@ -602,21 +992,27 @@ private:
     {
         if (tag == semantic_tag_type::timestamp)
         {
-            result_.push_back(0xc1);
+            output_.push_back(0xc1);
+        }
+
+        if (options_.canonical() && write_half(val))
+        {
+            end_value();
+            return true;
         }
 
         float valf = (float)val;
         if ((double)valf == val)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0xfa), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(valf, std::back_inserter(result_));
+                                  std::back_inserter(output_));
+            jsoncons::detail::to_big_endian(valf, std::back_inserter(output_));
         }
         else
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0xfb), 
-                                  std::back_inserter(result_));
-            jsoncons::detail::to_big_endian(val, std::back_inserter(result_));
+                                  std::back_inserter(output_));
+            jsoncons::detail::to_big_endian(val, std::back_inserter(output_));
         }
 
         // write double
@@ -625,48 +1021,70 @@ private:
         return true;
     }
 
+    // In canonical mode, a double that is a NaN or that a half precision 
+    // float holds exactly is written as a half precision float
+    bool write_half(double val)
+    {
+        uint16_t half;
+        if (std::isnan(val))
+        {
+            half = 0x7e00;
+        }
+        else
+        {
+            half = jsoncons::detail::encode_half(val);
+            if (jsoncons::detail::decode_half(half) != val)
+            {
+                return false;
+            }
+        }
+        output_.push_back(0xf9);
+        jsoncons::detail::to_big_endian(half, std::back_inserter(output_));
+        return true;
+    }
+
     bool do_int64_value(int64_t value, 
                         semantic_tag_type tag, 
                         const serializing_context&) override
     {
         if (tag == semantic_tag_type::timestamp)
         {
-            result_.push_back(0xc1);
+            output_.push_back(0xc1);
         }
         if (value >= 0)
         {
             if (value <= 0x17)
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             } 
             else if (value <= (std::numeric_limits<uint8_t>::max)())
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x18), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             } 
             else if (value <= (std::numeric_limits<uint16_t>::max)())
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x19), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
                 jsoncons::detail::to_big_endian(static_cast<uint16_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             } 
             else if (value <= (std::numeric_limits<uint32_t>::max)())
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x1a), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
                 jsoncons::detail::to_big_endian(static_cast<uint32_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             } 
             else if (value <= (std::numeric_limits<int64_t>::max)())
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x1b), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
                 jsoncons::detail::to_big_endian(static_cast<int64_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             }
         } else
         {
@@ -674,35 +1092,35 @@ private:
             if (value >= -24)
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x20 + posnum), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             } 
             else if (posnum <= (std::numeric_limits<uint8_t>::max)())
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x38), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(posnum), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             } 
             else if (posnum <= (std::numeric_limits<uint16_t>::max)())
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x39), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
                 jsoncons::detail::to_big_endian(static_cast<uint16_t>(posnum), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             } 
             else if (posnum <= (std::numeric_limits<uint32_t>::max)())
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x3a), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
                 jsoncons::detail::to_big_endian(static_cast<uint32_t>(posnum), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             } 
             else if (posnum <= (std::numeric_limits<int64_t>::max)())
             {
                 jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x3b), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
                 jsoncons::detail::to_big_endian(static_cast<int64_t>(posnum), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             }
         }
         end_value();
@@ -715,55 +1133,59 @@ private:
     {
         if (tag == semantic_tag_type::timestamp)
         {
-            result_.push_back(0xc1);
+            output_.push_back(0xc1);
         }
+        write_uint64_value(value);
+        end_value();
+        return true;
+    }
 
+    void write_uint64_value(uint64_t value)
+    {
         if (value <= 0x17)
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         } 
         else if (value <=(std::numeric_limits<uint8_t>::max)())
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x18), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         } 
         else if (value <=(std::numeric_limits<uint16_t>::max)())
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x19), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint16_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         } 
         else if (value <=(std::numeric_limits<uint32_t>::max)())
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x1a), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint32_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         } 
         else if (value <=(std::numeric_limits<uint64_t>::max)())
         {
             jsoncons::detail::to_big_endian(static_cast<uint8_t>(0x1b), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
             jsoncons::detail::to_big_endian(static_cast<uint64_t>(value), 
-                                  std::back_inserter(result_));
+                                  std::back_inserter(output_));
         }
-        end_value();
-        return true;
     }
 
     bool do_bool_value(bool value, semantic_tag_type, const serializing_context&) override
     {
         if (value)
         {
-            result_.push_back(0xf5);
+            output_.push_back(0xf5);
         }
         else
         {
-            result_.push_back(0xf4);
+            output_.push_back(0xf4);
         }
 
         end_value();
@@ -776,6 +1198,11 @@ private:
         {
             ++stack_.back().count_;
         }
+        else if (options_.canonical())
+        {
+            // The top level data item is complete
+            output_.commit();
+        }
     }
 };
 
@@ -9,7 +9,7 @@
 
 #include <string>
 #include <vector>
-#include <memory> // std::allocator
+#include <memory> // std::allocator, std::shared_ptr
 #include <limits> // std::numeric_limits
 #include <iterator>
 #include <type_traits> // std::enable_if
@@ -28,6 +28,8 @@ class cbor_view
     const uint8_t* first_;
     const uint8_t* last_; 
     const uint8_t* base_relative_; 
+    std::shared_ptr<const jsoncons::cbor::detail::cbor_view_index> index_;
+    const jsoncons::cbor::detail::cbor_view_index::node* node_;
 public:
     typedef cbor_view array;
     typedef std::allocator<char> allocator_type;
@@ -56,6 +58,10 @@ public:
         {
             JSONCONS_THROW(json_exception_impl<std::invalid_argument>("Not an object"));
         }
+        if (major_type() == cbor_major_type::semantic_tag)
+        {
+            return tagged_content().object_range();
+        }
         std::error_code ec{};
         if (major_type() == cbor_major_type::map)
         {
@@ -96,6 +102,10 @@ public:
         {
             JSONCONS_THROW(json_exception_impl<std::invalid_argument>("Not an array"));
         }
+        if (major_type() == cbor_major_type::semantic_tag)
+        {
+            return tagged_content().array_range();
+        }
 
         std::error_code ec{};
         const uint8_t* begin = first_ + 1;
@@ -125,30 +135,53 @@ public:
     }
 
     cbor_view()
-        : first_(nullptr), last_(nullptr), base_relative_(nullptr)
+        : first_(nullptr), last_(nullptr), base_relative_(nullptr), node_(nullptr)
     {
     }
 
     cbor_view(const uint8_t* data, size_t length)
-        : first_(data), last_(data+length), base_relative_(data)
+        : first_(data), last_(data+length), base_relative_(data), node_(nullptr)
     {
     }
 
     cbor_view(const uint8_t* data, size_t length, const uint8_t* base_relative)
-        : first_(data), last_(data+length), base_relative_(base_relative)
+        : first_(data), last_(data+length), base_relative_(base_relative), node_(nullptr)
     {
     }
 
     cbor_view(const std::vector<uint8_t>& v)
-        : first_(v.data()), last_(v.data()+v.size()), base_relative_(v.data())
+        : first_(v.data()), last_(v.data()+v.size()), base_relative_(v.data()), node_(nullptr)
     {
     }
 
     cbor_view(const cbor_view& other)
-        : first_(other.first_), last_(other.last_), base_relative_(other.base_relative_)
+        : first_(other.first_), last_(other.last_), base_relative_(other.base_relative_),
+          index_(other.index_), node_(other.node_)
     {
     }
 
+    // Returns a view of the same value, with an index of the offsets of the 
+    // items in its arrays and maps, and of the keys of its larger maps, so that 
+    // at, operator[] and contains on it, and on the views they return, take 
+    // constant time. The index is built in one pass over the value, and is 
+    // shared by copies of the view.
+    cbor_view indexed() const
+    {
+        cbor_view v(*this);
+        if (first_ != last_)
+        {
+            auto index = std::make_shared<jsoncons::cbor::detail::cbor_view_index>(first_, last_ - first_, base_relative_);
+            v.node_ = index->root();
+            v.index_ = std::move(index);
+        }
+        return v;
+    }
+
+    bool is_indexed() const
+    {
+        return node_ != nullptr;
+    }
+
     cbor_view& operator=(const cbor_view&) = default;
 
     friend bool operator==(const cbor_view& lhs, const cbor_view& rhs) 
@@ -231,7 +264,7 @@ public:
                 }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_null();
             }
             default:
@@ -247,7 +280,7 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_array();
             }
             default:
@@ -263,7 +296,7 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_object();
             }
             default:
@@ -279,7 +312,7 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_string();
             }
             default:
@@ -295,7 +328,7 @@ public:
                 return additional_information_value() != additional_info::indefinite_length;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_string_view();
             }
             default:
@@ -311,7 +344,7 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_byte_string();
             }
             default:
@@ -327,7 +360,7 @@ public:
                 return additional_information_value() != additional_info::indefinite_length;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_byte_string();
             }
             default:
@@ -356,7 +389,7 @@ public:
                 }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_bool();
             }
             default:
@@ -380,7 +413,7 @@ public:
                 }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_double();
             }
             default:
@@ -415,7 +448,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_int64();
             }
             default:
@@ -431,7 +464,7 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.is_uint64();
             }
             default:
@@ -454,7 +487,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.size();
             }
             default:
@@ -479,6 +512,15 @@ public:
     {
         JSONCONS_ASSERT(is_array());
 
+        if (node_ != nullptr)
+        {
+            if (index >= node_->size())
+            {
+                JSONCONS_THROW(json_exception_impl<std::out_of_range>("Invalid array subscript"));
+            }
+            return indexed_item(index, index);
+        }
+
         auto range = array_range();
         size_t i = 0;
         auto it = range.begin();
@@ -496,6 +538,16 @@ public:
     {
         JSONCONS_ASSERT(is_object());
 
+        if (node_ != nullptr)
+        {
+            size_t i = index_->find(*node_, key);
+            if (i == node_->size())
+            {
+                JSONCONS_THROW(json_exception_impl<std::out_of_range>("Key not found"));
+            }
+            return indexed_item(2*i+1, i);
+        }
+
         auto range = object_range();
         auto it = range.begin();
         for (; it != range.end(); ++it)
@@ -514,6 +566,10 @@ public:
         {
             return false;
         }
+        if (node_ != nullptr)
+        {
+            return index_->find(*node_, key) != node_->size();
+        }
         auto range = object_range();
         auto it = range.begin();
         for (; it != range.end(); ++it)
@@ -563,7 +619,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_-(first_+1));
+                cbor_view v = tagged_content();
                 return v.as_integer<T>();
             }
             default:
@@ -591,7 +647,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_-(first_+1));
+                cbor_view v = tagged_content();
                 return v.as_integer<T>();
             }
             default:
@@ -615,7 +671,7 @@ public:
                 }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_content();
                 return v.as_bool();
             }
             default:
@@ -673,7 +729,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_-(first_+1));
+                cbor_view v = tagged_content();
                 return v.as_double();
             }
             default:
@@ -794,7 +850,7 @@ public:
                         return s;
                     }
                     default:
-                        cbor_view v(first_ + 1, last_ - (first_ + 1));
+                        cbor_view v = tagged_content();
                         return v.as_string();
                 }
                 break;
@@ -826,7 +882,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_-(first_+1));
+                cbor_view v = tagged_content();
                 return v.as_byte_string<BAllocator>();
             }
             default:
@@ -1007,6 +1063,16 @@ public:
             }
             case cbor_major_type::array:
             {
+                if (node_ != nullptr)
+                {
+                    handler.begin_array(node_->size());
+                    for (size_t i = 0; i < node_->size(); ++i)
+                    {
+                        indexed_item(i, i).dump(handler);
+                    }
+                    handler.end_array();
+                    break;
+                }
                 auto range = array_range();
                 handler.begin_array(size());
                 for (const auto& item : range)
@@ -1018,6 +1084,19 @@ public:
             }
             case cbor_major_type::map:
             {
+                if (node_ != nullptr)
+                {
+                    handler.begin_object(node_->size());
+                    for (size_t i = 0; i < node_->size(); ++i)
+                    {
+                        cbor_view key(node_->items[2*i], node_->items[2*i+1] - node_->items[2*i], base_relative_);
+                        key.index_ = index_;
+                        handler.name(key.as_string());
+                        indexed_item(2*i+1, i).dump(handler);
+                    }
+                    handler.end_object();
+                    break;
+                }
                 auto range = object_range();
                 handler.begin_object(size());
                 for (const auto& kv : range)
@@ -1067,7 +1146,31 @@ public:
                         break;
                     }
                     default:
+                    {
+                        jsoncons::buffer_source source(buffer(),buflen());
+                        std::error_code ec{};
+                        uint64_t tag_value = jsoncons::cbor::detail::get_uint64_value(source, ec);
+                        if (!ec && tag_value == 256 && !index_)
+                        {
+                            // The stringrefs in a namespace are resolved through an index
+                            indexed().dump(handler);
+                            break;
+                        }
+                        cbor_view content = tagged_content();
+                        if (!ec && jsoncons::cbor::detail::is_typed_array_tag(tag_value) && content.major_type() == cbor_major_type::byte_string)
+                        {
+                            auto bytes = content.as_byte_string();
+                            jsoncons::buffer_source bytes_source(bytes.data(), bytes.size());
+                            jsoncons::cbor::detail::read_typed_array(bytes_source, tag_value, bytes.size(), handler, null_serializing_context(), ec);
+                            if (ec)
+                            {
+                                throw serialization_error(ec,bytes_source.position());
+                            }
+                            break;
+                        }
+                        content.dump(handler);
                         break;
+                    }
                 }
                 break;
             }
@@ -1106,6 +1209,57 @@ public:
         bv.dump(os);
         return os;
     }
+private:
+    // Returns a view of the item at position pos of the index node, with the
+    // node of the element or member value at position i if it has one
+    cbor_view indexed_item(size_t pos, size_t i) const
+    {
+        const uint8_t* first = node_->items[pos];
+        cbor_view v(first, node_->items[pos+1] - first, base_relative_);
+        v.node_ = index_->nested(*node_, i);
+        v.index_ = index_;
+        return v;
+    }
+
+    // Returns a view of the item that the tag at the beginning of this view 
+    // applies to, or for a stringref, of the string that it refers to
+    cbor_view tagged_content() const
+    {
+        std::error_code ec{};
+        jsoncons::buffer_source source(buffer(),buflen());
+        uint64_t tag = jsoncons::cbor::detail::get_uint64_value(source, ec);
+        if (ec)
+        {
+            throw serialization_error(ec,source.position());
+        }
+        if (tag == 25)
+        {
+            const uint8_t* first = nullptr;
+            const uint8_t* last = nullptr;
+            if (index_)
+            {
+                index_->resolve(first_, first, last, ec);
+            }
+            else
+            {
+                jsoncons::cbor::detail::stringref_resolver resolver(first_, last_);
+                resolver.resolve(base_relative_, first, last, ec);
+            }
+            if (ec)
+            {
+                throw serialization_error(ec,first_ - base_relative_ + 1);
+            }
+            cbor_view v(first, last - first, base_relative_);
+            v.index_ = index_;
+            return v;
+        }
+        const uint8_t* first = first_ + source.position() - 1;
+        cbor_view v(first, last_ - first, base_relative_);
+        v.index_ = index_;
+        v.node_ = node_;
+        return v;
+    }
+public:
 #if !defined(JSONCONS_NO_DEPRECATED)
 
     bool has_key(const string_view_type& key) const
@@ -9,6 +9,7 @@
 
 #include <jsoncons_ext/csv/csv_options.hpp>
 #include <jsoncons_ext/csv/csv_reader.hpp>
+#include <jsoncons_ext/csv/csv_staj_reader.hpp>
 #include <jsoncons_ext/csv/csv_serializer.hpp>
 
 #endif
@@ -157,6 +157,11 @@ public:
         return input_ptr_ == input_end_;
     }
 
+    void restart()
+    {
+        continue_ = true;
+    }
+
     const std::vector<std::basic_string<CharT>>& column_labels() const
     {
         return column_names_;
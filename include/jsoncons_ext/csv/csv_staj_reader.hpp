@@ -0,0 +1,499 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CSV_CSV_STAJ_READER_HPP
+#define JSONCONS_CSV_CSV_STAJ_READER_HPP
+
+#include <string>
+#include <vector>
+#include <memory> // std::allocator
+#include <utility> // std::move
+#include <system_error>
+#include <jsoncons/source.hpp>
+#include <jsoncons/json_exception.hpp>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons/parse_error_handler.hpp>
+#include <jsoncons/staj_reader.hpp>
+#include <jsoncons_ext/csv/csv_error.hpp>
+#include <jsoncons_ext/csv/csv_options.hpp>
+#include <jsoncons_ext/csv/csv_parser.hpp>
+
+namespace jsoncons { namespace csv {
+
+// Content handler that holds the events produced by the csv parser until
+// they are pulled by basic_csv_staj_reader. It asks the parser to stop after
+// every event, so the parser advances at most one character at a time and
+// only the few events produced by that character are held.
+template<class CharT,class Allocator=std::allocator<char>>
+class basic_csv_staj_event_queue final : public basic_json_content_handler<CharT>
+{
+public:
+    using typename basic_json_content_handler<CharT>::string_view_type;
+    typedef typename std::allocator_traits<Allocator>:: template rebind_alloc<CharT> char_allocator_type;
+    typedef std::basic_string<CharT,std::char_traits<CharT>,char_allocator_type> string_type;
+
+    struct item
+    {
+        staj_event_type event_type;
+        semantic_tag_type tag;
+        union
+        {
+            bool bool_value;
+            int64_t int64_value;
+            uint64_t uint64_value;
+            double double_value;
+        };
+        floating_point_options fmt;
+        string_type s;
+
+        item()
+            : event_type(staj_event_type::null_value), tag(semantic_tag_type::none), uint64_value(0)
+        {
+        }
+
+        basic_staj_event<CharT> event() const
+        {
+            switch (event_type)
+            {
+                case staj_event_type::name:
+                case staj_event_type::string_value:
+                    return basic_staj_event<CharT>(s.data(), s.length(), event_type, tag);
+                case staj_event_type::bool_value:
+                    return basic_staj_event<CharT>(bool_value);
+                case staj_event_type::int64_value:
+                    return basic_staj_event<CharT>(int64_value, tag);
+                case staj_event_type::uint64_value:
+                    return basic_staj_event<CharT>(uint64_value, tag);
+                case staj_event_type::double_value:
+                    return basic_staj_event<CharT>(double_value, fmt, tag);
+                default:
+                    return basic_staj_event<CharT>(event_type, tag);
+            }
+        }
+    };
+private:
+    typedef typename std::allocator_traits<Allocator>:: template rebind_alloc<item> item_allocator_type;
+
+    std::vector<item,item_allocator_type> items_;
+    size_t head_;
+    size_t tail_;
+public:
+    basic_csv_staj_event_queue()
+        : head_(0), tail_(0)
+    {
+    }
+
+    bool empty() const
+    {
+        return head_ == tail_;
+    }
+
+    // Swaps the oldest held event into val, the string capacity
+    // of both is kept for reuse
+    void pop(item& val)
+    {
+        JSONCONS_ASSERT(head_ < tail_);
+        std::swap(val, items_[head_]);
+        ++head_;
+        if (head_ == tail_)
+        {
+            head_ = 0;
+            tail_ = 0;
+        }
+    }
+
+private:
+    item& push(staj_event_type event_type, semantic_tag_type tag)
+    {
+        if (tail_ == items_.size())
+        {
+            items_.emplace_back();
+        }
+        item& val = items_[tail_++];
+        val.event_type = event_type;
+        val.tag = tag;
+        return val;
+    }
+
+    bool do_begin_object(semantic_tag_type tag, const serializing_context&) override
+    {
+        push(staj_event_type::begin_object, tag);
+        return false;
+    }
+
+    bool do_end_object(const serializing_context&) override
+    {
+        push(staj_event_type::end_object, semantic_tag_type::none);
+        return false;
+    }
+
+    bool do_begin_array(semantic_tag_type tag, const serializing_context&) override
+    {
+        push(staj_event_type::begin_array, tag);
+        return false;
+    }
+
+    bool do_end_array(const serializing_context&) override
+    {
+        push(staj_event_type::end_array, semantic_tag_type::none);
+        return false;
+    }
+
+    bool do_name(const string_view_type& name, const serializing_context&) override
+    {
+        item& val = push(staj_event_type::name, semantic_tag_type::none);
+        val.s.assign(name.data(), name.length());
+        return false;
+    }
+
+    bool do_null_value(semantic_tag_type tag, const serializing_context&) override
+    {
+        push(staj_event_type::null_value, tag);
+        return false;
+    }
+
+    bool do_bool_value(bool value, semantic_tag_type tag, const serializing_context&) override
+    {
+        push(staj_event_type::bool_value, tag).bool_value = value;
+        return false;
+    }
+
+    bool do_string_value(const string_view_type& s, semantic_tag_type tag, const serializing_context&) override
+    {
+        item& val = push(staj_event_type::string_value, tag);
+        val.s.assign(s.data(), s.length());
+        return false;
+    }
+
+    bool do_byte_string_value(const byte_string_view&,
+                              byte_string_chars_format,
+                              semantic_tag_type,
+                              const serializing_context&) override
+    {
+        JSONCONS_UNREACHABLE();
+    }
+
+    bool do_int64_value(int64_t value,
+                        semantic_tag_type tag,
+                        const serializing_context&) override
+    {
+        push(staj_event_type::int64_value, tag).int64_value = value;
+        return false;
+    }
+
+    bool do_uint64_value(uint64_t value,
+                         semantic_tag_type tag,
+                         const serializing_context&) override
+    {
+        push(staj_event_type::uint64_value, tag).uint64_value = value;
+        return false;
+    }
+
+    bool do_double_value(double value,
+                         const floating_point_options& fmt,
+                         semantic_tag_type tag,
+                         const serializing_context&) override
+    {
+        item& val = push(staj_event_type::double_value, tag);
+        val.double_value = value;
+        val.fmt = fmt;
+        return false;
+    }
+
+    void do_flush() override
+    {
+    }
+};
+
+template<class CharT,class Source=jsoncons::text_stream_source<CharT>,class Allocator=std::allocator<char>>
+class basic_csv_staj_reader : public basic_staj_reader<CharT>, private virtual serializing_context
+{
+    typedef CharT char_type;
+    typedef Allocator allocator_type;
+    typedef typename std::allocator_traits<allocator_type>:: template rebind_alloc<CharT> char_allocator_type;
+    typedef typename basic_csv_staj_event_queue<CharT,Allocator>::item item_type;
+
+    static const size_t default_max_buffer_length = 16384;
+
+    default_parse_error_handler default_err_handler_;
+    default_basic_staj_filter<CharT> default_filter_;
+    basic_staj_filter<CharT>& filter_;
+
+    basic_csv_staj_event_queue<CharT,Allocator> queue_;
+    basic_csv_parser<CharT,Allocator> parser_;
+    Source source_;
+    std::vector<CharT,char_allocator_type> buffer_;
+    size_t buffer_length_;
+    bool eof_;
+    bool done_;
+    item_type current_item_;
+    basic_staj_event<CharT> event_;
+
+    // Noncopyable and nonmoveable
+    basic_csv_staj_reader(const basic_csv_staj_reader&) = delete;
+    basic_csv_staj_reader& operator=(const basic_csv_staj_reader&) = delete;
+public:
+
+    // Constructors that throw parse exceptions
+
+    basic_csv_staj_reader(Source source)
+        : basic_csv_staj_reader(std::move(source), default_filter_, basic_csv_options<CharT>(), default_err_handler_)
+    {
+    }
+
+    basic_csv_staj_reader(Source source,
+                          const basic_csv_options<CharT>& options)
+        : basic_csv_staj_reader(std::move(source), default_filter_, options, default_err_handler_)
+    {
+    }
+
+    basic_csv_staj_reader(Source source,
+                          basic_staj_filter<CharT>& filter,
+                          const basic_csv_options<CharT>& options)
+        : basic_csv_staj_reader(std::move(source), filter, options, default_err_handler_)
+    {
+    }
+
+    basic_csv_staj_reader(Source source,
+                          basic_staj_filter<CharT>& filter,
+                          const basic_csv_options<CharT>& options,
+                          parse_error_handler& err_handler)
+       : filter_(filter),
+         parser_(queue_, options, err_handler),
+         source_(std::move(source)),
+         buffer_length_(default_max_buffer_length),
+         eof_(false),
+         done_(false),
+         event_(staj_event_type::null_value)
+    {
+        buffer_.reserve(buffer_length_);
+        parser_.reset();
+        next();
+    }
+
+    // Constructors that set parse error codes
+
+    basic_csv_staj_reader(Source source,
+                          std::error_code& ec)
+        : basic_csv_staj_reader(std::move(source), default_filter_, basic_csv_options<CharT>(), default_err_handler_, ec)
+    {
+    }
+
+    basic_csv_staj_reader(Source source,
+                          const basic_csv_options<CharT>& options,
+                          std::error_code& ec)
+        : basic_csv_staj_reader(std::move(source), default_filter_, options, default_err_handler_, ec)
+    {
+    }
+
+    basic_csv_staj_reader(Source source,
+                          basic_staj_filter<CharT>& filter,
+                          const basic_csv_options<CharT>& options,
+                          std::error_code& ec)
+        : basic_csv_staj_reader(std::move(source), filter, options, default_err_handler_, ec)
+    {
+    }
+
+    basic_csv_staj_reader(Source source,
+                          basic_staj_filter<CharT>& filter,
+                          const basic_csv_options<CharT>& options,
+                          parse_error_handler& err_handler,
+                          std::error_code& ec)
+       : filter_(filter),
+         parser_(queue_, options, err_handler),
+         source_(std::move(source)),
+         buffer_length_(default_max_buffer_length),
+         eof_(false),
+         done_(false),
+         event_(staj_event_type::null_value)
+    {
+        buffer_.reserve(buffer_length_);
+        parser_.reset();
+        next(ec);
+    }
+
+    size_t buffer_length() const
+    {
+        return buffer_length_;
+    }
+
+    void buffer_length(size_t length)
+    {
+        buffer_length_ = length;
+        buffer_.reserve(buffer_length_);
+    }
+
+    bool done() const override
+    {
+        return done_;
+    }
+
+    const basic_staj_event<CharT>& current() const override
+    {
+        return event_;
+    }
+
+    void accept(basic_json_content_handler<CharT>& handler) override
+    {
+        std::error_code ec;
+        accept(handler, ec);
+        if (ec)
+        {
+            throw serialization_error(ec,line_number(),column_number());
+        }
+    }
+
+    void accept(basic_json_content_handler<CharT>& handler,
+                std::error_code& ec) override
+    {
+        if (!jsoncons::detail::replay_staj_event(event_, handler, *this))
+        {
+            return;
+        }
+        switch (event_.event_type())
+        {
+            case staj_event_type::begin_array:
+            case staj_event_type::begin_object:
+                break;
+            default:
+                return;
+        }
+        // As with the other readers, the current event remains the
+        // begin event after the container has been sent
+        const basic_staj_event<CharT> begin_event = event_;
+        accept_container(handler, ec);
+        event_ = begin_event;
+    }
+
+    void next() override
+    {
+        std::error_code ec;
+        next(ec);
+        if (ec)
+        {
+            throw serialization_error(ec,line_number(),column_number());
+        }
+    }
+
+    void next(std::error_code& ec) override
+    {
+        do
+        {
+            read_next(ec);
+        }
+        while (!ec && !done() && !filter_.accept(event_, *this));
+    }
+
+    const serializing_context& context() const override
+    {
+        return *this;
+    }
+
+    size_t line_number() const override
+    {
+        return parser_.line_number();
+    }
+
+    size_t column_number() const override
+    {
+        return parser_.column_number();
+    }
+
+    bool eof() const
+    {
+        return eof_;
+    }
+
+private:
+
+    void accept_container(basic_json_content_handler<CharT>& handler,
+                          std::error_code& ec)
+    {
+        size_t level = 1;
+        while (level > 0 && !done())
+        {
+            read_next(ec);
+            if (ec) return;
+            switch (event_.event_type())
+            {
+                case staj_event_type::begin_array:
+                case staj_event_type::begin_object:
+                    ++level;
+                    break;
+                case staj_event_type::end_array:
+                case staj_event_type::end_object:
+                    --level;
+                    break;
+                default:
+                    break;
+            }
+            if (!jsoncons::detail::replay_staj_event(event_, handler, *this))
+            {
+                return;
+            }
+        }
+    }
+
+    void read_next(std::error_code& ec)
+    {
+        if (source_.is_error())
+        {
+            ec = csv_errc::source_error;
+            return;
+        }
+        while (queue_.empty())
+        {
+            if (parser_.stopped() && (eof_ || parser_.done()))
+            {
+                // No more events
+                ec = csv_errc::unexpected_eof;
+                return;
+            }
+            parser_.restart();
+            while (!parser_.stopped())
+            {
+                if (parser_.source_exhausted())
+                {
+                    if (!source_.eof())
+                    {
+                        buffer_.clear();
+                        buffer_.resize(buffer_length_);
+                        size_t count = source_.read(buffer_.data(), buffer_length_);
+                        buffer_.resize(count);
+                        if (buffer_.size() == 0)
+                        {
+                            eof_ = true;
+                        }
+                        parser_.update(buffer_.data(),buffer_.size());
+                    }
+                    else
+                    {
+                        parser_.update(buffer_.data(),0);
+                        eof_ = true;
+                    }
+                }
+                parser_.parse_some(ec);
+                if (ec) return;
+            }
+        }
+        queue_.pop(current_item_);
+        event_ = current_item_.event();
+        if (queue_.empty() && (eof_ || parser_.done()) && parser_.stopped())
+        {
+            done_ = true;
+        }
+    }
+};
+
+typedef basic_csv_staj_reader<char,jsoncons::text_stream_source<char>> csv_staj_reader;
+typedef basic_csv_staj_reader<char,jsoncons::string_source<char>> csv_string_staj_reader;
+typedef basic_csv_staj_reader<wchar_t,jsoncons::text_stream_source<wchar_t>> wcsv_staj_reader;
+typedef basic_csv_staj_reader<wchar_t,jsoncons::string_source<wchar_t>> wcsv_string_staj_reader;
+
+}}
+
+#endif
+
@@ -8,11 +8,13 @@
 #define JSONCONS_JSONPOINTER_JSONPATCH_HPP
 
 #include <string>
-#include <sstream>
 #include <vector>
 #include <memory>
-#include <algorithm> // std::min
+#include <algorithm> // std::min, std::sort
 #include <utility> // std::move
+#include <unordered_map>
+#include <cstring> // std::memcpy
+#include <cmath> // std::floor
 #include <jsoncons/json.hpp>
 #include <jsoncons_ext/jsonpointer/jsonpointer.hpp>
 #include <jsoncons_ext/jsonpatch/jsonpatch_error.hpp>
@@ -55,6 +57,13 @@ private:
     std::error_code error_code_;
 };
 
+// How apply_patch treats a patch with an operation that fails
+enum class apply_mode 
+{
+    atomic,     // the target is restored to its original value
+    best_effort // the failed operation is skipped and the others are applied
+};
+
 namespace detail {
 
     JSONCONS_DEFINE_LITERAL(test_literal,"test")
@@ -76,11 +85,12 @@ namespace detail {
     {
         typedef typename Json::string_type string_type;
         typedef typename Json::string_view_type string_view_type;
+        typedef jsonpointer::basic_json_pointer<typename Json::char_type> pointer_type;
 
         struct entry
         {
             op_type op;
-            string_type path;
+            pointer_type path;
             Json value;
         };
 
@@ -121,7 +131,14 @@ namespace detail {
                     }
                     else if (it->op == op_type::replace)
                     {
-                        jsonpointer::replace(target,it->path,it->value,ec);
+                        if (it->path.empty())
+                        {
+                            target = std::move(it->value);
+                        }
+                        else
+                        {
+                            jsonpointer::replace(target,it->path,it->value,ec);
+                        }
                         if (ec)
                         {
                             //std::cout << "replace: " << it->path << std::endl;
@@ -133,383 +150,1003 @@ namespace detail {
         }
     };
 
+    // Values are moved out of a patch that is not const
     template <class Json>
-    Json from_diff(const Json& source, const Json& target, const typename Json::string_type& path)
+    Json&& patch_value(Json& val)
     {
-        typedef typename Json::char_type char_type;
+        return std::move(val);
+    }
 
-        Json result = typename Json::array();
+    template <class Json>
+    const Json& patch_value(const Json& val)
+    {
+        return val;
+    }
 
-        if (source == target)
+    // Sets parent to the value that contains the value ptr refers to, ptr is not empty
+    template <class Json>
+    bool resolve_parent(Json& target, const jsonpointer::basic_json_pointer<typename Json::char_type>& ptr, Json*& parent)
+    {
+        jsonpointer::detail::handle_type<Json,Json&> current(target);
+        if (jsonpointer::detail::select_tokens(current, ptr.tokens(), ptr.size()-1) != jsonpointer::jsonpointer_errc())
         {
-            return result;
+            return false;
         }
+        parent = std::addressof(current.get());
+        return true;
+    }
 
-        if (source.is_array() && target.is_array())
+    // The pointer to the element at index of the array that contains the value ptr refers to 
+    template <class Json>
+    jsonpointer::basic_json_pointer<typename Json::char_type> 
+    element_pointer(const jsonpointer::basic_json_pointer<typename Json::char_type>& ptr, size_t index)
+    {
+        jsonpointer::basic_json_pointer<typename Json::char_type> result;
+        for (size_t i = 0; i+1 < ptr.size(); ++i)
+        {
+            result /= ptr[i];
+        }
+        result /= index;
+        return result;
+    }
+
+    // The patch operations act on the parent of the target location, which is 
+    // looked up once. If unwinder is not null, an entry that undoes the 
+    // operation is pushed on its stack, otherwise nothing is recorded.
+
+    template <class Json,class T>
+    bool add_value(Json& target, const jsonpointer::basic_json_pointer<typename Json::char_type>& ptr, 
+                   T&& value, operation_unwinder<Json>* unwinder)
+    {
+        if (ptr.empty())
+        {
+            if (unwinder != nullptr)
+            {
+                unwinder->stack.push_back({op_type::replace,ptr,std::move(target)});
+            }
+            target = std::forward<T>(value);
+            return true;
+        }
+        Json* parent = nullptr;
+        if (!resolve_parent(target, ptr, parent))
         {
-            size_t common = (std::min)(source.size(),target.size());
-            for (size_t i = 0; i < common; ++i)
+            return false;
+        }
+        const auto& token = ptr.tokens().back();
+        if (parent->is_array())
+        {
+            size_t index = parent->size();
+            if (!token.after_last)
+            {
+                if (token.index_ec != jsonpointer::jsonpointer_errc() || token.index > parent->size())
+                {
+                    return false;
+                }
+                index = token.index;
+            }
+            if (index == parent->size())
             {
-                std::basic_ostringstream<char_type> ss; 
-                ss << path << '/' << i;
-                auto temp_diff = from_diff(source[i],target[i],ss.str());
-                result.insert(result.array_range().end(),temp_diff.array_range().begin(),temp_diff.array_range().end());
+                parent->push_back(std::forward<T>(value));
             }
-            // Element in source, not in target - remove
-            for (size_t i = target.size(); i < source.size(); ++i)
+            else
             {
-                std::basic_ostringstream<char_type> ss; 
-                ss << path << '/' << i;
-                Json val = typename Json::object();
-                val.insert_or_assign(op_literal<char_type>(), remove_literal<char_type>());
-                val.insert_or_assign(path_literal<char_type>(), ss.str());
-                result.push_back(std::move(val));
+                parent->insert(parent->array_range().begin()+index,std::forward<T>(value));
             }
-            // Element in target, not in source - add, 
-            // Fix contributed by Alexander rog13
-            for (size_t i = source.size(); i < target.size(); ++i)
+            if (unwinder != nullptr)
             {
-                const auto& a = target[i];
-                std::basic_ostringstream<char_type> ss; 
-                ss << path << '/' << i;
-                Json val = typename Json::object();
-                val.insert_or_assign(op_literal<char_type>(), add_literal<char_type>());
-                val.insert_or_assign(path_literal<char_type>(), ss.str());
-                val.insert_or_assign(value_literal<char_type>(), a);
-                result.push_back(std::move(val));
+                unwinder->stack.push_back({op_type::remove,token.after_last ? element_pointer<Json>(ptr,index) : ptr,Json::null()});
             }
         }
-        else if (source.is_object() && target.is_object())
+        else if (parent->is_object())
         {
-            for (const auto& a : source.object_range())
+            auto it = parent->find(token.name);
+            if (it != parent->object_range().end())
             {
-                std::basic_ostringstream<char_type> ss; 
-                ss << path << '/';
-                jsonpointer::escape(a.key(),ss);
-                auto it = target.find(a.key());
-                if (it != target.object_range().end())
+                if (unwinder != nullptr)
                 {
-                    auto temp_diff = from_diff(a.value(),it->value(),ss.str());
-                    result.insert(result.array_range().end(),temp_diff.array_range().begin(),temp_diff.array_range().end());
-                }
-                else
-                {
-                    Json val = typename Json::object();
-                    val.insert_or_assign(op_literal<char_type>(), remove_literal<char_type>());
-                    val.insert_or_assign(path_literal<char_type>(), ss.str());
-                    result.push_back(std::move(val));
+                    unwinder->stack.push_back({op_type::replace,ptr,std::move(it->value())});
                 }
+                it->value() = std::forward<T>(value);
             }
-            for (const auto& a : target.object_range())
+            else
             {
-                auto it = source.find(a.key());
-                if (it == source.object_range().end())
+                parent->insert_or_assign(token.name,std::forward<T>(value));
+                if (unwinder != nullptr)
                 {
-                    std::basic_ostringstream<char_type> ss; 
-                    ss << path << '/';
-                    jsonpointer::escape(a.key(),ss);
-                    Json val = typename Json::object();
-                    val.insert_or_assign(op_literal<char_type>(), add_literal<char_type>());
-                    val.insert_or_assign(path_literal<char_type>(), ss.str());
-                    val.insert_or_assign(value_literal<char_type>(), a.value());
-                    result.push_back(std::move(val));
+                    unwinder->stack.push_back({op_type::remove,ptr,Json::null()});
                 }
             }
         }
         else
         {
-            Json val = typename Json::object();
-            val.insert_or_assign(op_literal<char_type>(), replace_literal<char_type>());
-            val.insert_or_assign(path_literal<char_type>(), path);
-            val.insert_or_assign(value_literal<char_type>(), target);
-            result.push_back(std::move(val));
+            return false;
         }
-
-        return result;
+        return true;
     }
-}
 
-template <class Json>
-void apply_patch(Json& target, const Json& patch, std::error_code& patch_ec)
-{
-    typedef typename Json::char_type char_type;
-    typedef typename Json::string_type string_type;
-    typedef typename Json::string_view_type string_view_type;
+    // Moves the value that ptr refers to into taken and erases it
+    template <class Json>
+    bool take_value(Json& target, const jsonpointer::basic_json_pointer<typename Json::char_type>& ptr, Json& taken)
+    {
+        if (ptr.empty())
+        {
+            return false;
+        }
+        Json* parent = nullptr;
+        if (!resolve_parent(target, ptr, parent))
+        {
+            return false;
+        }
+        const auto& token = ptr.tokens().back();
+        if (parent->is_array())
+        {
+            if (token.index_ec != jsonpointer::jsonpointer_errc() || token.index >= parent->size())
+            {
+                return false;
+            }
+            taken = std::move((*parent)[token.index]);
+            parent->erase(parent->array_range().begin()+token.index);
+        }
+        else if (parent->is_object())
+        {
+            auto it = parent->find(token.name);
+            if (it == parent->object_range().end())
+            {
+                return false;
+            }
+            taken = std::move(it->value());
+            parent->erase(it);
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
 
-   jsoncons::jsonpatch::detail::operation_unwinder<Json> unwinder(target);
+    template <class Json,class T>
+    bool replace_value(Json& target, const jsonpointer::basic_json_pointer<typename Json::char_type>& ptr, 
+                       T&& value, operation_unwinder<Json>* unwinder)
+    {
+        Json* location = std::addressof(target);
+        if (!ptr.empty())
+        {
+            Json* parent = nullptr;
+            if (!resolve_parent(target, ptr, parent))
+            {
+                return false;
+            }
+            const auto& token = ptr.tokens().back();
+            if (parent->is_array())
+            {
+                if (token.index_ec != jsonpointer::jsonpointer_errc() || token.index >= parent->size())
+                {
+                    return false;
+                }
+                location = std::addressof((*parent)[token.index]);
+            }
+            else if (parent->is_object())
+            {
+                auto it = parent->find(token.name);
+                if (it == parent->object_range().end())
+                {
+                    return false;
+                }
+                location = std::addressof(it->value());
+            }
+            else
+            {
+                return false;
+            }
+        }
+        if (unwinder != nullptr)
+        {
+            unwinder->stack.push_back({op_type::replace,ptr,std::move(*location)});
+        }
+        *location = std::forward<T>(value);
+        return true;
+    }
 
-    // Validate
-    
-    string_type bad_path;
-    for (const auto& operation : patch.array_range())
+    // Applies one operation, returns the error that made it fail
+    template <class Json,class Operation>
+    jsonpatch_errc apply_operation(Json& target, Operation& operation, operation_unwinder<Json>* unwinder)
     {
-        unwinder.state =jsoncons::jsonpatch::detail::state_type::begin;
+        typedef typename Json::char_type char_type;
+        typedef typename Json::string_view_type string_view_type;
+        typedef jsonpointer::basic_json_pointer<char_type> pointer_type;
+
+        auto op_it = operation.find(op_literal<char_type>());
+        auto path_it = operation.find(path_literal<char_type>());
+        if (op_it == operation.object_range().end() || path_it == operation.object_range().end())
+        {
+            return jsonpatch_errc::invalid_patch;
+        }
+        auto value_it = operation.find(value_literal<char_type>());
+        bool has_value = value_it != operation.object_range().end();
+
+        const string_view_type op = op_it->value().as_string_view();
+        std::error_code path_ec;
+        pointer_type path(path_it->value().as_string_view(), path_ec);
+
+        if (op == test_literal<char_type>())
+        {
+            if (path_ec)
+            {
+                return jsonpatch_errc::test_failed;
+            }
+            std::error_code ec;
+            const Json& val = jsonpointer::get(static_cast<const Json&>(target),path,ec);
+            if (ec)
+            {
+                return jsonpatch_errc::test_failed;
+            }
+            if (!has_value)
+            {
+                return jsonpatch_errc::invalid_patch;
+            }
+            if (val != value_it->value())
+            {
+                return jsonpatch_errc::test_failed;
+            }
+        }
+        else if (op == add_literal<char_type>())
+        {
+            if (!has_value)
+            {
+                return jsonpatch_errc::invalid_patch;
+            }
+            if (path_ec || !add_value(target, path, patch_value(value_it->value()), unwinder))
+            {
+                return jsonpatch_errc::add_failed;
+            }
+        }
+        else if (op == remove_literal<char_type>())
+        {
+            if (path_ec)
+            {
+                return jsonpatch_errc::remove_failed;
+            }
+            if (!path.empty())
+            {
+                Json taken;
+                if (!take_value(target, path, taken))
+                {
+                    return jsonpatch_errc::remove_failed;
+                }
+                if (unwinder != nullptr)
+                {
+                    unwinder->stack.push_back({op_type::add,path,std::move(taken)});
+                }
+            }
+        }
+        else if (op == replace_literal<char_type>())
+        {
+            if (!has_value)
+            {
+                return jsonpatch_errc::invalid_patch;
+            }
+            if (path_ec || !replace_value(target, path, patch_value(value_it->value()), unwinder))
+            {
+                return jsonpatch_errc::replace_failed;
+            }
+        }
+        else if (op == move_literal<char_type>())
+        {
+            auto from_it = operation.find(from_literal<char_type>());
+            if (from_it == operation.object_range().end())
+            {
+                return jsonpatch_errc::invalid_patch;
+            }
+            std::error_code from_ec;
+            pointer_type from(from_it->value().as_string_view(), from_ec);
+            Json val;
+            if (path_ec || from_ec || !take_value(target, from, val))
+            {
+                return jsonpatch_errc::move_failed;
+            }
+            if (unwinder != nullptr)
+            {
+                unwinder->stack.push_back({op_type::add,from,val});
+            }
+            if (!add_value(target, path, std::move(val), unwinder))
+            {
+                return jsonpatch_errc::move_failed;
+            }
+        }
+        else if (op == copy_literal<char_type>())
+        {
+            auto from_it = operation.find(from_literal<char_type>());
+            if (from_it == operation.object_range().end())
+            {
+                return jsonpatch_errc::invalid_patch;
+            }
+            std::error_code from_ec;
+            pointer_type from(from_it->value().as_string_view(), from_ec);
+            if (path_ec || from_ec)
+            {
+                return jsonpatch_errc::copy_failed;
+            }
+            std::error_code ec;
+            Json val = jsonpointer::get(static_cast<const Json&>(target),from,ec);
+            if (ec || !add_value(target, path, std::move(val), unwinder))
+            {
+                return jsonpatch_errc::copy_failed;
+            }
+        }
+        return jsonpatch_errc();
+    }
 
-        if (operation.count(detail::op_literal<char_type>()) != 1 || operation.count(detail::path_literal<char_type>()) != 1)
+    template <class Json,class Patch>
+    void apply_patch(Json& target, Patch& patch, apply_mode mode, std::error_code& patch_ec)
+    {
+        if (mode == apply_mode::atomic)
         {
-            patch_ec = jsonpatch_errc::invalid_patch;
-            unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+            operation_unwinder<Json> unwinder(target);
+            for (auto& operation : patch.array_range())
+            {
+                jsonpatch_errc ec = apply_operation(target, operation, std::addressof(unwinder));
+                if (ec != jsonpatch_errc())
+                {
+                    patch_ec = ec;
+                    unwinder.state = state_type::abort;
+                    return;
+                }
+            }
+            unwinder.state = state_type::commit;
         }
         else
         {
-            const string_view_type op = operation.at(detail::op_literal<char_type>()).as_string_view();
-            const string_view_type path = operation.at(detail::path_literal<char_type>()).as_string_view();
+            for (auto& operation : patch.array_range())
+            {
+                jsonpatch_errc ec = apply_operation<Json>(target, operation, nullptr);
+                if (ec != jsonpatch_errc() && !patch_ec)
+                {
+                    patch_ec = ec;
+                }
+            }
+        }
+    }
+
+    // Builds a JSON Patch that turns source into target. The values of both 
+    // documents are hashed bottom up, the hashes of arrays and objects are kept
+    // while diffing, and subtrees with the same hash are taken to be equal. 
+    // Arrays are aligned with Myers' O(ND) algorithm on the hashes of their 
+    // elements, elements that are removed in one place and added in another
+    // become moves.
+    template <class Json>
+    class diff_builder
+    {
+        typedef typename Json::char_type char_type;
+        typedef typename Json::string_type string_type;
+
+        enum class edit_kind {keep, modify, remove, insert};
+
+        struct edit
+        {
+            edit_kind kind;
+            size_t i;        // index in source
+            size_t j;        // index in target
+            size_t partner;  // for a move, the slot of the matching remove or insert
+        };
+
+        // Counts the elements present in the slots before a slot
+        class slot_counts
+        {
+            std::vector<size_t> tree_;
+        public:
+            slot_counts(size_t n)
+                : tree_(n+1, 0)
+            {
+            }
+
+            void add(size_t slot, int delta)
+            {
+                for (size_t i = slot+1; i < tree_.size(); i += i & (~i + 1))
+                {
+                    tree_[i] += delta;
+                }
+            }
+
+            size_t before(size_t slot) const
+            {
+                size_t sum = 0;
+                for (size_t i = slot; i > 0; i -= i & (~i + 1))
+                {
+                    sum += tree_[i];
+                }
+                return sum;
+            }
+        };
+
+        static const size_t no_partner = (size_t)-1;
+        // Bounds the work of aligning one array, beyond it the remaining 
+        // elements are paired by position
+        static const size_t max_edit_distance = 1024;
+        static const size_t max_alignment_work = size_t(1) << 26;
+
+        std::unordered_map<const Json*,uint64_t> hashes_;
+        Json result_;
+    public:
+        diff_builder()
+            : result_(typename Json::array())
+        {
+        }
+
+        Json diff(const Json& source, const Json& target)
+        {
+            string_type path;
+            diff_value(source, target, path);
+            return std::move(result_);
+        }
 
-            if (op ==jsoncons::jsonpatch::detail::test_literal<char_type>())
+        uint64_t hash(const Json& val)
+        {
+            if (val.is_array() || val.is_object())
             {
-                std::error_code ec;
-                Json val = jsonpointer::get(target,path,ec);
-                if (ec)
+                auto it = hashes_.find(std::addressof(val));
+                if (it != hashes_.end())
                 {
-                    patch_ec = jsonpatch_errc::test_failed;
-                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                    return it->second;
                 }
-                else if (operation.count(detail::value_literal<char_type>()) != 1)
+            }
+            uint64_t h;
+            if (val.is_array())
+            {
+                h = mix(6 + val.size());
+                for (const auto& item : val.array_range())
                 {
-                    patch_ec = jsonpatch_errc::invalid_patch;
-                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                    h = mix(h ^ hash(item));
                 }
-                else if (val != operation.at(detail::value_literal<char_type>()))
+                hashes_.emplace(std::addressof(val), h);
+            }
+            else if (val.is_object())
+            {
+                // Members are combined in any order, as objects are equal 
+                // if they have the same members in any order
+                h = mix(7 + val.size());
+                for (const auto& member : val.object_range())
                 {
-                    patch_ec = jsonpatch_errc::test_failed;
-                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                    auto key = member.key();
+                    h += mix(hash_bytes(reinterpret_cast<const uint8_t*>(key.data()), key.size()*sizeof(char_type)) ^ mix(hash(member.value())));
                 }
+                hashes_.emplace(std::addressof(val), h);
             }
-            else if (op ==jsoncons::jsonpatch::detail::add_literal<char_type>())
+            else if (val.is_string())
             {
-                if (operation.count(detail::value_literal<char_type>()) != 1)
+                auto sv = val.as_string_view();
+                h = mix(4 ^ hash_bytes(reinterpret_cast<const uint8_t*>(sv.data()), sv.size()*sizeof(char_type)));
+            }
+            else if (val.is_byte_string())
+            {
+                auto bs = val.as_byte_string_view();
+                h = mix(5 ^ hash_bytes(bs.data(), bs.length()));
+            }
+            else if (val.is_int64())
+            {
+                int64_t n = val.template as<int64_t>();
+                h = n < 0 ? mix(mix(8) ^ static_cast<uint64_t>(n)) : mix(mix(9) ^ static_cast<uint64_t>(n));
+            }
+            else if (val.is_uint64())
+            {
+                h = mix(mix(9) ^ val.template as<uint64_t>());
+            }
+            else if (val.is_double())
+            {
+                // Integral doubles hash as the integers that compare equal to them
+                double d = val.template as<double>();
+                if (d == std::floor(d) && d >= -9223372036854775808.0 && d < 0)
+                {
+                    h = mix(mix(8) ^ static_cast<uint64_t>(static_cast<int64_t>(d)));
+                }
+                else if (d == std::floor(d) && d >= 0 && d < 18446744073709551616.0)
                 {
-                    patch_ec = jsonpatch_errc::invalid_patch;
-                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                    h = mix(mix(9) ^ static_cast<uint64_t>(d));
                 }
                 else
                 {
-                    std::error_code insert_ec;
-                    Json val = operation.at(detail::value_literal<char_type>());
-                    auto npath = jsonpointer::normalized_path(target,path);
-                    jsonpointer::insert(target,npath,val,insert_ec); // try insert without replace
-                    if (insert_ec) // try a replace
-                    {
-                        std::error_code select_ec;
-                        Json orig_val = jsonpointer::get(target,npath,select_ec);
-                        if (select_ec) // shouldn't happen
-                        {
-                            patch_ec = jsonpatch_errc::add_failed;
-                            unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
-                        }
-                        else
-                        {
-                            std::error_code replace_ec;
-                            jsonpointer::replace(target,npath,val,replace_ec);
-                            if (replace_ec)
-                            {
-                                patch_ec = jsonpatch_errc::add_failed;
-                                unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
-                            }
-                            else
-                            {
-                                unwinder.stack.push_back({detail::op_type::replace,npath,orig_val});
-                            }
-                        }
-                    }
-                    else // insert without replace succeeded
-                    {
-                        unwinder.stack.push_back({detail::op_type::remove,npath,Json::null()});
-                    }
+                    uint64_t bits;
+                    std::memcpy(&bits, &d, sizeof(bits));
+                    h = mix(mix(10) ^ bits);
+                }
+            }
+            else if (val.is_bool())
+            {
+                h = mix(val.as_bool() ? 2 : 3);
+            }
+            else
+            {
+                h = mix(1);
+            }
+            return h;
+        }
+
+    private:
+        static uint64_t mix(uint64_t h)
+        {
+            h += 0x9e3779b97f4a7c15ULL;
+            h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+            return h ^ (h >> 31);
+        }
+
+        static uint64_t hash_bytes(const uint8_t* p, size_t length)
+        {
+            uint64_t h = 14695981039346656037ULL;
+            for (size_t i = 0; i < length; ++i)
+            {
+                h ^= p[i];
+                h *= 1099511628211ULL;
+            }
+            return h;
+        }
+
+        static string_type child_path(const string_type& path, size_t index)
+        {
+            string_type s(path);
+            s.push_back('/');
+            char buf[24];
+            size_t n = 0;
+            do
+            {
+                buf[n++] = static_cast<char>('0' + index % 10);
+                index /= 10;
+            } 
+            while (index > 0);
+            while (n > 0)
+            {
+                s.push_back(buf[--n]);
+            }
+            return s;
+        }
+
+        template <class Key>
+        static string_type child_path(const string_type& path, const Key& key)
+        {
+            string_type s(path);
+            s.push_back('/');
+            for (auto c : key)
+            {
+                if (c == '~')
+                {
+                    s.push_back('~');
+                    s.push_back('0');
+                }
+                else if (c == '/')
+                {
+                    s.push_back('~');
+                    s.push_back('1');
                 }
+                else
+                {
+                    s.push_back(c);
+                }
+            }
+            return s;
+        }
+
+        void emit(const basic_string_view<char_type>& op, string_type&& path)
+        {
+            Json val = typename Json::object();
+            val.insert_or_assign(op_literal<char_type>(), op);
+            val.insert_or_assign(path_literal<char_type>(), std::move(path));
+            result_.push_back(std::move(val));
+        }
+
+        void emit(const basic_string_view<char_type>& op, string_type&& path, const Json& value)
+        {
+            Json val = typename Json::object();
+            val.insert_or_assign(op_literal<char_type>(), op);
+            val.insert_or_assign(path_literal<char_type>(), std::move(path));
+            val.insert_or_assign(value_literal<char_type>(), value);
+            result_.push_back(std::move(val));
+        }
+
+        void emit_move(string_type&& from, string_type&& path)
+        {
+            Json val = typename Json::object();
+            val.insert_or_assign(op_literal<char_type>(), move_literal<char_type>());
+            val.insert_or_assign(from_literal<char_type>(), std::move(from));
+            val.insert_or_assign(path_literal<char_type>(), std::move(path));
+            result_.push_back(std::move(val));
+        }
+
+        void diff_value(const Json& source, const Json& target, const string_type& path)
+        {
+            if (hash(source) == hash(target))
+            {
+                return;
+            }
+            if (source.is_array() && target.is_array())
+            {
+                diff_array(source, target, path);
+            }
+            else if (source.is_object() && target.is_object())
+            {
+                diff_object(source, target, path);
             }
-            else if (op ==jsoncons::jsonpatch::detail::remove_literal<char_type>())
+            else
             {
-                std::error_code ec;
-                Json val = jsonpointer::get(target,path,ec);
-                if (ec)
+                emit(replace_literal<char_type>(), string_type(path), target);
+            }
+        }
+
+        void diff_object(const Json& source, const Json& target, const string_type& path)
+        {
+            for (const auto& a : source.object_range())
+            {
+                auto it = target.find(a.key());
+                if (it != target.object_range().end())
                 {
-                    patch_ec = jsonpatch_errc::remove_failed;
-                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                    diff_value(a.value(), it->value(), child_path(path, a.key()));
                 }
                 else
                 {
-                    jsonpointer::remove(target,path,ec);
-                    if (ec)
+                    emit(remove_literal<char_type>(), child_path(path, a.key()));
+                }
+            }
+            for (const auto& a : target.object_range())
+            {
+                auto it = source.find(a.key());
+                if (it == source.object_range().end())
+                {
+                    emit(add_literal<char_type>(), child_path(path, a.key()), a.value());
+                }
+            }
+        }
+
+        void diff_array(const Json& source, const Json& target, const string_type& path)
+        {
+            const size_t n = source.size();
+            const size_t m = target.size();
+            std::vector<uint64_t> a(n);
+            std::vector<uint64_t> b(m);
+            for (size_t i = 0; i < n; ++i)
+            {
+                a[i] = hash(source[i]);
+            }
+            for (size_t j = 0; j < m; ++j)
+            {
+                b[j] = hash(target[j]);
+            }
+
+            // Equal leading and trailing elements are left alone
+            size_t prefix = 0;
+            while (prefix < n && prefix < m && a[prefix] == b[prefix])
+            {
+                ++prefix;
+            }
+            size_t suffix = 0;
+            while (suffix < n-prefix && suffix < m-prefix && a[n-1-suffix] == b[m-1-suffix])
+            {
+                ++suffix;
+            }
+
+            std::vector<edit> script;
+            if (!align(a.data()+prefix, n-prefix-suffix, b.data()+prefix, m-prefix-suffix, prefix, script))
+            {
+                script.clear();
+                for (size_t i = prefix; i < n-suffix; ++i)
+                {
+                    script.push_back(edit{edit_kind::remove, i, 0, no_partner});
+                }
+                for (size_t j = prefix; j < m-suffix; ++j)
+                {
+                    script.push_back(edit{edit_kind::insert, 0, j, no_partner});
+                }
+            }
+            std::vector<edit> slots = arrange(script, a, b);
+            apply_script(source, target, path, prefix, slots);
+        }
+
+        // Myers' algorithm, appends the keeps, removes and inserts that turn 
+        // a into b to script, returns false if the edit distance is too large
+        static bool align(const uint64_t* a, size_t n, const uint64_t* b, size_t m, size_t offset,
+                          std::vector<edit>& script)
+        {
+            const long N = static_cast<long>(n);
+            const long M = static_cast<long>(m);
+            long max_d = static_cast<long>((std::min)(max_edit_distance, max_alignment_work/(n+m+1)));
+            max_d = (std::max)(max_d, 16L);
+            max_d = (std::min)(max_d, N+M);
+
+            std::vector<long> v(2*max_d+3, 0);
+            const long mid = max_d+1;
+            std::vector<std::vector<long>> trace;
+
+            long d_end = -1;
+            for (long d = 0; d <= max_d && d_end < 0; ++d)
+            {
+                trace.emplace_back(v.begin()+(mid-d), v.begin()+(mid+d+1));
+                for (long k = -d; k <= d; k += 2)
+                {
+                    long x = (k == -d || (k != d && v[mid+k-1] < v[mid+k+1])) ? v[mid+k+1] : v[mid+k-1] + 1;
+                    long y = x - k;
+                    while (x < N && y < M && a[x] == b[y])
                     {
-                        patch_ec = jsonpatch_errc::remove_failed;
-                        unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                        ++x;
+                        ++y;
                     }
-                    else
+                    v[mid+k] = x;
+                    if (x >= N && y >= M)
                     {
-                        unwinder.stack.push_back({detail::op_type::add,string_type(path),val});
+                        d_end = d;
+                        break;
                     }
                 }
             }
-            else if (op ==jsoncons::jsonpatch::detail::replace_literal<char_type>())
+            if (d_end < 0)
             {
-                std::error_code ec;
-                Json val = jsonpointer::get(target,path,ec);
-                if (ec)
+                return false;
+            }
+
+            std::vector<edit> reversed;
+            long x = N;
+            long y = M;
+            for (long d = d_end; d >= 0; --d)
+            {
+                const std::vector<long>& vd = trace[d];
+                long k = x - y;
+                long prev_k;
+                if (d == 0)
                 {
-                    patch_ec = jsonpatch_errc::replace_failed;
-                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                    prev_k = 0;
                 }
-                else if (operation.count(detail::value_literal<char_type>()) != 1)
+                else
                 {
-                    patch_ec = jsonpatch_errc::invalid_patch;
-                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                    prev_k = (k == -d || (k != d && vd[k-1+d] < vd[k+1+d])) ? k+1 : k-1;
                 }
-                else
+                long prev_x = d == 0 ? 0 : vd[prev_k+d];
+                long prev_y = prev_x - prev_k;
+                while (x > prev_x && y > prev_y)
+                {
+                    --x;
+                    --y;
+                    reversed.push_back(edit{edit_kind::keep, offset+x, offset+y, no_partner});
+                }
+                if (d > 0)
                 {
-                    jsonpointer::replace(target,path,operation.at(detail::value_literal<char_type>()),ec);
-                    if (ec)
+                    if (x == prev_x)
                     {
-                        patch_ec = jsonpatch_errc::replace_failed;
-                        unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                        reversed.push_back(edit{edit_kind::insert, 0, offset+prev_y, no_partner});
                     }
                     else
                     {
-                        unwinder.stack.push_back({detail::op_type::replace,string_type(path),val});
+                        reversed.push_back(edit{edit_kind::remove, offset+prev_x, 0, no_partner});
                     }
                 }
+                x = prev_x;
+                y = prev_y;
             }
-            else if (op ==jsoncons::jsonpatch::detail::move_literal<char_type>())
+            script.insert(script.end(), reversed.rbegin(), reversed.rend());
+            return true;
+        }
+
+        // Matches removed and inserted elements with the same hash as moves, 
+        // pairs the remaining removes and inserts of each run of edits as 
+        // modifications, and orders the slots of each run so that the 
+        // elements present in the array are in slot order
+        static std::vector<edit> arrange(const std::vector<edit>& script, 
+                                         const std::vector<uint64_t>& a, const std::vector<uint64_t>& b)
+        {
+            std::unordered_map<uint64_t,std::vector<size_t>> removed; // hash -> positions in script
+            for (size_t pos = script.size(); pos-- > 0; )
             {
-                if (operation.count(detail::from_literal<char_type>()) != 1)
+                if (script[pos].kind == edit_kind::remove)
                 {
-                    patch_ec = jsonpatch_errc::invalid_patch;
-                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                    removed[a[script[pos].i]].push_back(pos);
                 }
-                else
+            }
+            std::vector<size_t> moved_to(script.size(), no_partner);
+            std::vector<size_t> moved_from(script.size(), no_partner);
+            if (!removed.empty())
+            {
+                for (size_t pos = 0; pos < script.size(); ++pos)
                 {
-                    string_view_type from = operation.at(detail::from_literal<char_type>()).as_string_view();
-                    std::error_code ec;
-                    Json val = jsonpointer::get(target,from,ec);
-                    if (ec)
+                    if (script[pos].kind == edit_kind::insert)
                     {
-                        patch_ec = jsonpatch_errc::move_failed;
-                        unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
-                    }
-                    else 
-                    {
-                        jsonpointer::remove(target,from,ec);
-                        if (ec)
+                        auto it = removed.find(b[script[pos].j]);
+                        if (it != removed.end() && !it->second.empty())
                         {
-                            patch_ec = jsonpatch_errc::move_failed;
-                            unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                            moved_from[pos] = it->second.back();
+                            moved_to[it->second.back()] = pos;
+                            it->second.pop_back();
                         }
-                        else
-                        {
-                            unwinder.stack.push_back({detail::op_type::add,string_type(from),val});
-                            // add
-                            std::error_code insert_ec;
-                            auto npath = jsonpointer::normalized_path(target,path);
-                            jsonpointer::insert(target,npath,val,insert_ec); // try insert without replace
-                            if (insert_ec) // try a replace
-                            {
-                                std::error_code select_ec;
-                                Json orig_val = jsonpointer::get(target,npath,select_ec);
-                                if (select_ec) // shouldn't happen
-                                {
-                                    patch_ec = jsonpatch_errc::copy_failed;
-                                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
-                                }
-                                else
-                                {
-                                    std::error_code replace_ec;
-                                    jsonpointer::replace(target, npath, val, replace_ec);
-                                    if (replace_ec)
-                                    {
-                                        patch_ec = jsonpatch_errc::copy_failed;
-                                        unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
-
-                                    }
-                                    else
-                                    {
-                                        unwinder.stack.push_back({jsoncons::jsonpatch::detail::op_type::replace,npath,orig_val });
-                                    }
-                                    
-                                }
-                            }
-                            else
-                            {
-                                unwinder.stack.push_back({detail::op_type::remove,npath,Json::null()});
-                            }
-                        }           
                     }
                 }
             }
-            else if (op ==jsoncons::jsonpatch::detail::copy_literal<char_type>())
+
+            std::vector<edit> slots;
+            slots.reserve(script.size());
+            std::vector<size_t> slot_of(script.size(), no_partner);
+
+            size_t first = 0;
+            while (first < script.size())
             {
-                if (operation.count(detail::from_literal<char_type>()) != 1)
+                if (script[first].kind == edit_kind::keep)
                 {
-                    patch_ec = jsonpatch_errc::invalid_patch;
-                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                    slots.push_back(script[first]);
+                    ++first;
+                    continue;
                 }
-                else
+                size_t last = first;
+                while (last < script.size() && script[last].kind != edit_kind::keep)
+                {
+                    ++last;
+                }
+                std::vector<size_t> removes;
+                std::vector<size_t> inserts;
+                for (size_t pos = first; pos < last; ++pos)
+                {
+                    if (script[pos].kind == edit_kind::remove)
+                    {
+                        removes.push_back(pos);
+                    }
+                    else
+                    {
+                        inserts.push_back(pos);
+                    }
+                }
+                std::sort(removes.begin(), removes.end(), [&script](size_t lhs, size_t rhs){return script[lhs].i < script[rhs].i;});
+                std::sort(inserts.begin(), inserts.end(), [&script](size_t lhs, size_t rhs){return script[lhs].j < script[rhs].j;});
+
+                // Pair the k-th unmatched remove with the k-th unmatched insert
+                std::vector<size_t> paired_insert(script.size() > 0 ? removes.size() : 0, no_partner);
+                std::vector<bool> insert_paired(inserts.size(), false);
+                size_t next_insert = 0;
+                for (size_t r = 0; r < removes.size(); ++r)
+                {
+                    if (moved_to[removes[r]] != no_partner)
+                    {
+                        continue;
+                    }
+                    while (next_insert < inserts.size() && moved_from[inserts[next_insert]] != no_partner)
+                    {
+                        ++next_insert;
+                    }
+                    if (next_insert < inserts.size())
+                    {
+                        paired_insert[r] = next_insert;
+                        insert_paired[next_insert] = true;
+                        ++next_insert;
+                    }
+                }
+
+                // Removes stay in source order, modifications in target order
+                // among the inserts
+                size_t ins = 0;
+                for (size_t r = 0; r < removes.size(); ++r)
                 {
-                    std::error_code ec;
-                    string_view_type from = operation.at(detail::from_literal<char_type>()).as_string_view();
-                    Json val = jsonpointer::get(target,from,ec);
-                    if (ec)
+                    const edit& e = script[removes[r]];
+                    if (paired_insert[r] == no_partner)
                     {
-                        patch_ec = jsonpatch_errc::copy_failed;
-                        unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
+                        slot_of[removes[r]] = slots.size();
+                        slots.push_back(edit{edit_kind::remove, e.i, 0, no_partner});
                     }
                     else
                     {
-                        // add
-                        auto npath = jsonpointer::normalized_path(target,path);
-                        std::error_code insert_ec;
-                        jsonpointer::insert(target,npath,val,insert_ec); // try insert without replace
-                        if (insert_ec) // Failed, try a replace
+                        size_t j = script[inserts[paired_insert[r]]].j;
+                        for (; ins < inserts.size() && script[inserts[ins]].j < j; ++ins)
                         {
-                            std::error_code select_ec;
-                            Json orig_val = jsonpointer::get(target,npath, select_ec);
-                            if (select_ec) // shouldn't happen
+                            if (!insert_paired[ins])
                             {
-                                patch_ec = jsonpatch_errc::copy_failed;
-                                unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
-                            }
-                            else 
-                            {
-                                std::error_code replace_ec;
-                                jsonpointer::replace(target, npath, val,replace_ec);
-                                if (replace_ec)
-                                {
-                                    patch_ec = jsonpatch_errc::copy_failed;
-                                    unwinder.state =jsoncons::jsonpatch::detail::state_type::abort;
-                                }
-                                else
-                                {
-                                    unwinder.stack.push_back({jsoncons::jsonpatch::detail::op_type::replace,npath,orig_val });
-                                }
+                                slot_of[inserts[ins]] = slots.size();
+                                slots.push_back(script[inserts[ins]]);
                             }
                         }
-                        else
-                        {
-                            unwinder.stack.push_back({detail::op_type::remove,npath,Json::null()});
-                        }
+                        slots.push_back(edit{edit_kind::modify, e.i, j, no_partner});
                     }
                 }
+                for (; ins < inserts.size(); ++ins)
+                {
+                    if (!insert_paired[ins])
+                    {
+                        slot_of[inserts[ins]] = slots.size();
+                        slots.push_back(script[inserts[ins]]);
+                    }
+                }
+                first = last;
             }
-            if (unwinder.state !=jsoncons::jsonpatch::detail::state_type::begin)
+
+            for (size_t pos = 0; pos < script.size(); ++pos)
             {
-                bad_path = string_type(path);
+                if (moved_from[pos] != no_partner)
+                {
+                    slots[slot_of[pos]].partner = slot_of[moved_from[pos]];
+                    slots[slot_of[moved_from[pos]]].partner = slot_of[pos];
+                }
             }
+            return slots;
         }
-        if (unwinder.state !=jsoncons::jsonpatch::detail::state_type::begin)
+
+        void apply_script(const Json& source, const Json& target, const string_type& path, 
+                          size_t prefix, const std::vector<edit>& slots)
         {
-            break;
+            slot_counts present(slots.size());
+            for (size_t s = 0; s < slots.size(); ++s)
+            {
+                if (slots[s].kind != edit_kind::insert)
+                {
+                    present.add(s, 1);
+                }
+            }
+            for (size_t s = 0; s < slots.size(); ++s)
+            {
+                const edit& e = slots[s];
+                switch (e.kind)
+                {
+                    case edit_kind::keep:
+                        break;
+                    case edit_kind::modify:
+                        diff_value(source[e.i], target[e.j], child_path(path, prefix + present.before(s)));
+                        break;
+                    case edit_kind::remove:
+                        if (e.partner == no_partner)
+                        {
+                            emit(remove_literal<char_type>(), child_path(path, prefix + present.before(s)));
+                            present.add(s, -1);
+                        }
+                        // A moved element stays until it is moved
+                        break;
+                    case edit_kind::insert:
+                        if (e.partner == no_partner)
+                        {
+                            emit(add_literal<char_type>(), child_path(path, prefix + present.before(s)), target[e.j]);
+                        }
+                        else
+                        {
+                            size_t from = prefix + present.before(e.partner);
+                            present.add(e.partner, -1);
+                            size_t to = prefix + present.before(s);
+                            if (from != to)
+                            {
+                                emit_move(child_path(path, from), child_path(path, to));
+                            }
+                        }
+                        present.add(s, 1);
+                        break;
+                }
+            }
         }
-    }
-    if (unwinder.state ==jsoncons::jsonpatch::detail::state_type::begin)
-    {
-        unwinder.state =jsoncons::jsonpatch::detail::state_type::commit;
-    }
+    };
+
+    template <class Json>
+    const size_t diff_builder<Json>::no_partner;
+    template <class Json>
+    const size_t diff_builder<Json>::max_edit_distance;
+    template <class Json>
+    const size_t diff_builder<Json>::max_alignment_work;
+}
+
+template <class Json>
+void apply_patch(Json& target, const Json& patch, std::error_code& patch_ec)
+{
+    jsoncons::jsonpatch::detail::apply_patch(target, patch, apply_mode::atomic, patch_ec);
+}
+
+template <class Json>
+void apply_patch(Json& target, const Json& patch, apply_mode mode, std::error_code& patch_ec)
+{
+    jsoncons::jsonpatch::detail::apply_patch(target, patch, mode, patch_ec);
+}
+
+// The values of the operations are moved into target
+template <class Json>
+void apply_patch(Json& target, Json&& patch, std::error_code& patch_ec)
+{
+    jsoncons::jsonpatch::detail::apply_patch(target, patch, apply_mode::atomic, patch_ec);
+}
+
+template <class Json>
+void apply_patch(Json& target, Json&& patch, apply_mode mode, std::error_code& patch_ec)
+{
+    jsoncons::jsonpatch::detail::apply_patch(target, patch, mode, patch_ec);
 }
 
 template <class Json>
 Json from_diff(const Json& source, const Json& target)
 {
-    typename Json::string_type path;
-    return jsoncons::jsonpatch::detail::from_diff(source, target, path);
+    jsoncons::jsonpatch::detail::diff_builder<Json> builder;
+    return builder.diff(source, target);
 }
 
 template <class Json>
@@ -523,6 +1160,28 @@ void apply_patch(Json& target, const Json& patch)
     }
 }
 
+template <class Json>
+void apply_patch(Json& target, const Json& patch, apply_mode mode)
+{
+    std::error_code ec;
+    apply_patch(target, patch, mode, ec);
+    if (ec)
+    {
+        JSONCONS_THROW(jsonpatch_error(ec));
+    }
+}
+
+template <class Json>
+void apply_patch(Json& target, Json&& patch, apply_mode mode = apply_mode::atomic)
+{
+    std::error_code ec;
+    apply_patch(target, std::move(patch), mode, ec);
+    if (ec)
+    {
+        JSONCONS_THROW(jsonpatch_error(ec));
+    }
+}
+
 }}
 
 #endif
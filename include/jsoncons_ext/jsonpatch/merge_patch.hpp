@@ -0,0 +1,352 @@
+// Copyright 2019 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_JSONPATCH_MERGE_PATCH_HPP
+#define JSONCONS_JSONPATCH_MERGE_PATCH_HPP
+
+#include <vector>
+#include <iterator> // std::distance
+#include <utility> // std::move
+#include <system_error>
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_filter.hpp>
+#include <jsoncons/staj_reader.hpp>
+#include <jsoncons_ext/jsonpatch/jsonpatch.hpp>
+
+namespace jsoncons { namespace jsonpatch {
+
+namespace detail {
+
+    // Applies an RFC 7396 merge patch to target in place. Values are moved
+    // out of a patch that is not const.
+    template <class Json, class Patch>
+    void merge_patch(Json& target, Patch& patch)
+    {
+        if (!patch.is_object())
+        {
+            target = patch_value(patch);
+            return;
+        }
+        if (!target.is_object())
+        {
+            target = typename Json::object();
+        }
+        for (auto& member : patch.object_range())
+        {
+            if (member.value().is_null())
+            {
+                target.erase(member.key());
+                continue;
+            }
+            auto it = target.find(member.key());
+            if (it != target.object_range().end())
+            {
+                merge_patch(it->value(), member.value());
+            }
+            else if (member.value().is_object())
+            {
+                // Merged into an empty object so that null members are dropped
+                auto result = target.insert_or_assign(member.key(), typename Json::object());
+                merge_patch(result.first->value(), member.value());
+            }
+            else
+            {
+                target.insert_or_assign(member.key(), patch_value(member.value()));
+            }
+        }
+    }
+
+    // Forwards the events of a single value to the destination handler, and
+    // returns false when the value is complete, so that a staj reader's
+    // accept stops at the end of the value. Flushes are left to the caller.
+    template <class CharT>
+    class merge_patch_forwarder : public basic_json_filter<CharT>
+    {
+    public:
+        using typename basic_json_filter<CharT>::string_view_type;
+    private:
+        size_t level_;
+    public:
+        merge_patch_forwarder(basic_json_content_handler<CharT>& handler)
+            : basic_json_filter<CharT>(handler), level_(0)
+        {
+        }
+    private:
+        void do_flush() override
+        {
+        }
+
+        bool do_begin_object(semantic_tag_type tag, const serializing_context& context) override
+        {
+            ++level_;
+            this->destination_handler().begin_object(tag, context);
+            return true;
+        }
+
+        bool do_begin_object(size_t length, semantic_tag_type tag, const serializing_context& context) override
+        {
+            ++level_;
+            this->destination_handler().begin_object(length, tag, context);
+            return true;
+        }
+
+        bool do_end_object(const serializing_context& context) override
+        {
+            this->destination_handler().end_object(context);
+            return --level_ > 0;
+        }
+
+        bool do_begin_array(semantic_tag_type tag, const serializing_context& context) override
+        {
+            ++level_;
+            this->destination_handler().begin_array(tag, context);
+            return true;
+        }
+
+        bool do_begin_array(size_t length, semantic_tag_type tag, const serializing_context& context) override
+        {
+            ++level_;
+            this->destination_handler().begin_array(length, tag, context);
+            return true;
+        }
+
+        bool do_end_array(const serializing_context& context) override
+        {
+            this->destination_handler().end_array(context);
+            return --level_ > 0;
+        }
+
+        bool do_name(const string_view_type& name, const serializing_context& context) override
+        {
+            this->destination_handler().name(name, context);
+            return true;
+        }
+
+        bool do_string_value(const string_view_type& value, semantic_tag_type tag, const serializing_context& context) override
+        {
+            this->destination_handler().string_value(value, tag, context);
+            return level_ > 0;
+        }
+
+        bool do_byte_string_value(const byte_string_view& b,
+                                  byte_string_chars_format encoding_hint,
+                                  semantic_tag_type tag,
+                                  const serializing_context& context) override
+        {
+            this->destination_handler().byte_string_value(b, encoding_hint, tag, context);
+            return level_ > 0;
+        }
+
+        bool do_double_value(double value,
+                             const floating_point_options& fmt,
+                             semantic_tag_type tag,
+                             const serializing_context& context) override
+        {
+            this->destination_handler().double_value(value, fmt, tag, context);
+            return level_ > 0;
+        }
+
+        bool do_int64_value(int64_t value, semantic_tag_type tag, const serializing_context& context) override
+        {
+            this->destination_handler().int64_value(value, tag, context);
+            return level_ > 0;
+        }
+
+        bool do_uint64_value(uint64_t value, semantic_tag_type tag, const serializing_context& context) override
+        {
+            this->destination_handler().uint64_value(value, tag, context);
+            return level_ > 0;
+        }
+
+        bool do_bool_value(bool value, semantic_tag_type tag, const serializing_context& context) override
+        {
+            this->destination_handler().bool_value(value, tag, context);
+            return level_ > 0;
+        }
+
+        bool do_null_value(semantic_tag_type tag, const serializing_context& context) override
+        {
+            this->destination_handler().null_value(tag, context);
+            return level_ > 0;
+        }
+    };
+
+    // Writes the result of merging patch into a value that is not an object,
+    // i.e. the patch with the null members of its objects removed
+    template <class Json>
+    void write_merge_patch_value(const Json& patch, merge_patch_forwarder<typename Json::char_type>& forwarder)
+    {
+        if (!patch.is_object())
+        {
+            patch.dump(forwarder);
+            return;
+        }
+        auto& handler = forwarder.destination_handler();
+        handler.begin_object(patch.semantic_tag());
+        for (const auto& member : patch.object_range())
+        {
+            if (!member.value().is_null())
+            {
+                handler.name(member.key());
+                write_merge_patch_value(member.value(), forwarder);
+            }
+        }
+        handler.end_object();
+    }
+
+    // Reads the value at the current event of reader, and writes it with
+    // patch merged in. The reader is left at the last event of the value.
+    // Unpatched values are passed through the forwarder, the rest is written
+    // to its destination handler directly.
+    template <class Json>
+    void merge_patch(basic_staj_reader<typename Json::char_type>& reader,
+                     const Json& patch,
+                     merge_patch_forwarder<typename Json::char_type>& forwarder,
+                     std::error_code& ec)
+    {
+        typedef typename Json::string_type string_type;
+
+        if (!patch.is_object() || reader.current().event_type() != staj_event_type::begin_object)
+        {
+            reader.skip(ec);
+            if (ec) return;
+            write_merge_patch_value(patch, forwarder);
+            return;
+        }
+
+        auto& handler = forwarder.destination_handler();
+        handler.begin_object(reader.current().semantic_tag(), reader.context());
+        auto members = patch.object_range();
+        std::vector<bool> seen(patch.size(), false);
+        for (;;)
+        {
+            reader.next(ec);
+            if (ec) return;
+            if (reader.current().event_type() == staj_event_type::end_object)
+            {
+                break;
+            }
+            string_type name = reader.current().template as<string_type>();
+            reader.next(ec);
+            if (ec) return;
+
+            auto it = patch.find(name);
+            if (it == members.end())
+            {
+                handler.name(name, reader.context());
+                reader.accept(forwarder, ec);
+            }
+            else
+            {
+                seen[std::distance(members.begin(), it)] = true;
+                if (it->value().is_null())
+                {
+                    reader.skip(ec);
+                }
+                else
+                {
+                    handler.name(name, reader.context());
+                    merge_patch(reader, it->value(), forwarder, ec);
+                }
+            }
+            if (ec) return;
+        }
+
+        size_t index = 0;
+        for (const auto& member : members)
+        {
+            if (!seen[index++] && !member.value().is_null())
+            {
+                handler.name(member.key());
+                write_merge_patch_value(member.value(), forwarder);
+            }
+        }
+        handler.end_object(reader.context());
+    }
+
+    template <class Json>
+    Json create_merge_patch(const Json& source, const Json& target)
+    {
+        if (!source.is_object() || !target.is_object())
+        {
+            return target;
+        }
+        Json patch = typename Json::object();
+        for (const auto& member : source.object_range())
+        {
+            if (!target.contains(member.key()))
+            {
+                patch.insert_or_assign(member.key(), Json::null());
+            }
+        }
+        for (const auto& member : target.object_range())
+        {
+            auto it = source.find(member.key());
+            if (it == source.object_range().end())
+            {
+                patch.insert_or_assign(member.key(), member.value());
+            }
+            else if (it->value() != member.value())
+            {
+                patch.insert_or_assign(member.key(), create_merge_patch(it->value(), member.value()));
+            }
+        }
+        return patch;
+    }
+}
+
+// Applies an RFC 7396 JSON Merge Patch to target in place
+template <class Json>
+void merge_patch(Json& target, const Json& patch)
+{
+    jsoncons::jsonpatch::detail::merge_patch(target, patch);
+}
+
+// The values of the patch are moved into target
+template <class Json>
+void merge_patch(Json& target, Json&& patch)
+{
+    jsoncons::jsonpatch::detail::merge_patch(target, patch);
+}
+
+// Reads a source document from reader and writes it to handler with patch
+// merged in, without building the source or the result
+template <class Json>
+void merge_patch(basic_staj_reader<typename Json::char_type>& reader,
+                 const Json& patch,
+                 basic_json_content_handler<typename Json::char_type>& handler,
+                 std::error_code& ec)
+{
+    jsoncons::jsonpatch::detail::merge_patch_forwarder<typename Json::char_type> forwarder(handler);
+    jsoncons::jsonpatch::detail::merge_patch(reader, patch, forwarder, ec);
+    if (ec) return;
+    handler.flush();
+}
+
+template <class Json>
+void merge_patch(basic_staj_reader<typename Json::char_type>& reader,
+                 const Json& patch,
+                 basic_json_content_handler<typename Json::char_type>& handler)
+{
+    std::error_code ec;
+    merge_patch(reader, patch, handler, ec);
+    if (ec)
+    {
+        throw serialization_error(ec, reader.context().line_number(), reader.context().column_number());
+    }
+}
+
+// Creates a merge patch that transforms source into target. Null values in
+// target objects cannot be represented in a merge patch.
+template <class Json>
+Json create_merge_patch(const Json& source, const Json& target)
+{
+    return jsoncons::jsonpatch::detail::create_merge_patch(source, target);
+}
+
+}}
+
+#endif
@@ -10,9 +10,18 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <map> // std::map
+#include <functional> // std::function
 #include <type_traits> // std::is_const
 #include <limits> // std::numeric_limits
 #include <utility> // std::move
+#include <algorithm> // std::min
+#include <thread> // std::thread
+#include <exception> // std::exception_ptr
+#include <mutex> // std::mutex
+#include <cmath> // std::fabs
+#include <cstring> // std::memcpy
+#include <unordered_map> // std::unordered_map
 #include <jsoncons/json.hpp>
 #include <jsoncons_ext/jsonpath/jsonpath_filter.hpp>
 #include <jsoncons_ext/jsonpath/jsonpath_error.hpp>
@@ -35,21 +44,93 @@ std::unique_ptr<T> make_unique_ptr(Args&&... args)
 
 enum class result_type {value,path};
 
+template <class Json>
+class jsonpath_index;
+
+// Options for querying an in-memory value. By default a query runs on the
+// calling thread. With max_threads greater than one, recursive descent
+// (e.g. $..price) divides the children of each object or array with at 
+// least parallel_threshold members between up to max_threads threads. 
+// The selected values are the same, and in the same order.
+class query_options
+{
+    size_t max_threads_;
+    size_t parallel_threshold_;
+public:
+    static const size_t default_parallel_threshold = 256;
+
+    query_options()
+        : max_threads_(1), parallel_threshold_(default_parallel_threshold)
+    {
+    }
+
+    size_t max_threads() const
+    {
+        return max_threads_;
+    }
+
+    query_options& max_threads(size_t value)
+    {
+        max_threads_ = value;
+        return *this;
+    }
+
+    size_t parallel_threshold() const
+    {
+        return parallel_threshold_;
+    }
+
+    query_options& parallel_threshold(size_t value)
+    {
+        parallel_threshold_ = value;
+        return *this;
+    }
+};
+
+template<class Json>
+Json json_query(const Json& root, const typename Json::string_view_type& path, result_type result_t, 
+                const query_options& options)
+{
+    std::vector<std::unique_ptr<Json>> temp_json_values;
+    if (result_t == result_type::value)
+    {
+        jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>,'$'> evaluator(options);
+        evaluator.evaluate(root, path, temp_json_values);
+        return evaluator.get_values();
+    }
+    else
+    {
+        jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::PathConstructor<Json>,'$'> evaluator(options);
+        evaluator.evaluate(root, path, temp_json_values);
+        return evaluator.get_normalized_paths();
+    }
+}
+
 template<class Json>
 Json json_query(const Json& root, const typename Json::string_view_type& path, result_type result_t = result_type::value)
+{
+    return json_query(root, path, result_t, query_options());
+}
+
+// Calls callback(path, value) for each value selected by path, passing a
+// reference to the value in root rather than a copy. path is the normalized
+// path of the value if result_t is result_type::path, otherwise empty.
+template<class Json, class Callback>
+void json_query_refs(const Json& root, const typename Json::string_view_type& path, Callback callback, 
+                     result_type result_t = result_type::value)
 {
     std::vector<std::unique_ptr<Json>> temp_json_values;
     if (result_t == result_type::value)
     {
         jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>,'$'> evaluator;
         evaluator.evaluate(root, path, temp_json_values);
-        return evaluator.get_values();
+        evaluator.visit(callback);
     }
     else
     {
         jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::PathConstructor<Json>,'$'> evaluator;
         evaluator.evaluate(root, path, temp_json_values);
-        return evaluator.get_normalized_paths();
+        evaluator.visit(callback);
     }
 }
 
@@ -143,493 +224,405 @@ enum class path_state
     dot
 };
 
-template<class Json,
-         class JsonReference,
-         class PathCons,
-         char PathStart>
-class jsonpath_evaluator : private serializing_context
+// Reductions of doubles held contiguously. They keep four independent 
+// partial results, so that compilers can use packed SIMD instructions.
+inline double sum_unrolled(const double* p, size_t n)
 {
-private:
-    typedef typename Json::char_type char_type;
-    typedef typename Json::char_traits_type char_traits_type;
-    typedef std::basic_string<char_type,char_traits_type> string_type;
-    typedef typename Json::string_view_type string_view_type;
-    typedef JsonReference reference;
-    using pointer = typename std::conditional<std::is_const<typename std::remove_reference<JsonReference>::type>::value,typename Json::const_pointer,typename Json::pointer>::type;
-
-    struct node_type
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
     {
-        node_type() = default;
-        node_type(const string_type& p, const pointer& valp)
-            : skip_contained_object(false),path(p),val_ptr(valp)
-        {
-        }
-        node_type(string_type&& p, pointer&& valp)
-            : skip_contained_object(false),path(std::move(p)),val_ptr(valp)
-        {
-        }
-        node_type(const node_type&) = default;
-        node_type(node_type&&) = default;
-
-        bool skip_contained_object;
-        string_type path;
-        pointer val_ptr;
-    };
-    typedef std::vector<node_type> node_set;
-
-    static string_view_type length_literal() 
+        s0 += p[i];
+        s1 += p[i+1];
+        s2 += p[i+2];
+        s3 += p[i+3];
+    }
+    for (; i < n; ++i)
     {
-        static const char_type data[] = {'l','e','n','g','t','h'};
-        return string_view_type{data,sizeof(data)/sizeof(char_type)};
+        s0 += p[i];
     }
+    return (s0 + s1) + (s2 + s3);
+}
 
-    class selector
+inline double sum_pairwise(const double* p, size_t n)
+{
+    const size_t block_size = 128;
+    if (n <= block_size)
     {
-    public:
-        virtual ~selector()
-        {
-        }
-        virtual void select(node_type& node, const string_type& path, reference val,
-                            node_set& nodes, std::vector<std::unique_ptr<Json>>& temp_json_values) = 0;
-    };
+        return sum_unrolled(p, n);
+    }
+    size_t half = n / 2;
+    return sum_pairwise(p, half) + sum_pairwise(p + half, n - half);
+}
 
-    class expr_selector final : public selector
+// Kahan-Babuska (Neumaier) compensated summation
+class compensated_sum
+{
+    double sum_;
+    double c_;
+public:
+    compensated_sum()
+        : sum_(0.0), c_(0.0)
     {
-    private:
-         jsonpath_filter_expr<Json> result_;
-    public:
-        expr_selector(const jsonpath_filter_expr<Json>& result)
-            : result_(result)
-        {
-        }
+    }
 
-        void select(node_type& node, const string_type& path, reference val, 
-                    node_set& nodes, std::vector<std::unique_ptr<Json>>& temp_json_values) override
+    void add(const double* p, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
         {
-            auto index = result_.eval(val, temp_json_values);
-            if (index.template is<size_t>())
+            double t = sum_ + p[i];
+            if (std::fabs(sum_) >= std::fabs(p[i]))
             {
-                size_t start = index.template as<size_t>();
-                if (val.is_array() && start < val.size())
-                {
-                    nodes.emplace_back(PathCons()(path,start),std::addressof(val[start]));
-                }
+                c_ += (sum_ - t) + p[i];
             }
-            else if (index.is_string())
+            else
             {
-                name_selector selector(index.as_string_view(),true);
-                selector.select(node, path, val, nodes, temp_json_values);
+                c_ += (p[i] - t) + sum_;
             }
+            sum_ = t;
         }
-    };
+    }
 
-    class filter_selector final : public selector
+    double value() const
     {
-    private:
-         jsonpath_filter_expr<Json> result_;
-    public:
-        filter_selector(const jsonpath_filter_expr<Json>& result)
-            : result_(result)
-        {
-        }
+        return sum_ + c_;
+    }
+};
 
-        void select(node_type& node, const string_type& path, reference val, 
-                    node_set& nodes, 
-                    std::vector<std::unique_ptr<Json>>& temp_json_values) override
-        {
-            if (val.is_array())
-            {
-                node.skip_contained_object =true;
-                for (size_t i = 0; i < val.size(); ++i)
-                {
-                    if (result_.exists(val[i], temp_json_values))
-                    {
-                        nodes.emplace_back(PathCons()(path,i),std::addressof(val[i]));
-                    }
-                }
-            }
-            else if (val.is_object())
-            {
-                if (!node.skip_contained_object)
-                {
-                    if (result_.exists(val, temp_json_values))
-                    {
-                        nodes.emplace_back(path, std::addressof(val));
-                    }
-                }
-                else
-                {
-                    node.skip_contained_object = false;
-                }
-            }
-        }
-    };
+inline double max_unrolled(const double* p, size_t n)
+{
+    double m0 = std::numeric_limits<double>::lowest();
+    double m1 = m0, m2 = m0, m3 = m0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        m0 = p[i] > m0 ? p[i] : m0;
+        m1 = p[i+1] > m1 ? p[i+1] : m1;
+        m2 = p[i+2] > m2 ? p[i+2] : m2;
+        m3 = p[i+3] > m3 ? p[i+3] : m3;
+    }
+    for (; i < n; ++i)
+    {
+        m0 = p[i] > m0 ? p[i] : m0;
+    }
+    m0 = m1 > m0 ? m1 : m0;
+    m2 = m3 > m2 ? m3 : m2;
+    return m2 > m0 ? m2 : m0;
+}
 
-    class name_selector final : public selector
+inline double min_unrolled(const double* p, size_t n)
+{
+    double m0 = (std::numeric_limits<double>::max)();
+    double m1 = m0, m2 = m0, m3 = m0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
     {
-    private:
-        string_type name_;
-        bool positive_start_;
-    public:
-        name_selector(const string_view_type& name, bool positive_start)
-            : name_(name), positive_start_(positive_start)
-        {
-        }
+        m0 = p[i] < m0 ? p[i] : m0;
+        m1 = p[i+1] < m1 ? p[i+1] : m1;
+        m2 = p[i+2] < m2 ? p[i+2] : m2;
+        m3 = p[i+3] < m3 ? p[i+3] : m3;
+    }
+    for (; i < n; ++i)
+    {
+        m0 = p[i] < m0 ? p[i] : m0;
+    }
+    m0 = m1 < m0 ? m1 : m0;
+    m2 = m3 < m2 ? m3 : m2;
+    return m2 < m0 ? m2 : m0;
+}
 
-        void select(node_type&, const string_type& path, reference val,
-                    node_set& nodes,
-                    std::vector<std::unique_ptr<Json>>& temp_json_values) override
+// Calls f(p, n) with the numeric values of nodes, converted to double and 
+// copied in order into a buffer of at most block_size doubles at a time
+template <class Json, class F>
+void for_each_block(const std::vector<const Json*>& nodes, F f)
+{
+    const size_t block_size = 128;
+    double block[block_size];
+    size_t i = 0;
+    while (i < nodes.size())
+    {
+        size_t n = (std::min)(block_size, nodes.size() - i);
+        for (size_t j = 0; j < n; ++j)
         {
-            if (val.is_object() && val.contains(name_))
-            {
-                nodes.emplace_back(PathCons()(path,name_),std::addressof(val.at(name_)));
-            }
-            else if (val.is_array())
-            {
-                size_t pos = 0;
-                if (try_string_to_index(name_.data(), name_.size(), &pos, &positive_start_))
-                {
-                    size_t index = positive_start_ ? pos : val.size() - pos;
-                    if (index < val.size())
-                    {
-                        nodes.emplace_back(PathCons()(path,index),std::addressof(val[index]));
-                    }
-                }
-                else if (name_ == length_literal() && val.size() > 0)
-                {
-                    auto temp = make_unique_ptr<Json>(val.size());
-                    nodes.emplace_back(PathCons()(path, name_), temp.get());
-                    temp_json_values.push_back(std::move(temp));
-                }
-            }
-            else if (val.is_string())
-            {
-                size_t pos = 0;
-                string_view_type sv = val.as_string_view();
-                if (try_string_to_index(name_.data(), name_.size(), &pos, &positive_start_))
-                {
-                    size_t index = positive_start_ ? pos : sv.size() - pos;
-                    auto sequence = unicons::sequence_at(sv.data(), sv.data() + sv.size(), index);
-                    if (sequence.length() > 0)
-                    {
-                        auto temp = make_unique_ptr<Json>(sequence.begin(),sequence.length());
-                        nodes.emplace_back(PathCons()(path, index), temp.get());
-                        temp_json_values.push_back(std::move(temp));
-                    }
-                }
-                else if (name_ == length_literal() && sv.size() > 0)
-                {
-                    size_t count = unicons::u32_length(sv.begin(),sv.end());
-                    auto temp = make_unique_ptr<Json>(count);
-                    nodes.emplace_back(PathCons()(path,name_),temp.get());
-                    temp_json_values.push_back(std::move(temp));
-                }
-            }
+            block[j] = nodes[i+j]->template as<double>();
         }
-    };
+        f(block, n);
+        i += n;
+    }
+}
 
-    class array_slice_selector final : public selector
-    {
-    private:
-        size_t start_;
-        bool positive_start_;
-        size_t end_;
-        bool positive_end_;
-        bool undefined_end_;
-        size_t step_;
-        bool positive_step_;
-    public:
-        array_slice_selector(size_t start, bool positive_start, 
-                             size_t end, bool positive_end,
-                             size_t step, bool positive_step,
-                             bool undefined_end)
-            : start_(start), positive_start_(positive_start),
-              end_(end), positive_end_(positive_end),undefined_end_(undefined_end),
-              step_(step), positive_step_(positive_step) 
-        {
-        }
+}
+
+enum class summation_kind {naive, pairwise, compensated};
 
-        void select(node_type&, const string_type& path, reference val,
-                    node_set& nodes,
-                    std::vector<std::unique_ptr<Json>>&) override
+// The sum of the numbers selected by the argument of a JSONPath function
+template <class Json>
+std::function<Json(const std::vector<const Json*>&)> sum_function(summation_kind kind = summation_kind::pairwise)
+{
+    return [kind](const std::vector<const Json*>& nodes)
+    {
+        switch (kind)
         {
-            if (positive_step_)
+            case summation_kind::naive:
             {
-                end_array_slice1(path, val, nodes);
+                double sum = 0.0;
+                detail::for_each_block(nodes, [&](const double* p, size_t n){sum += detail::sum_unrolled(p, n);});
+                return Json(sum);
             }
-            else
-            {
-                end_array_slice2(path, val, nodes);
-            }
-        }
-
-        void end_array_slice1(const string_type& path, reference val, node_set& nodes)
-        {
-            if (val.is_array())
+            case summation_kind::compensated:
             {
-                size_t start = positive_start_ ? start_ : val.size() - start_;
-                size_t end;
-                if (!undefined_end_)
-                {
-                    end = positive_end_ ? end_ : val.size() - end_;
-                }
-                else
-                {
-                    end = val.size();
-                }
-                for (size_t j = start; j < end; j += step_)
-                {
-                    if (j < val.size())
-                    {
-                        nodes.emplace_back(PathCons()(path,j),std::addressof(val[j]));
-                    }
-                }
+                detail::compensated_sum sum;
+                detail::for_each_block(nodes, [&](const double* p, size_t n){sum.add(p, n);});
+                return Json(sum.value());
             }
-        }
-
-        void end_array_slice2(const string_type& path, reference val, node_set& nodes)
-        {
-            if (val.is_array())
+            default:
             {
-                size_t start = positive_start_ ? start_ : val.size() - start_;
-                size_t end;
-                if (!undefined_end_)
-                {
-                    end = positive_end_ ? end_ : val.size() - end_;
-                }
-                else
-                {
-                    end = val.size();
-                }
-
-                size_t j = end + step_ - 1;
-                while (j > (start+step_-1))
-                {
-                    j -= step_;
-                    if (j < val.size())
-                    {
-                        nodes.emplace_back(PathCons()(path,j),std::addressof(val[j]));
-                    }
-                }
+                // The sums of the blocks are added pairwise
+                std::vector<double> partial_sums;
+                partial_sums.reserve(nodes.size()/128 + 1);
+                detail::for_each_block(nodes, [&](const double* p, size_t n){partial_sums.push_back(detail::sum_unrolled(p, n));});
+                return Json(detail::sum_pairwise(partial_sums.data(), partial_sums.size()));
             }
         }
     };
+}
 
-    class function_table
+// The arithmetic mean of the numbers selected by the argument of a JSONPath function, 
+// null if there are none
+template <class Json>
+std::function<Json(const std::vector<const Json*>&)> avg_function(summation_kind kind = summation_kind::pairwise)
+{
+    auto sum = sum_function<Json>(kind);
+    return [sum](const std::vector<const Json*>& nodes)
     {
-        typedef std::function<Json(const std::vector<pointer>&)> function_type;
-        typedef std::map<string_type,function_type> function_dictionary;
+        return nodes.size() > 0 ? Json(sum(nodes).template as<double>()/nodes.size()) : Json::null();
+    };
+}
 
-        const function_dictionary functions_ =
-        {
-            {
-                max_literal<char_type>(),[](const std::vector<pointer>& nodes)
-                      {
-                          double v = std::numeric_limits<double>::lowest();
-                          for (auto& node : nodes)
-                          {
-                              double x = node->template as<double>();
-                              if (x > v)
-                              {
-                                  v = x;
-                              }
-                          }
-                          return Json(v);
-                      }
-            },
-            {
-                min_literal<char_type>(),[](const std::vector<pointer>& nodes) 
-                      {
-                          std::vector<pointer> result;
-                          double v = (std::numeric_limits<double>::max)(); 
-                          for (const auto& node : nodes)
-                          {
-                              double x = node->template as<double>();
-                              if (x < v)
-                              {
-                                  v = x;
-                              }
-                          }
-                          return Json(v);
-                      }
-            },
-            {
-                avg_literal<char_type>(),[](const std::vector<pointer>& nodes)
-                      {
-                          double v = 0.0;
-                          for (const auto& node : nodes)
-                          {
-                              v += node->template as<double>();
-                          }
-                          return nodes.size() > 0 ? Json(v/nodes.size()) : Json::null();
-                      }
-            },
-            {
-                sum_literal<char_type>(),[](const std::vector<pointer>& nodes)
-                      {
-                          double v = 0.0;
-                          for (const auto& node : nodes)
-                          {
-                              v += node->template as<double>();
-                          }
-                          return Json(v);
-                      }
-            },
-            {
-                count_literal<char_type>(),[](const std::vector<pointer>& nodes)
-                      {
-                          size_t count = 0;
-                          while (count < nodes.size())
-                          {
-                              ++count;
-                          }
-                          return Json(count);
-                      }
-            },
-            {
-                prod_literal<char_type>(),[](const std::vector<pointer>& nodes)
-                      {
-                          double v = 0.0;
-                          for (const auto& node : nodes)
-                          {
-                              double x = node->template as<double>();
-                              v == 0.0 && x != 0.0
-                              ? (v = x)
-                              : (v *= x);
-
-                          }
-                          return Json(v);
-                      }
-            }
-        };
-    public:
+namespace detail {
 
-        typename function_dictionary::const_iterator find(const string_type& key) const
-        {
-            return functions_.find(key);
-        }
-        typename function_dictionary::const_iterator end() const
-        {
-            return functions_.end();
-        }
-    };
-    function_table functions_;
+// The functions that may be applied to a JSONPath expression, e.g. 
+// max($.store.book[*].price). One registry is shared by all expressions 
+// of a given Json type, functions are looked up when an expression is 
+// compiled.
+template <class Json>
+class function_table
+{
+public:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::string_type string_type;
+    typedef std::function<Json(const std::vector<const Json*>&)> function_type;
+    typedef std::map<string_type,function_type> function_dictionary;
+private:
+    mutable std::mutex mutex_;
+    function_dictionary functions_;
 
-    default_parse_error_handler default_err_handler_;
-    parse_error_handler *err_handler_;
-    path_state state_;
-    string_type buffer_;
-    size_t start_;
-    bool positive_start_;
-    size_t end_;
-    bool positive_end_;
-    bool undefined_end_;
-    size_t step_;
-    bool positive_step_;
-    bool recursive_descent_;
-    node_set nodes_;
-    std::vector<node_set> stack_;
-    size_t line_;
-    size_t column_;
-    const char_type* begin_input_;
-    const char_type* end_input_;
-    const char_type* p_;
-    std::vector<std::unique_ptr<selector>> selectors_;
+    function_table()
+    {
+        functions_.emplace(max_literal<char_type>(),[](const std::vector<const Json*>& nodes)
+                  {
+                      double v = std::numeric_limits<double>::lowest();
+                      for_each_block(nodes, [&](const double* p, size_t n)
+                                     {
+                                         double x = max_unrolled(p, n);
+                                         v = x > v ? x : v;
+                                     });
+                      return Json(v);
+                  });
+        functions_.emplace(min_literal<char_type>(),[](const std::vector<const Json*>& nodes)
+                  {
+                      double v = (std::numeric_limits<double>::max)();
+                      for_each_block(nodes, [&](const double* p, size_t n)
+                                     {
+                                         double x = min_unrolled(p, n);
+                                         v = x < v ? x : v;
+                                     });
+                      return Json(v);
+                  });
+        functions_.emplace(avg_literal<char_type>(), avg_function<Json>());
+        functions_.emplace(sum_literal<char_type>(), sum_function<Json>());
+        functions_.emplace(count_literal<char_type>(),[](const std::vector<const Json*>& nodes)
+                  {
+                      return Json(nodes.size());
+                  });
+        functions_.emplace(prod_literal<char_type>(),[](const std::vector<const Json*>& nodes)
+                  {
+                      double v = 0.0;
+                      for (const auto& node : nodes)
+                      {
+                          double x = node->template as<double>();
+                          v == 0.0 && x != 0.0
+                          ? (v = x)
+                          : (v *= x);
+                      }
+                      return Json(v);
+                  });
+    }
 
+    function_table(const function_table&) = delete;
+    function_table& operator=(const function_table&) = delete;
 public:
-    jsonpath_evaluator()
-        : err_handler_(&default_err_handler_),
-          state_(path_state::start),
-          start_(0), positive_start_(true), 
-          end_(0), positive_end_(true), undefined_end_(false),
-          step_(0), positive_step_(true),
-          recursive_descent_(false),
-          line_(0), column_(0),
-          begin_input_(nullptr), end_input_(nullptr),
-          p_(nullptr)
+    static function_table& instance()
     {
+        static function_table table;
+        return table;
     }
 
-    Json get_values() const
+    bool find(const string_type& name, function_type& f) const
     {
-        Json result = typename Json::array();
-
-        if (stack_.size() > 0)
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = functions_.find(name);
+        if (it == functions_.end())
         {
-            result.reserve(stack_.back().size());
-            for (const auto& p : stack_.back())
-            {
-                result.push_back(*(p.val_ptr));
-            }
+            return false;
         }
-        return result;
+        f = it->second;
+        return true;
     }
 
-    std::vector<pointer> get_pointers() const
+    void insert_or_assign(const string_type& name, function_type f)
     {
-        std::vector<pointer> result;
+        std::lock_guard<std::mutex> lock(mutex_);
+        functions_[name] = std::move(f);
+    }
+};
 
-        if (stack_.size() > 0)
-        {
-            result.reserve(stack_.back().size());
-            for (const auto& p : stack_.back())
-            {
-                result.push_back(p.val_ptr);
-            }
-        }
-        return result;
+enum class selector_kind {name, array_slice, expr, filter};
+
+// One of the comma separated selectors inside square brackets
+template <class Json>
+struct path_selector
+{
+    typedef typename Json::string_type string_type;
+
+    selector_kind kind;
+    string_type name;
+    size_t start;
+    bool positive_start;
+    size_t end;
+    bool positive_end;
+    bool undefined_end;
+    size_t step;
+    bool positive_step;
+    std::shared_ptr<const jsonpath_filter_expr<Json>> expr;
+
+    path_selector(const string_type& name)
+        : kind(selector_kind::name), name(name),
+          start(0), positive_start(true), end(0), positive_end(true), undefined_end(false),
+          step(1), positive_step(true)
+    {
     }
 
-    Json get_normalized_paths() const
+    path_selector(size_t start, bool positive_start,
+                  size_t end, bool positive_end,
+                  size_t step, bool positive_step,
+                  bool undefined_end)
+        : kind(selector_kind::array_slice),
+          start(start), positive_start(positive_start),
+          end(end), positive_end(positive_end), undefined_end(undefined_end),
+          step(step), positive_step(positive_step)
     {
-        Json result = typename Json::array();
-        if (stack_.size() > 0)
-        {
-            result.reserve(stack_.back().size());
-            for (const auto& p : stack_.back())
-            {
-                result.push_back(p.path);
-            }
-        }
-        return result;
     }
 
-    template <class T>
-    void replace(T&& new_value)
+    path_selector(selector_kind kind, jsonpath_filter_expr<Json>&& expr)
+        : kind(kind),
+          start(0), positive_start(true), end(0), positive_end(true), undefined_end(false),
+          step(1), positive_step(true),
+          expr(std::make_shared<jsonpath_filter_expr<Json>>(std::move(expr)))
     {
-        if (stack_.size() > 0)
-        {
-            for (size_t i = 0; i < stack_.back().size(); ++i)
-            {
-                *(stack_.back()[i].val_ptr) = new_value;
-            }
-        }
     }
+};
 
-    void evaluate(reference root, const string_view_type& path, std::vector<std::unique_ptr<Json>>& temp_json_values)
+enum class path_step_kind {name, wildcard, brackets};
+
+template <class Json>
+struct path_step
+{
+    typedef typename Json::string_type string_type;
+
+    path_step_kind kind;
+    bool recursive_descent;
+    string_type name;
+    bool wildcard;
+    std::vector<path_selector<Json>> selectors;
+
+    path_step(path_step_kind kind, bool recursive_descent)
+        : kind(kind), recursive_descent(recursive_descent), wildcard(false)
     {
-        std::error_code ec;
-        evaluate(root, path.data(), path.length(), temp_json_values, ec);
-        if (ec)
-        {
-            throw serialization_error(ec, line_, column_);
-        }
     }
+};
 
-    void evaluate(reference root, 
-                  const string_view_type& path, 
-                  std::vector<std::unique_ptr<Json>>& temp_json_values, 
-                  std::error_code& ec)
+enum class path_root_kind {none, node, function};
+
+// The result of parsing a JSONPath expression, a sequence of steps applied
+// in turn to the root node set. Immutable once built.
+template <class Json>
+class compiled_path
+{
+public:
+    typedef typename function_table<Json>::function_type function_type;
+
+    path_root_kind root_kind;
+    function_type function;
+    std::shared_ptr<const compiled_path<Json>> argument;
+    std::vector<path_step<Json>> steps;
+
+    compiled_path()
+        : root_kind(path_root_kind::none)
     {
-        evaluate(root, path.data(), path.length(), temp_json_values, ec);
     }
+};
 
-    void evaluate(reference root, 
-                  const char_type* path, 
-                  size_t length,
-                  std::vector<std::unique_ptr<Json>>& temp_json_values,
-                  std::error_code& ec)
+template<class Json>
+class jsonpath_compiler : private serializing_context
+{
+private:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::char_traits_type char_traits_type;
+    typedef std::basic_string<char_type,char_traits_type> string_type;
+
+    default_parse_error_handler default_err_handler_;
+    parse_error_handler *err_handler_;
+    path_state state_;
+    string_type buffer_;
+    size_t start_;
+    bool positive_start_;
+    size_t end_;
+    bool positive_end_;
+    bool undefined_end_;
+    size_t step_;
+    bool positive_step_;
+    bool recursive_descent_;
+    bool wildcard_;
+    std::vector<path_selector<Json>> selectors_;
+    size_t line_;
+    size_t column_;
+    const char_type* begin_input_;
+    const char_type* end_input_;
+    const char_type* p_;
+
+public:
+    jsonpath_compiler()
+        : err_handler_(&default_err_handler_),
+          state_(path_state::start),
+          start_(0), positive_start_(true),
+          end_(0), positive_end_(true), undefined_end_(false),
+          step_(0), positive_step_(true),
+          recursive_descent_(false),
+          wildcard_(false),
+          line_(0), column_(0),
+          begin_input_(nullptr), end_input_(nullptr),
+          p_(nullptr)
+    {
+    }
+
+    std::shared_ptr<const compiled_path<Json>> compile(const char_type* path,
+                                                       size_t length,
+                                                       char_type path_start,
+                                                       std::error_code& ec)
     {
+        auto result = std::make_shared<compiled_path<Json>>();
+
         string_type function_name;
         path_state pre_line_break_state = path_state::start;
 
@@ -642,6 +635,8 @@ public:
         state_ = path_state::start;
 
         recursive_descent_ = false;
+        wildcard_ = false;
+        selectors_.clear();
 
         clear_index();
 
@@ -669,41 +664,29 @@ public:
                 column_ = 1;
                 state_ = pre_line_break_state;
                 break;
-            case path_state::start: 
-                switch (*p_)
+            case path_state::start:
+                if (*p_ == path_start)
                 {
-                    case ' ':case '\t':
-                        break;
-                    case PathStart:
-                    {
-                        string_type s;
-                        s.push_back(*p_);
-                        node_set v;
-                        v.emplace_back(std::move(s),std::addressof(root));
-                        stack_.push_back(v);
-
-                        state_ = path_state::expect_dot_or_left_bracket;
-                        break;
-                    }
-                    default:
+                    result->root_kind = path_root_kind::node;
+                    state_ = path_state::expect_dot_or_left_bracket;
+                }
+                else
+                {
+                    switch (*p_)
                     {
-                        switch (*p_)
-                        {
-                            case '.':
-                            case '[':
-                                err_handler_->fatal_error(jsonpath_errc::expected_root, *this);
-                                ec = jsonpath_errc::expected_root;
-                                return;
-                            default: // might be function, validate name later
-                                state_ = path_state::function_name;
-                                function_name.push_back(*p_);
-                                break;
-                        }
-                        break;
+                        case ' ':case '\t':
+                            break;
+                        case '.':
+                        case '[':
+                            err_handler_->fatal_error(jsonpath_errc::expected_root, *this);
+                            ec = jsonpath_errc::expected_root;
+                            return result;
+                        default: // might be function, validate name later
+                            state_ = path_state::function_name;
+                            function_name.push_back(*p_);
+                            break;
                     }
-
-                    return;
-                };
+                }
                 ++p_;
                 ++column_;
                 break;
@@ -725,28 +708,19 @@ public:
                 {
                 case ')':
                 {
-                    jsonpath_evaluator<Json,JsonReference,PathCons,'$'> evaluator;
-                    evaluator.evaluate(root, buffer_, temp_json_values, ec);
+                    jsonpath_compiler<Json> compiler;
+                    result->argument = compiler.compile(buffer_.data(), buffer_.length(), '$', ec);
                     if (ec)
                     {
-                        return;
+                        return result;
                     }
 
-                    auto it = functions_.find(function_name);
-                    if (it == functions_.end())
+                    if (!function_table<Json>::instance().find(function_name, result->function))
                     {
                         ec = jsonpath_errc::invalid_filter_unsupported_operator;
-                        return;
+                        return result;
                     }
-                    auto result = it->second(evaluator.get_pointers());
-
-                    string_type s;
-                    s.push_back(PathStart);
-                    node_set v;
-                    auto temp = make_unique_ptr<Json>(std::move(result));
-                    v.emplace_back(std::move(s),temp.get());
-                    temp_json_values.push_back(std::move(temp));
-                    stack_.push_back(v);
+                    result->root_kind = path_root_kind::function;
 
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
@@ -778,10 +752,10 @@ public:
                 case '.':
                     err_handler_->fatal_error(jsonpath_errc::expected_name, *this);
                     ec = jsonpath_errc::expected_name;
-                    return;
+                    return result;
                 case '*':
-                    end_all();
-                    transfer_nodes();
+                    result->steps.emplace_back(path_step_kind::wildcard, false);
+                    recursive_descent_ = false;
                     state_ = path_state::expect_dot_or_left_bracket;
                     ++p_;
                     ++column_;
@@ -797,7 +771,7 @@ public:
                     break;
                 }
                 break;
-            case path_state::expect_dot_or_left_bracket: 
+            case path_state::expect_dot_or_left_bracket:
                 switch (*p_)
                 {
                 case ' ':case '\t':
@@ -811,7 +785,7 @@ public:
                 default:
                     err_handler_->fatal_error(jsonpath_errc::expected_separator, *this);
                     ec = jsonpath_errc::expected_separator;
-                    return;
+                    return result;
                 };
                 ++p_;
                 ++column_;
@@ -823,7 +797,7 @@ public:
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    apply_selectors(temp_json_values);
+                    add_brackets(*result);
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 case ' ':case '\t':
@@ -831,7 +805,7 @@ public:
                 default:
                     err_handler_->fatal_error(jsonpath_errc::expected_right_bracket, *this);
                     ec = jsonpath_errc::expected_right_bracket;
-                    return;
+                    return result;
                 }
                 ++p_;
                 ++column_;
@@ -846,23 +820,23 @@ public:
                 case '(':
                     {
                         jsonpath_filter_parser<Json> parser(line_,column_);
-                        auto result = parser.parse(root, p_,end_input_,&p_, temp_json_values);
+                        auto expr = parser.parse(p_,end_input_,&p_);
                         line_ = parser.line();
                         column_ = parser.column();
-                        selectors_.push_back(make_unique_ptr<expr_selector>(result));
+                        selectors_.emplace_back(selector_kind::expr, std::move(expr));
                         state_ = path_state::expect_comma_or_right_bracket;
                     }
                     break;
                 case '?':
                     {
                         jsonpath_filter_parser<Json> parser(line_,column_);
-                        auto result = parser.parse(root,p_,end_input_,&p_, temp_json_values);
+                        auto expr = parser.parse(p_,end_input_,&p_);
                         line_ = parser.line();
                         column_ = parser.column();
-                        selectors_.push_back(make_unique_ptr<filter_selector>(result));
+                        selectors_.emplace_back(selector_kind::filter, std::move(expr));
                         state_ = path_state::expect_comma_or_right_bracket;
                     }
-                    break;                   
+                    break;
                 case ':':
                     clear_index();
                     state_ = path_state::left_bracket_end;
@@ -870,7 +844,7 @@ public:
                     ++column_;
                     break;
                 case '*':
-                    end_all();
+                    wildcard_ = true;
                     state_ = path_state::expect_comma_or_right_bracket;
                     ++p_;
                     ++column_;
@@ -902,19 +876,19 @@ public:
                     {
                         err_handler_->fatal_error(jsonpath_errc::expected_index, *this);
                         ec = jsonpath_errc::expected_index;
-                        return;
+                        return result;
                     }
                     state_ = path_state::left_bracket_end;
                     break;
                 case ',':
-                    selectors_.push_back(make_unique_ptr<name_selector>(buffer_,positive_start_));
+                    selectors_.emplace_back(buffer_);
                     buffer_.clear();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(make_unique_ptr<name_selector>(buffer_,positive_start_));
+                    selectors_.emplace_back(buffer_);
                     buffer_.clear();
-                    apply_selectors(temp_json_values);
+                    add_brackets(*result);
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 default:
@@ -941,12 +915,12 @@ public:
                     state_ = path_state::left_bracket_end2;
                     break;
                 case ',':
-                    selectors_.push_back(make_unique_ptr<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
+                    add_array_slice();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(make_unique_ptr<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
-                    apply_selectors(temp_json_values);
+                    add_array_slice();
+                    add_brackets(*result);
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 }
@@ -965,12 +939,12 @@ public:
                     end_ = end_*10 + static_cast<size_t>(*p_-'0');
                     break;
                 case ',':
-                    selectors_.push_back(make_unique_ptr<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
+                    add_array_slice();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(make_unique_ptr<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
-                    apply_selectors(temp_json_values);
+                    add_array_slice();
+                    add_brackets(*result);
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 }
@@ -989,12 +963,12 @@ public:
                     state_ = path_state::left_bracket_step2;
                     break;
                 case ',':
-                    selectors_.push_back(make_unique_ptr<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
+                    add_array_slice();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(make_unique_ptr<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
-                    apply_selectors(temp_json_values);
+                    add_array_slice();
+                    add_brackets(*result);
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 }
@@ -1008,46 +982,41 @@ public:
                     step_ = step_*10 + static_cast<size_t>(*p_-'0');
                     break;
                 case ',':
-                    selectors_.push_back(make_unique_ptr<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
+                    add_array_slice();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(make_unique_ptr<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
-                    apply_selectors(temp_json_values);
+                    add_array_slice();
+                    add_brackets(*result);
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 }
                 ++p_;
                 ++column_;
                 break;
-            case path_state::unquoted_name: 
+            case path_state::unquoted_name:
                 switch (*p_)
                 {
                 case '[':
-                    apply_unquoted_string(buffer_, temp_json_values);
-                    transfer_nodes();
+                    add_name(*result);
                     start_ = 0;
                     state_ = path_state::left_bracket;
                     break;
                 case '.':
-                    apply_unquoted_string(buffer_, temp_json_values);
-                    transfer_nodes();
+                    add_name(*result);
                     state_ = path_state::dot;
                     break;
                 case ' ':case '\t':
-                    apply_unquoted_string(buffer_, temp_json_values);
-                    transfer_nodes();
+                    add_name(*result);
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 case '\r':
-                    apply_unquoted_string(buffer_, temp_json_values);
-                    transfer_nodes();
+                    add_name(*result);
                     pre_line_break_state = path_state::expect_dot_or_left_bracket;
                     state_= path_state::cr;
                     break;
                 case '\n':
-                    apply_unquoted_string(buffer_, temp_json_values);
-                    transfer_nodes();
+                    add_name(*result);
                     pre_line_break_state = path_state::expect_dot_or_left_bracket;
                     state_= path_state::lf;
                     break;
@@ -1058,11 +1027,11 @@ public:
                 ++p_;
                 ++column_;
                 break;
-            case path_state::left_bracket_single_quoted_string: 
+            case path_state::left_bracket_single_quoted_string:
                 switch (*p_)
                 {
                 case '\'':
-                    selectors_.push_back(make_unique_ptr<name_selector>(buffer_,positive_start_));
+                    selectors_.emplace_back(buffer_);
                     buffer_.clear();
                     state_ = path_state::expect_comma_or_right_bracket;
                     break;
@@ -1082,11 +1051,11 @@ public:
                 ++p_;
                 ++column_;
                 break;
-            case path_state::left_bracket_double_quoted_string: 
+            case path_state::left_bracket_double_quoted_string:
                 switch (*p_)
                 {
                 case '\"':
-                    selectors_.push_back(make_unique_ptr<name_selector>(buffer_,positive_start_));
+                    selectors_.emplace_back(buffer_);
                     buffer_.clear();
                     state_ = path_state::expect_comma_or_right_bracket;
                     break;
@@ -1114,17 +1083,29 @@ public:
         }
         switch (state_)
         {
-        case path_state::unquoted_name: 
+        case path_state::unquoted_name:
             {
-                apply_unquoted_string(buffer_, temp_json_values);
-                transfer_nodes();
+                add_name(*result);
             }
             break;
         default:
             break;
         }
+        return result;
+    }
+
+    size_t line_number() const override
+    {
+        return line_;
+    }
+
+    size_t column_number() const override
+    {
+        return column_;
     }
 
+private:
+
     void clear_index()
     {
         buffer_.clear();
@@ -1137,180 +1118,1159 @@ public:
         positive_step_ = true;
     }
 
-    void end_all()
+    void add_name(compiled_path<Json>& path)
     {
-        for (size_t i = 0; i < stack_.back().size(); ++i)
-        {
-            const auto& path = stack_.back()[i].path;
-            pointer p = stack_.back()[i].val_ptr;
-
-            if (p->is_array())
-            {
-                for (auto it = p->array_range().begin(); it != p->array_range().end(); ++it)
-                {
-                    nodes_.emplace_back(PathCons()(path,it - p->array_range().begin()),std::addressof(*it));
-                }
-            }
-            else if (p->is_object())
-            {
-                for (auto it = p->object_range().begin(); it != p->object_range().end(); ++it)
-                {
-                    nodes_.emplace_back(PathCons()(path,it->key()),std::addressof(it->value()));
-                }
-            }
+        path.steps.emplace_back(path_step_kind::name, recursive_descent_);
+        path.steps.back().name = buffer_;
+        buffer_.clear();
+        recursive_descent_ = false;
+    }
 
-        }
-        start_ = 0;
+    void add_array_slice()
+    {
+        selectors_.emplace_back(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_);
     }
 
-    void apply_unquoted_string(const string_view_type& name, std::vector<std::unique_ptr<Json>>& temp_json_values)
+    void add_brackets(compiled_path<Json>& path)
     {
-        if (name.length() > 0)
-        {
-            for (size_t i = 0; i < stack_.back().size(); ++i)
-            {
-                apply_unquoted_string(stack_.back()[i].path, *(stack_.back()[i].val_ptr), name, temp_json_values);
-            }
-        }
-        buffer_.clear();
+        path.steps.emplace_back(path_step_kind::brackets, recursive_descent_);
+        path.steps.back().wildcard = wildcard_;
+        path.steps.back().selectors = std::move(selectors_);
+        selectors_.clear();
+        wildcard_ = false;
+        recursive_descent_ = false;
     }
+};
+
+template<class Json,
+         class JsonReference,
+         class PathCons,
+         char PathStart>
+class jsonpath_evaluator
+{
+private:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::char_traits_type char_traits_type;
+    typedef std::basic_string<char_type,char_traits_type> string_type;
+    typedef typename Json::string_view_type string_view_type;
+    typedef JsonReference reference;
+    using pointer = typename std::conditional<std::is_const<typename std::remove_reference<JsonReference>::type>::value,typename Json::const_pointer,typename Json::pointer>::type;
 
-    void apply_unquoted_string(const string_type& path, reference val, const string_view_type& name, std::vector<std::unique_ptr<Json>>& temp_json_values)
+    struct node_type
     {
-        if (val.is_object())
-        {
-            if (val.contains(name))
-            {
-                nodes_.emplace_back(PathCons()(path,name),std::addressof(val.at(name)));
-            }
-            if (recursive_descent_)
-            {
-                for (auto it = val.object_range().begin(); it != val.object_range().end(); ++it)
-                {
-                    if (it->value().is_object() || it->value().is_array())
-                    {
-                        apply_unquoted_string(path, it->value(), name, temp_json_values);
-                    }
-                }
-            }
-        }
-        else if (val.is_array())
+        node_type() = default;
+        node_type(const string_type& p, const pointer& valp)
+            : skip_contained_object(false),path(p),val_ptr(valp)
         {
-            size_t pos = 0;
-            if (try_string_to_index(name.data(),name.size(),&pos, &positive_start_))
-            {
-                size_t index = positive_start_ ? pos : val.size() - pos;
-                if (index < val.size())
-                {
-                    nodes_.emplace_back(PathCons()(path,index),std::addressof(val[index]));
-                }
-            }
-            else if (name == length_literal() && val.size() > 0)
-            {
-                auto temp = make_unique_ptr<Json>(val.size());
-                nodes_.emplace_back(PathCons()(path,name),temp.get());
-                temp_json_values.emplace_back(std::move(temp));
-            }
-            if (recursive_descent_)
-            {
-                for (auto it = val.array_range().begin(); it != val.array_range().end(); ++it)
-                {
-                    if (it->is_object() || it->is_array())
-                    {
-                        apply_unquoted_string(path, *it, name, temp_json_values);
-                    }
-                }
-            }
         }
-        else if (val.is_string())
+        node_type(string_type&& p, pointer&& valp)
+            : skip_contained_object(false),path(std::move(p)),val_ptr(valp)
         {
-            string_view_type sv = val.as_string_view();
-            size_t pos = 0;
-            if (try_string_to_index(name.data(),name.size(),&pos, &positive_start_))
-            {
-                auto sequence = unicons::sequence_at(sv.data(), sv.data() + sv.size(), pos);
-                if (sequence.length() > 0)
-                {
-                    auto temp = make_unique_ptr<Json>(sequence.begin(),sequence.length());
-                    nodes_.emplace_back(PathCons()(path,pos),temp.get());
-                    temp_json_values.push_back(std::move(temp));
-                }
-            }
-            else if (name == length_literal() && sv.size() > 0)
-            {
-                size_t count = unicons::u32_length(sv.begin(),sv.end());
-                auto temp = make_unique_ptr<Json>(count);
-                nodes_.emplace_back(PathCons()(path,name),temp.get());
-                temp_json_values.push_back(std::move(temp));
-            }
         }
-    }
+        node_type(const node_type&) = default;
+        node_type(node_type&&) = default;
+
+        bool skip_contained_object;
+        string_type path;
+        pointer val_ptr;
+    };
+    typedef std::vector<node_type> node_set;
 
-    void apply_selectors(std::vector<std::unique_ptr<Json>>& temp_json_values)
+    static string_view_type length_literal()
     {
-        if (selectors_.size() > 0)
-        {
-            for (size_t i = 0; i < stack_.back().size(); ++i)
-            {
-                node_type& node = stack_.back()[i];
-                apply_selectors(node, node.path, *(node.val_ptr), temp_json_values);
-            }
-            selectors_.clear();
-        }
-        transfer_nodes();
+        static const char_type data[] = {'l','e','n','g','t','h'};
+        return string_view_type{data,sizeof(data)/sizeof(char_type)};
     }
 
-    void apply_selectors(node_type& node, const string_type& path, reference val,
-                         std::vector<std::unique_ptr<Json>>& temp_json_values)
-    {
-        for (const auto& selector : selectors_)
-        {
-            selector->select(node, path, val, nodes_, temp_json_values);
+    const Json* root_ptr_;
+    node_set nodes_;
+    node_set current_;
+    size_t line_;
+    size_t column_;
+    size_t max_threads_;
+    size_t parallel_threshold_;
+    const jsonpath_index<Json>* index_;
+
+public:
+    jsonpath_evaluator()
+        : root_ptr_(nullptr), line_(0), column_(0), 
+          max_threads_(1), parallel_threshold_(query_options::default_parallel_threshold),
+          index_(nullptr)
+    {
+    }
+
+    jsonpath_evaluator(const query_options& options)
+        : root_ptr_(nullptr), line_(0), column_(0), 
+          max_threads_(options.max_threads()), parallel_threshold_(options.parallel_threshold()),
+          index_(nullptr)
+    {
+    }
+
+    // Filters that compare an indexed key with a constant are answered from index
+    void use_index(const jsonpath_index<Json>* index)
+    {
+        index_ = index;
+    }
+
+    Json get_values() const
+    {
+        Json result = typename Json::array();
+
+        result.reserve(current_.size());
+        for (const auto& p : current_)
+        {
+            result.push_back(*(p.val_ptr));
+        }
+        return result;
+    }
+
+    std::vector<pointer> get_pointers() const
+    {
+        std::vector<pointer> result;
+
+        result.reserve(current_.size());
+        for (const auto& p : current_)
+        {
+            result.push_back(p.val_ptr);
+        }
+        return result;
+    }
+
+    Json get_normalized_paths() const
+    {
+        Json result = typename Json::array();
+        result.reserve(current_.size());
+        for (const auto& p : current_)
+        {
+            result.push_back(p.path);
+        }
+        return result;
+    }
+
+    // Calls callback(path, value) for each selected value, path is empty
+    // unless PathCons constructs normalized paths
+    template <class Callback>
+    void visit(Callback callback) const
+    {
+        for (const auto& p : current_)
+        {
+            callback(p.path, *(p.val_ptr));
+        }
+    }
+
+    template <class T>
+    void replace(T&& new_value)
+    {
+        for (size_t i = 0; i < current_.size(); ++i)
+        {
+            *(current_[i].val_ptr) = new_value;
+        }
+    }
+
+    void evaluate(reference root, const string_view_type& path, std::vector<std::unique_ptr<Json>>& temp_json_values)
+    {
+        std::error_code ec;
+        evaluate(root, path.data(), path.length(), temp_json_values, ec);
+        if (ec)
+        {
+            throw serialization_error(ec, line_, column_);
+        }
+    }
+
+    void evaluate(reference root,
+                  const string_view_type& path,
+                  std::vector<std::unique_ptr<Json>>& temp_json_values,
+                  std::error_code& ec)
+    {
+        evaluate(root, path.data(), path.length(), temp_json_values, ec);
+    }
+
+    void evaluate(reference root,
+                  const char_type* path,
+                  size_t length,
+                  std::vector<std::unique_ptr<Json>>& temp_json_values,
+                  std::error_code& ec)
+    {
+        jsonpath_compiler<Json> compiler;
+        auto compiled = compiler.compile(path, length, PathStart, ec);
+        line_ = compiler.line_number();
+        column_ = compiler.column_number();
+        if (ec)
+        {
+            return;
+        }
+        evaluate(root, *compiled, temp_json_values);
+    }
+
+    void evaluate(reference root,
+                  const compiled_path<Json>& path,
+                  std::vector<std::unique_ptr<Json>>& temp_json_values)
+    {
+        string_type root_path;
+        root_path.push_back(PathStart);
+        evaluate(root, path, root_path, temp_json_values);
+    }
+
+    // root_path is the path of root, normalized paths of selected nodes are
+    // built on it
+    void evaluate(reference root,
+                  const compiled_path<Json>& path,
+                  const string_type& root_path,
+                  std::vector<std::unique_ptr<Json>>& temp_json_values)
+    {
+        root_ptr_ = std::addressof(root);
+        nodes_.clear();
+        current_.clear();
+
+        switch (path.root_kind)
+        {
+            case path_root_kind::node:
+            {
+                current_.emplace_back(root_path,std::addressof(root));
+                break;
+            }
+            case path_root_kind::function:
+            {
+                jsonpath_evaluator<Json,const Json&,VoidPathConstructor<Json>,'$'> evaluator;
+                evaluator.evaluate(root, *path.argument, temp_json_values);
+                auto result = path.function(evaluator.get_pointers());
+
+                auto temp = make_unique_ptr<Json>(std::move(result));
+                current_.emplace_back(root_path,temp.get());
+                temp_json_values.push_back(std::move(temp));
+                break;
+            }
+            default:
+                return;
+        }
+
+        for (const auto& step : path.steps)
+        {
+            switch (step.kind)
+            {
+                case path_step_kind::name:
+                    apply_unquoted_string(step.name, step.recursive_descent, temp_json_values);
+                    break;
+                case path_step_kind::wildcard:
+                    end_all();
+                    break;
+                case path_step_kind::brackets:
+                    if (step.wildcard)
+                    {
+                        end_all();
+                    }
+                    apply_selectors(step.selectors, step.recursive_descent, temp_json_values);
+                    break;
+            }
+            transfer_nodes();
+        }
+    }
+
+    size_t line_number() const
+    {
+        return line_;
+    }
+
+    size_t column_number() const
+    {
+        return column_;
+    }
+
+private:
+
+    void end_all()
+    {
+        for (size_t i = 0; i < current_.size(); ++i)
+        {
+            const auto& path = current_[i].path;
+            pointer p = current_[i].val_ptr;
+
+            if (p->is_array())
+            {
+                for (auto it = p->array_range().begin(); it != p->array_range().end(); ++it)
+                {
+                    nodes_.emplace_back(PathCons()(path,it - p->array_range().begin()),std::addressof(*it));
+                }
+            }
+            else if (p->is_object())
+            {
+                for (auto it = p->object_range().begin(); it != p->object_range().end(); ++it)
+                {
+                    nodes_.emplace_back(PathCons()(path,it->key()),std::addressof(it->value()));
+                }
+            }
+
+        }
+    }
+
+    void apply_unquoted_string(const string_view_type& name, bool recursive_descent, std::vector<std::unique_ptr<Json>>& temp_json_values)
+    {
+        if (name.length() > 0)
+        {
+            for (size_t i = 0; i < current_.size(); ++i)
+            {
+                apply_unquoted_string(current_[i].path, *(current_[i].val_ptr), name, recursive_descent, temp_json_values);
+            }
+        }
+    }
+
+    void apply_unquoted_string(const string_type& path, reference val, const string_view_type& name, bool recursive_descent, std::vector<std::unique_ptr<Json>>& temp_json_values)
+    {
+        if (val.is_object())
+        {
+            if (val.contains(name))
+            {
+                nodes_.emplace_back(PathCons()(path,name),std::addressof(val.at(name)));
+            }
+            if (recursive_descent)
+            {
+                if (descend_in_parallel(val))
+                {
+                    descend_parallel(path, val, false, temp_json_values,
+                                     [&](jsonpath_evaluator& worker, const string_type& child_path, reference child, std::vector<std::unique_ptr<Json>>& temp)
+                                     {
+                                         worker.apply_unquoted_string(child_path, child, name, true, temp);
+                                     });
+                    return;
+                }
+                for (auto it = val.object_range().begin(); it != val.object_range().end(); ++it)
+                {
+                    if (it->value().is_object() || it->value().is_array())
+                    {
+                        apply_unquoted_string(path, it->value(), name, recursive_descent, temp_json_values);
+                    }
+                }
+            }
+        }
+        else if (val.is_array())
+        {
+            size_t pos = 0;
+            bool positive = true;
+            if (try_string_to_index(name.data(),name.size(),&pos, &positive))
+            {
+                size_t index = positive ? pos : val.size() - pos;
+                if (index < val.size())
+                {
+                    nodes_.emplace_back(PathCons()(path,index),std::addressof(val[index]));
+                }
+            }
+            else if (name == length_literal() && val.size() > 0)
+            {
+                auto temp = make_unique_ptr<Json>(val.size());
+                nodes_.emplace_back(PathCons()(path,name),temp.get());
+                temp_json_values.emplace_back(std::move(temp));
+            }
+            if (recursive_descent)
+            {
+                if (descend_in_parallel(val))
+                {
+                    descend_parallel(path, val, false, temp_json_values,
+                                     [&](jsonpath_evaluator& worker, const string_type& child_path, reference child, std::vector<std::unique_ptr<Json>>& temp)
+                                     {
+                                         worker.apply_unquoted_string(child_path, child, name, true, temp);
+                                     });
+                    return;
+                }
+                for (auto it = val.array_range().begin(); it != val.array_range().end(); ++it)
+                {
+                    if (it->is_object() || it->is_array())
+                    {
+                        apply_unquoted_string(path, *it, name, recursive_descent, temp_json_values);
+                    }
+                }
+            }
+        }
+        else if (val.is_string())
+        {
+            string_view_type sv = val.as_string_view();
+            size_t pos = 0;
+            bool positive = true;
+            if (try_string_to_index(name.data(),name.size(),&pos, &positive))
+            {
+                auto sequence = unicons::sequence_at(sv.data(), sv.data() + sv.size(), pos);
+                if (sequence.length() > 0)
+                {
+                    auto temp = make_unique_ptr<Json>(sequence.begin(),sequence.length());
+                    nodes_.emplace_back(PathCons()(path,pos),temp.get());
+                    temp_json_values.push_back(std::move(temp));
+                }
+            }
+            else if (name == length_literal() && sv.size() > 0)
+            {
+                size_t count = unicons::u32_length(sv.begin(),sv.end());
+                auto temp = make_unique_ptr<Json>(count);
+                nodes_.emplace_back(PathCons()(path,name),temp.get());
+                temp_json_values.push_back(std::move(temp));
+            }
+        }
+    }
+
+    void apply_selectors(const std::vector<path_selector<Json>>& selectors,
+                         bool recursive_descent,
+                         std::vector<std::unique_ptr<Json>>& temp_json_values)
+    {
+        if (selectors.size() > 0)
+        {
+            for (size_t i = 0; i < current_.size(); ++i)
+            {
+                node_type& node = current_[i];
+                apply_selectors(selectors, recursive_descent, node, node.path, *(node.val_ptr), temp_json_values);
+            }
+        }
+    }
+
+    void apply_selectors(const std::vector<path_selector<Json>>& selectors,
+                         bool recursive_descent,
+                         node_type& node, const string_type& path, reference val,
+                         std::vector<std::unique_ptr<Json>>& temp_json_values)
+    {
+        for (const auto& selector : selectors)
+        {
+            select(selector, node, path, val, temp_json_values);
+        }
+        if (recursive_descent)
+        {
+            // A filter selector carries state from one visited node to the next, 
+            // so it is only evaluated in document order on one thread
+            if (descend_in_parallel(val) && !has_filter(selectors))
+            {
+                descend_parallel(path, val, true, temp_json_values,
+                                 [&](jsonpath_evaluator& worker, const string_type& child_path, reference child, std::vector<std::unique_ptr<Json>>& temp)
+                                 {
+                                     node_type child_node(node);
+                                     worker.apply_selectors(selectors, true, child_node, child_path, child, temp);
+                                 });
+            }
+            else if (val.is_object())
+            {
+                for (auto& nvp : val.object_range())
+                {
+                    if (nvp.value().is_object() || nvp.value().is_array())
+                    {
+                        apply_selectors(selectors,recursive_descent,node,PathCons()(path,nvp.key()),nvp.value(), temp_json_values);
+                    }
+                }
+            }
+            else if (val.is_array())
+            {
+                for (auto& elem : val.array_range())
+                {
+                    if (elem.is_object() || elem.is_array())
+                    {
+                        apply_selectors(selectors,recursive_descent,node,path, elem, temp_json_values);
+                    }
+                }
+            }
+        }
+    }
+
+    void select(const path_selector<Json>& selector,
+                node_type& node, const string_type& path, reference val,
+                std::vector<std::unique_ptr<Json>>& temp_json_values)
+    {
+        switch (selector.kind)
+        {
+            case selector_kind::name:
+                select_name(selector.name, path, val, temp_json_values);
+                break;
+            case selector_kind::array_slice:
+                if (selector.positive_step)
+                {
+                    end_array_slice1(selector, path, val);
+                }
+                else
+                {
+                    end_array_slice2(selector, path, val);
+                }
+                break;
+            case selector_kind::expr:
+            {
+                auto index = selector.expr->eval(*root_ptr_, val, temp_json_values);
+                if (index.template is<size_t>())
+                {
+                    size_t start = index.template as<size_t>();
+                    if (val.is_array() && start < val.size())
+                    {
+                        nodes_.emplace_back(PathCons()(path,start),std::addressof(val[start]));
+                    }
+                }
+                else if (index.is_string())
+                {
+                    select_name(index.as_string_view(), path, val, temp_json_values);
+                }
+                break;
+            }
+            case selector_kind::filter:
+                if (val.is_array())
+                {
+                    node.skip_contained_object =true;
+                    if (index_ != nullptr)
+                    {
+                        std::vector<size_t> positions;
+                        if (index_->lookup(*selector.expr, val, positions))
+                        {
+                            for (size_t i : positions)
+                            {
+                                nodes_.emplace_back(PathCons()(path,i),std::addressof(val[i]));
+                            }
+                            break;
+                        }
+                    }
+                    for (size_t i = 0; i < val.size(); ++i)
+                    {
+                        if (selector.expr->exists(*root_ptr_, val[i], temp_json_values))
+                        {
+                            nodes_.emplace_back(PathCons()(path,i),std::addressof(val[i]));
+                        }
+                    }
+                }
+                else if (val.is_object())
+                {
+                    if (!node.skip_contained_object)
+                    {
+                        if (selector.expr->exists(*root_ptr_, val, temp_json_values))
+                        {
+                            nodes_.emplace_back(path, std::addressof(val));
+                        }
+                    }
+                    else
+                    {
+                        node.skip_contained_object = false;
+                    }
+                }
+                break;
+        }
+    }
+
+    void select_name(const string_view_type& name, const string_type& path, reference val,
+                     std::vector<std::unique_ptr<Json>>& temp_json_values)
+    {
+        if (val.is_object() && val.contains(name))
+        {
+            nodes_.emplace_back(PathCons()(path,name),std::addressof(val.at(name)));
+        }
+        else if (val.is_array())
+        {
+            size_t pos = 0;
+            bool positive = true;
+            if (try_string_to_index(name.data(), name.size(), &pos, &positive))
+            {
+                size_t index = positive ? pos : val.size() - pos;
+                if (index < val.size())
+                {
+                    nodes_.emplace_back(PathCons()(path,index),std::addressof(val[index]));
+                }
+            }
+            else if (name == length_literal() && val.size() > 0)
+            {
+                auto temp = make_unique_ptr<Json>(val.size());
+                nodes_.emplace_back(PathCons()(path, name), temp.get());
+                temp_json_values.push_back(std::move(temp));
+            }
+        }
+        else if (val.is_string())
+        {
+            size_t pos = 0;
+            bool positive = true;
+            string_view_type sv = val.as_string_view();
+            if (try_string_to_index(name.data(), name.size(), &pos, &positive))
+            {
+                size_t index = positive ? pos : sv.size() - pos;
+                auto sequence = unicons::sequence_at(sv.data(), sv.data() + sv.size(), index);
+                if (sequence.length() > 0)
+                {
+                    auto temp = make_unique_ptr<Json>(sequence.begin(),sequence.length());
+                    nodes_.emplace_back(PathCons()(path, index), temp.get());
+                    temp_json_values.push_back(std::move(temp));
+                }
+            }
+            else if (name == length_literal() && sv.size() > 0)
+            {
+                size_t count = unicons::u32_length(sv.begin(),sv.end());
+                auto temp = make_unique_ptr<Json>(count);
+                nodes_.emplace_back(PathCons()(path,name),temp.get());
+                temp_json_values.push_back(std::move(temp));
+            }
+        }
+    }
+
+    void end_array_slice1(const path_selector<Json>& selector, const string_type& path, reference val)
+    {
+        if (val.is_array())
+        {
+            size_t start = selector.positive_start ? selector.start : val.size() - selector.start;
+            size_t end;
+            if (!selector.undefined_end)
+            {
+                end = selector.positive_end ? selector.end : val.size() - selector.end;
+            }
+            else
+            {
+                end = val.size();
+            }
+            for (size_t j = start; j < end; j += selector.step)
+            {
+                if (j < val.size())
+                {
+                    nodes_.emplace_back(PathCons()(path,j),std::addressof(val[j]));
+                }
+            }
         }
-        if (recursive_descent_)
+    }
+
+    void end_array_slice2(const path_selector<Json>& selector, const string_type& path, reference val)
+    {
+        if (val.is_array())
         {
-            if (val.is_object())
+            size_t start = selector.positive_start ? selector.start : val.size() - selector.start;
+            size_t end;
+            if (!selector.undefined_end)
             {
-                for (auto& nvp : val.object_range())
+                end = selector.positive_end ? selector.end : val.size() - selector.end;
+            }
+            else
+            {
+                end = val.size();
+            }
+
+            size_t j = end + selector.step - 1;
+            while (j > (start+selector.step-1))
+            {
+                j -= selector.step;
+                if (j < val.size())
                 {
-                    if (nvp.value().is_object() || nvp.value().is_array())
-                    {                        
-                        apply_selectors(node,PathCons()(path,nvp.key()),nvp.value(), temp_json_values);
-                    }
+                    nodes_.emplace_back(PathCons()(path,j),std::addressof(val[j]));
                 }
             }
-            else if (val.is_array())
+        }
+    }
+
+    bool descend_in_parallel(reference val) const
+    {
+        return max_threads_ > 1 && std::is_const<typename std::remove_reference<JsonReference>::type>::value 
+               && (val.is_object() || val.is_array()) && val.size() >= parallel_threshold_ && val.size() > 1;
+    }
+
+    static bool has_filter(const std::vector<path_selector<Json>>& selectors)
+    {
+        for (const auto& selector : selectors)
+        {
+            if (selector.kind == selector_kind::filter)
             {
-                for (auto& elem : val.array_range())
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Applies apply(worker, child_path, child, temp) to the object and array 
+    // children of val, with the children divided into consecutive ranges that 
+    // are evaluated on separate threads by separate evaluators. The nodes 
+    // selected from each range are appended in order, so the result is the 
+    // same as a depth first traversal on one thread.
+    template <class Apply>
+    void descend_parallel(const string_type& path, reference val, bool extend_object_paths,
+                          std::vector<std::unique_ptr<Json>>& temp_json_values, Apply apply)
+    {
+        std::vector<std::pair<string_type,pointer>> children;
+        children.reserve(val.size());
+        if (val.is_object())
+        {
+            for (auto it = val.object_range().begin(); it != val.object_range().end(); ++it)
+            {
+                if (it->value().is_object() || it->value().is_array())
                 {
-                    if (elem.is_object() || elem.is_array())
-                    {
-                        apply_selectors(node,path, elem, temp_json_values);
-                    }
+                    children.emplace_back(extend_object_paths ? PathCons()(path,it->key()) : path, std::addressof(it->value()));
+                }
+            }
+        }
+        else
+        {
+            for (auto it = val.array_range().begin(); it != val.array_range().end(); ++it)
+            {
+                if (it->is_object() || it->is_array())
+                {
+                    children.emplace_back(path, std::addressof(*it));
+                }
+            }
+        }
+
+        struct partition
+        {
+            jsonpath_evaluator evaluator;
+            std::vector<std::unique_ptr<Json>> temp_json_values;
+            std::exception_ptr error;
+        };
+
+        size_t count = (std::min)(max_threads_, children.size());
+        std::vector<partition> partitions(count);
+        auto run = [&](size_t k)
+        {
+            partition& part = partitions[k];
+            part.evaluator.root_ptr_ = root_ptr_;
+            size_t first = k*children.size()/count;
+            size_t last = (k+1)*children.size()/count;
+            try
+            {
+                for (size_t i = first; i < last; ++i)
+                {
+                    apply(part.evaluator, children[i].first, *(children[i].second), part.temp_json_values);
                 }
             }
+            catch (...)
+            {
+                part.error = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(count);
+        for (size_t k = 1; k < count; ++k)
+        {
+            threads.emplace_back(run, k);
+        }
+        run(0);
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        for (auto& part : partitions)
+        {
+            if (part.error)
+            {
+                std::rethrow_exception(part.error);
+            }
+            for (auto& n : part.evaluator.nodes_)
+            {
+                nodes_.push_back(std::move(n));
+            }
+            for (auto& temp : part.temp_json_values)
+            {
+                temp_json_values.push_back(std::move(temp));
+            }
         }
     }
 
+    // The selected nodes become the input to the next step, the swap keeps
+    // the capacity of both node sets for later steps
     void transfer_nodes()
     {
-        stack_.push_back(nodes_);
+        current_.swap(nodes_);
         nodes_.clear();
-        recursive_descent_ = false;
     }
+};
 
-    size_t line_number() const override
+}
+
+// A hash index of the elements of the arrays selected by a path such as 
+// $.orders[*], keyed by the value of a path of names such as @.customer_id. 
+// A compiled expression that is evaluated with the index answers filters 
+// of the form [?(@.customer_id == 'X')] on those arrays from the index. 
+// The index refers to the elements of root, after root is modified it must 
+// be rebuilt, or cleared to stop it being used.
+template <class Json>
+class jsonpath_index
+{
+public:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::string_type string_type;
+    typedef typename Json::string_view_type string_view_type;
+private:
+    struct entry
     {
-        return line_;
+        size_t position;
+        const Json* key;
+    };
+    typedef std::unordered_map<size_t,std::vector<entry>> bucket_map;
+
+    const Json* root_;
+    std::shared_ptr<const detail::compiled_path<Json>> collection_path_;
+    std::vector<string_type> key_names_;
+    std::unordered_map<const Json*,bucket_map> containers_;
+    size_t size_;
+public:
+    jsonpath_index(const Json& root, 
+                   const string_view_type& collection_path, 
+                   const string_view_type& key_path)
+        : root_(std::addressof(root)), size_(0)
+    {
+        detail::jsonpath_compiler<Json> compiler;
+        std::error_code ec;
+        auto collection = compiler.compile(collection_path.data(), collection_path.length(), '$', ec);
+        if (ec)
+        {
+            throw serialization_error(ec, compiler.line_number(), compiler.column_number());
+        }
+        detail::jsonpath_compiler<Json> key_compiler;
+        auto key = key_compiler.compile(key_path.data(), key_path.length(), '@', ec);
+        if (ec)
+        {
+            throw serialization_error(ec, key_compiler.line_number(), key_compiler.column_number());
+        }
+        if (collection->root_kind != detail::path_root_kind::node || collection->steps.empty() 
+            || !is_wildcard(collection->steps.back()) || !names_of(*key, key_names_))
+        {
+            throw serialization_error(jsonpath_errc::unsupported_index_path);
+        }
+
+        // The path of the arrays is the collection path without its final [*]
+        auto containers = std::make_shared<detail::compiled_path<Json>>(*collection);
+        containers->steps.pop_back();
+        collection_path_ = containers;
+
+        rebuild();
     }
 
-    size_t column_number() const override
+    // Indexes root again, after it has been modified
+    void rebuild()
     {
-        return column_;
+        clear();
+        std::vector<std::unique_ptr<Json>> temp_json_values;
+        detail::jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>,'$'> evaluator;
+        evaluator.evaluate(*root_, *collection_path_, temp_json_values);
+        for (const Json* container : evaluator.get_pointers())
+        {
+            if (container->is_array() && containers_.find(container) == containers_.end())
+            {
+                bucket_map buckets;
+                if (index_elements(*container, buckets))
+                {
+                    containers_.emplace(container, std::move(buckets));
+                    size_ += container->size();
+                }
+            }
+        }
+    }
+
+    // Removes all entries, the index is not used until it is rebuilt
+    void clear()
+    {
+        containers_.clear();
+        size_ = 0;
+    }
+
+    // The number of array elements that are indexed
+    size_t size() const
+    {
+        return size_;
+    }
+
+    // If filter compares the indexed key with a constant and container is an 
+    // indexed array, sets positions to the indices of the elements that pass 
+    // the filter, in order, and returns true
+    bool lookup(const detail::jsonpath_filter_expr<Json>& filter, const Json& container, 
+                std::vector<size_t>& positions) const
+    {
+        auto it = containers_.find(std::addressof(container));
+        if (it == containers_.end())
+        {
+            return false;
+        }
+        const detail::compiled_path<Json>* path = nullptr;
+        const Json* value = nullptr;
+        std::vector<string_type> names;
+        if (!filter.path_equals_constant(path, value) || !names_of(*path, names) || names != key_names_)
+        {
+            return false;
+        }
+        auto bucket = it->second.find(hash_key(*value));
+        if (bucket != it->second.end())
+        {
+            for (const auto& e : bucket->second)
+            {
+                if (*(e.key) == *value)
+                {
+                    positions.push_back(e.position);
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    static bool is_wildcard(const detail::path_step<Json>& step)
+    {
+        return !step.recursive_descent 
+               && (step.kind == detail::path_step_kind::wildcard 
+                   || (step.kind == detail::path_step_kind::brackets && step.wildcard && step.selectors.empty()));
+    }
+
+    // The names of a path such as @.a.b or @['a']['b']
+    static bool names_of(const detail::compiled_path<Json>& path, std::vector<string_type>& names)
+    {
+        static const char_type length_data[] = {'l','e','n','g','t','h'};
+        string_view_type length_literal(length_data, sizeof(length_data)/sizeof(char_type));
+
+        if (path.root_kind != detail::path_root_kind::node || path.steps.empty())
+        {
+            return false;
+        }
+        for (const auto& step : path.steps)
+        {
+            if (step.recursive_descent)
+            {
+                return false;
+            }
+            if (step.kind == detail::path_step_kind::name)
+            {
+                names.push_back(step.name);
+            }
+            else if (step.kind == detail::path_step_kind::brackets && !step.wildcard 
+                     && step.selectors.size() == 1 && step.selectors[0].kind == detail::selector_kind::name)
+            {
+                names.push_back(step.selectors[0].name);
+            }
+            else
+            {
+                return false;
+            }
+            if (names.back().empty() || string_view_type(names.back()) == length_literal)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns false if a key of the array cannot be found without evaluating 
+    // the key path, e.g. it selects a character of a string
+    bool index_elements(const Json& container, bucket_map& buckets) const
+    {
+        for (size_t i = 0; i < container.size(); ++i)
+        {
+            const Json* key = std::addressof(container[i]);
+            for (size_t j = 0; key != nullptr && j < key_names_.size(); ++j)
+            {
+                const string_type& name = key_names_[j];
+                if (key->is_object())
+                {
+                    key = key->contains(name) ? std::addressof(key->at(name)) : nullptr;
+                }
+                else if (key->is_array())
+                {
+                    size_t pos = 0;
+                    bool positive = true;
+                    if (detail::try_string_to_index(name.data(), name.size(), &pos, &positive))
+                    {
+                        size_t index = positive ? pos : key->size() - pos;
+                        key = index < key->size() ? std::addressof((*key)[index]) : nullptr;
+                    }
+                    else
+                    {
+                        key = nullptr;
+                    }
+                }
+                else if (key->is_string())
+                {
+                    return false;
+                }
+                else
+                {
+                    key = nullptr;
+                }
+            }
+            if (key != nullptr)
+            {
+                buckets[hash_key(*key)].push_back(entry{i, key});
+            }
+        }
+        return true;
+    }
+
+    // Values that compare equal have the same hash, numbers are hashed by 
+    // their value as a double
+    static size_t hash_key(const Json& val)
+    {
+        uint64_t h = 14695981039346656037ULL;
+        auto mix = [&h](const uint8_t* p, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                h ^= p[i];
+                h *= 1099511628211ULL;
+            }
+        };
+        if (val.is_string())
+        {
+            auto sv = val.as_string_view();
+            mix(reinterpret_cast<const uint8_t*>(sv.data()), sv.size()*sizeof(char_type));
+        }
+        else if (val.is_int64() || val.is_uint64() || val.is_double())
+        {
+            double d = val.template as<double>();
+            if (d == 0.0)
+            {
+                d = 0.0;
+            }
+            uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            mix(reinterpret_cast<const uint8_t*>(&bits), sizeof(bits));
+            h ^= 1;
+        }
+        else if (val.is_bool())
+        {
+            h ^= val.as_bool() ? 2 : 3;
+        }
+        else if (val.is_null())
+        {
+            h ^= 4;
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+template <class Json>
+jsonpath_index<Json> build_index(const Json& root, 
+                                 const typename Json::string_view_type& collection_path, 
+                                 const typename Json::string_view_type& key_path)
+{
+    return jsonpath_index<Json>(root, collection_path, key_path);
+}
+
+// A JSONPath expression that has been parsed once and may be evaluated any
+// number of times, against different roots. Evaluation does not modify the
+// expression, so a single instance may be shared between threads.
+template <class Json>
+class jsonpath_expression
+{
+public:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::string_view_type string_view_type;
+private:
+    std::shared_ptr<const detail::compiled_path<Json>> path_;
+public:
+    jsonpath_expression(std::shared_ptr<const detail::compiled_path<Json>> path)
+        : path_(std::move(path))
+    {
+    }
+
+    Json evaluate(const Json& root, result_type result_t = result_type::value) const
+    {
+        return evaluate(root, result_t, query_options());
+    }
+
+    Json evaluate(const Json& root, result_type result_t, const query_options& options) const
+    {
+        std::vector<std::unique_ptr<Json>> temp_json_values;
+        if (result_t == result_type::value)
+        {
+            jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>,'$'> evaluator(options);
+            evaluator.evaluate(root, *path_, temp_json_values);
+            return evaluator.get_values();
+        }
+        else
+        {
+            jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::PathConstructor<Json>,'$'> evaluator(options);
+            evaluator.evaluate(root, *path_, temp_json_values);
+            return evaluator.get_normalized_paths();
+        }
+    }
+
+    // Filters on the arrays of index that compare the indexed key with a 
+    // constant are answered from index
+    Json evaluate(const Json& root, const jsonpath_index<Json>& index, result_type result_t = result_type::value) const
+    {
+        std::vector<std::unique_ptr<Json>> temp_json_values;
+        if (result_t == result_type::value)
+        {
+            jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>,'$'> evaluator;
+            evaluator.use_index(std::addressof(index));
+            evaluator.evaluate(root, *path_, temp_json_values);
+            return evaluator.get_values();
+        }
+        else
+        {
+            jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::PathConstructor<Json>,'$'> evaluator;
+            evaluator.use_index(std::addressof(index));
+            evaluator.evaluate(root, *path_, temp_json_values);
+            return evaluator.get_normalized_paths();
+        }
+    }
+
+    template <class Callback>
+    void evaluate_refs(const Json& root, Callback callback, result_type result_t = result_type::value) const
+    {
+        evaluate_refs(root, callback, result_t, query_options());
+    }
+
+    template <class Callback>
+    void evaluate_refs(const Json& root, const jsonpath_index<Json>& index, Callback callback, 
+                       result_type result_t = result_type::value) const
+    {
+        std::vector<std::unique_ptr<Json>> temp_json_values;
+        if (result_t == result_type::value)
+        {
+            jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>,'$'> evaluator;
+            evaluator.use_index(std::addressof(index));
+            evaluator.evaluate(root, *path_, temp_json_values);
+            evaluator.visit(callback);
+        }
+        else
+        {
+            jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::PathConstructor<Json>,'$'> evaluator;
+            evaluator.use_index(std::addressof(index));
+            evaluator.evaluate(root, *path_, temp_json_values);
+            evaluator.visit(callback);
+        }
+    }
+
+    template <class Callback>
+    void evaluate_refs(const Json& root, Callback callback, result_type result_t, const query_options& options) const
+    {
+        std::vector<std::unique_ptr<Json>> temp_json_values;
+        if (result_t == result_type::value)
+        {
+            jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>,'$'> evaluator(options);
+            evaluator.evaluate(root, *path_, temp_json_values);
+            evaluator.visit(callback);
+        }
+        else
+        {
+            jsoncons::jsonpath::detail::jsonpath_evaluator<Json,const Json&,detail::PathConstructor<Json>,'$'> evaluator(options);
+            evaluator.evaluate(root, *path_, temp_json_values);
+            evaluator.visit(callback);
+        }
     }
 
+    template <class T>
+    void replace(Json& root, T&& new_value) const
+    {
+        std::vector<std::unique_ptr<Json>> temp_json_values;
+        jsoncons::jsonpath::detail::jsonpath_evaluator<Json,Json&,detail::VoidPathConstructor<Json>,'$'> evaluator;
+        evaluator.evaluate(root, *path_, temp_json_values);
+        evaluator.replace(std::forward<T>(new_value));
+    }
 };
 
+// Makes a function available to JSONPath expressions compiled afterwards, 
+// replacing any function of the same name. Expressions that are already 
+// compiled keep the function they were compiled with.
+template <class Json>
+void register_function(const typename Json::string_view_type& name, 
+                       std::function<Json(const std::vector<const Json*>&)> f)
+{
+    detail::function_table<Json>::instance().insert_or_assign(typename Json::string_type(name.data(), name.length()), std::move(f));
+}
+
+template <class Json>
+jsonpath_expression<Json> compile(const typename Json::string_view_type& path, std::error_code& ec)
+{
+    jsoncons::jsonpath::detail::jsonpath_compiler<Json> compiler;
+    return jsonpath_expression<Json>(compiler.compile(path.data(), path.length(), '$', ec));
+}
+
+template <class Json>
+jsonpath_expression<Json> compile(const typename Json::string_view_type& path)
+{
+    std::error_code ec;
+    jsoncons::jsonpath::detail::jsonpath_compiler<Json> compiler;
+    auto compiled = compiler.compile(path.data(), path.length(), '$', ec);
+    if (ec)
+    {
+        throw serialization_error(ec, compiler.line_number(), compiler.column_number());
+    }
+    return jsonpath_expression<Json>(std::move(compiled));
 }
 
 }}
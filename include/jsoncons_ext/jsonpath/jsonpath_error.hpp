@@ -29,7 +29,8 @@ enum class jsonpath_errc
     expected_left_bracket_token = 12,
     unexpected_operator = 13,
     invalid_function_name = 14,
-    invalid_function_argument = 15
+    invalid_function_argument = 15,
+    unsupported_index_path = 16
 };
 
 class jsonpath_error_category_impl
@@ -70,6 +71,8 @@ public:
             return "Expected ?,',\",0-9,*";
         case jsonpath_errc::invalid_function_name:
             return "Invalid function name";
+        case jsonpath_errc::unsupported_index_path:
+            return "An index must be built on the elements of arrays selected with [*], keyed by a path of names";
         default:
             return "Unknown jsonpath parser error";
         }
@@ -12,6 +12,8 @@
 #include <vector>
 #include <memory>
 #include <regex>
+#include <list> // std::list
+#include <mutex> // std::mutex
 #include <functional>
 #include <cmath> 
 #include <limits> // std::numeric_limits
@@ -98,6 +100,12 @@ template <class Json,
           char PathStart>
 class jsonpath_evaluator;
 
+template <class Json>
+class compiled_path;
+
+template <class Json>
+class jsonpath_compiler;
+
 enum class filter_state
 {
     start,
@@ -133,12 +141,31 @@ class term
 {
 public:
     typedef typename Json::string_type string_type;
+    typedef typename Json::string_view_type string_view_type;
     typedef typename Json::char_type char_type;
 
     virtual ~term() {}
 
-    virtual void initialize(const Json&, std::vector<std::unique_ptr<Json>>&)
+    // Returns the term that takes the place of this one when evaluated
+    // against root and context_node, or null if this term is constant
+    virtual std::shared_ptr<term<Json>> resolve(const Json&, const Json&, std::vector<std::unique_ptr<Json>>&) const
+    {
+        return std::shared_ptr<term<Json>>();
+    }
+    // Whether the term depends on the root of the evaluation, e.g. a function of a '$' path
+    virtual bool references_root() const
+    {
+        return false;
+    }
+    // The path of a term that selects nodes relative to the current node, e.g. @.id
+    virtual const compiled_path<Json>* relative_path() const
     {
+        return nullptr;
+    }
+    // The value of a constant term
+    virtual const Json* constant() const
+    {
+        return nullptr;
     }
     virtual bool accept_single_node() const
     {
@@ -172,7 +199,7 @@ public:
     {
         throw serialization_error(jsonpath_errc::invalid_filter_unsupported_operator);
     }
-    virtual bool regex2(const string_type&) const
+    virtual bool regex2(const string_view_type&) const
     {
         throw serialization_error(jsonpath_errc::invalid_filter_unsupported_operator);
     }
@@ -269,12 +296,25 @@ struct operator_properties
     operator_type op;
 };
 
+// Matches the string value of val, or its JSON text if it is not a string, against a regex term
+template <class Json>
+bool regex_subject(const Json& val, const term<Json>& pattern)
+{
+    if (val.is_string())
+    {
+        return pattern.regex2(val.as_string_view());
+    }
+    typename Json::string_type s = val.as_string();
+    return pattern.regex2(s);
+}
+
 template <class Json>
 class token
 {
     token_type type_;
     size_t precedence_level_;
     bool is_right_associative_;
+    bool is_equality_;
     std::shared_ptr<term<Json>> operand_ptr_;
     std::function<Json(const term<Json>&)> unary_operator_;
     std::function<Json(const term<Json>&, const term<Json>&)> operator_;
@@ -282,22 +322,22 @@ public:
     typedef std::function<Json(const term<Json>&)> unary_operator_type;
     typedef std::function<Json(const term<Json>&, const term<Json>&)> operator_type;
 
-    Json operator()(const term<Json>& a)
+    Json operator()(const term<Json>& a) const
     {
         return unary_operator_(a);
     }
 
-    Json operator()(const term<Json>& a, const term<Json>& b)
+    Json operator()(const term<Json>& a, const term<Json>& b) const
     {
         return operator_(a,b);
     }
 
     token(token_type type)
-        : type_(type),precedence_level_(0),is_right_associative_(false)
+        : type_(type),precedence_level_(0),is_right_associative_(false),is_equality_(false)
     {
     }
     token(token_type type, std::shared_ptr<term<Json>> term_ptr)
-        : type_(type),precedence_level_(0),is_right_associative_(false),operand_ptr_(term_ptr)
+        : type_(type),precedence_level_(0),is_right_associative_(false),is_equality_(false),operand_ptr_(term_ptr)
     {
     }
     token(size_t precedence_level, 
@@ -306,13 +346,15 @@ public:
         : type_(token_type::unary_operator), 
           precedence_level_(precedence_level), 
           is_right_associative_(is_right_associative),
+          is_equality_(false),
           unary_operator_(unary_operator)
     {
     }
-    token(const operator_properties<Json>& properties)
+    token(const operator_properties<Json>& properties, bool is_equality = false)
         : type_(token_type::binary_operator), 
           precedence_level_(properties.precedence_level), 
           is_right_associative_(properties.is_right_associative),
+          is_equality_(is_equality),
           operator_(properties.op)
     {
     }
@@ -366,18 +408,39 @@ public:
         return is_right_associative_;
     }
 
+    // Whether the token is the == operator
+    bool is_equality() const
+    {
+        return is_equality_;
+    }
+
+    const term<Json>* operand_term() const
+    {
+        return operand_ptr_.get();
+    }
+
     const term<Json>& operand()
     {
         JSONCONS_ASSERT(type_ == token_type::operand && operand_ptr_ != nullptr);
         return *operand_ptr_;
     }
 
-    void initialize(const Json& context_node, std::vector<std::unique_ptr<Json>>& temp_json_values)
+    bool references_root() const
+    {
+        return operand_ptr_.get() != nullptr && operand_ptr_->references_root();
+    }
+
+    token<Json> resolve(const Json& root, const Json& context_node, std::vector<std::unique_ptr<Json>>& temp_json_values) const
     {
         if (operand_ptr_.get() != nullptr)
         {
-            operand_ptr_->initialize(context_node, temp_json_values);
+            auto resolved = operand_ptr_->resolve(root, context_node, temp_json_values);
+            if (resolved.get() != nullptr)
+            {
+                return token<Json>(token_type::operand, resolved);
+            }
         }
+        return *this;
     }
 };
 
@@ -527,6 +590,11 @@ public:
     {
     }
 
+    const Json* constant() const override
+    {
+        return std::addressof(value_);
+    }
+
     bool accept_single_node() const override
     {
         return value_.as_bool();
@@ -562,7 +630,7 @@ public:
     }
     bool regex_term(const term<Json>& rhs) const override
     {
-        return rhs.regex2(value_.as_string());
+        return regex_subject(value_, rhs);
     }
     bool ampamp_term(const term<Json>& rhs) const override
     {
@@ -652,43 +720,242 @@ public:
     }
 };
 
+// Compiled regular expressions shared by all filters, keyed by pattern and
+// flags. At most max_size expressions are kept, the least recently used 
+// one is dropped first.
+template <class CharT>
+class regex_cache
+{
+    typedef std::basic_string<CharT> string_type;
+    typedef std::basic_regex<CharT> regex_type;
+    typedef std::pair<string_type,unsigned> key_type;
+    typedef std::list<key_type> key_list;
+
+    struct entry
+    {
+        std::shared_ptr<const regex_type> regex;
+        typename key_list::iterator position;
+    };
+
+    std::mutex mutex_;
+    key_list recent_;
+    std::map<key_type,entry> entries_;
+
+    regex_cache() = default;
+    regex_cache(const regex_cache&) = delete;
+    regex_cache& operator=(const regex_cache&) = delete;
+public:
+    static const size_t max_size = 128;
+
+    static regex_cache& instance()
+    {
+        static regex_cache cache;
+        return cache;
+    }
+
+    // Throws std::regex_error if the pattern is invalid
+    std::shared_ptr<const regex_type> get(const string_type& pattern, std::regex::flag_type flags)
+    {
+        key_type key(pattern, static_cast<unsigned>(flags));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(key);
+            if (it != entries_.end())
+            {
+                recent_.splice(recent_.begin(), recent_, it->second.position);
+                return it->second.regex;
+            }
+        }
+
+        // Compiled without holding the lock
+        auto regex = std::make_shared<const regex_type>(pattern, flags);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end())
+        {
+            return it->second.regex;
+        }
+        recent_.push_front(key);
+        entry e;
+        e.regex = regex;
+        e.position = recent_.begin();
+        entries_.emplace(std::move(key), std::move(e));
+        while (entries_.size() > max_size)
+        {
+            entries_.erase(recent_.back());
+            recent_.pop_back();
+        }
+        return regex;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+};
+
+template <class CharT>
+const size_t regex_cache<CharT>::max_size;
+
+enum class literal_match {none, exact, prefix, suffix, contains};
+
+// Recognizes patterns that match a literal string exactly, as a prefix, 
+// as a suffix, or anywhere, e.g. "abc", "abc.*", ".*abc", ".*abc.*", 
+// optionally anchored with ^ and $, with \ escaping punctuation. 
+template <class CharT>
+literal_match parse_literal_pattern(const std::basic_string<CharT>& pattern, std::basic_string<CharT>& literal)
+{
+    auto is_special = [](CharT c) -> bool
+    {
+        switch (c)
+        {
+            case '\\':case '^':case '$':case '.':case '*':case '+':case '?':
+            case '(':case ')':case '[':case ']':case '{':case '}':case '|':case '/':case '-':
+                return true;
+            default:
+                return false;
+        }
+    };
+
+    literal.clear();
+    size_t i = 0;
+    size_t n = pattern.size();
+    if (i < n && pattern[i] == '^')
+    {
+        ++i;
+    }
+    bool leading_any = false;
+    if (i+1 < n && pattern[i] == '.' && pattern[i+1] == '*')
+    {
+        leading_any = true;
+        i += 2;
+    }
+    bool trailing_any = false;
+    while (i < n)
+    {
+        CharT c = pattern[i];
+        if (c == '\\')
+        {
+            if (i+1 < n && is_special(pattern[i+1]))
+            {
+                literal.push_back(pattern[i+1]);
+                i += 2;
+            }
+            else
+            {
+                return literal_match::none;
+            }
+        }
+        else if (c == '.' && i+1 < n && pattern[i+1] == '*' 
+                 && (i+2 == n || (i+3 == n && pattern[i+2] == '$')))
+        {
+            trailing_any = true;
+            break;
+        }
+        else if (c == '$' && i+1 == n)
+        {
+            break;
+        }
+        else if (is_special(c) && c != '-' && c != '/')
+        {
+            return literal_match::none;
+        }
+        else
+        {
+            literal.push_back(c);
+            ++i;
+        }
+    }
+    if (leading_any)
+    {
+        return trailing_any ? literal_match::contains : literal_match::suffix;
+    }
+    return trailing_any ? literal_match::prefix : literal_match::exact;
+}
+
+// Whether the ECMAScript . matches every character of s, i.e. s has no line terminators
+template <class CharT>
+bool dot_matches_all(const CharT* s, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (s[i] == '\n' || s[i] == '\r' || (sizeof(CharT) > 1 && (s[i] == 0x2028 || s[i] == 0x2029)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 template <class Json>
 class regex_term final : public term<Json>
 {
     typedef typename Json::char_type char_type;
     typedef typename Json::string_type string_type;
-    const std::basic_regex<char_type> pattern_;
+    typedef typename Json::string_view_type string_view_type;
+
+    literal_match literal_match_;
+    string_type literal_;
+    std::shared_ptr<const std::basic_regex<char_type>> pattern_;
 public:
     regex_term(const string_type& pattern, std::regex::flag_type flags)
-        : pattern_(pattern,flags)
+        : literal_match_(literal_match::none)
     {
+        if (!(flags & std::regex_constants::icase))
+        {
+            literal_match_ = parse_literal_pattern(pattern, literal_);
+        }
+        if (literal_match_ == literal_match::none)
+        {
+            pattern_ = regex_cache<char_type>::instance().get(pattern, flags);
+        }
     }
 
-    bool regex2(const string_type& subject) const override
+    bool regex2(const string_view_type& subject) const override
     {
-        return std::regex_match(subject, pattern_);
+        const char_type* s = subject.data();
+        size_t n = subject.size();
+        size_t m = literal_.size();
+        switch (literal_match_)
+        {
+            case literal_match::exact:
+                return n == m && string_view_type(s, n) == string_view_type(literal_);
+            case literal_match::prefix:
+                return n >= m && string_view_type(s, m) == string_view_type(literal_) 
+                       && dot_matches_all(s+m, n-m);
+            case literal_match::suffix:
+                return n >= m && string_view_type(s+(n-m), m) == string_view_type(literal_) 
+                       && dot_matches_all(s, n-m);
+            case literal_match::contains:
+            {
+                if (!dot_matches_all(s, n))
+                {
+                    return false;
+                }
+                return subject.find(literal_.data(), 0, m) != string_view_type::npos;
+            }
+            default:
+                return std::regex_match(s, s+n, *pattern_);
+        }
     }
 };
 
+// The nodes selected by a path, held as pointers into the document being
+// evaluated or into the evaluation's temporary values
 template <class Json>
-class path_term final : public term<Json>
+class node_set_term final : public term<Json>
 {
-    typedef typename Json::string_type string_type;
-
-    string_type path_;
-    Json nodes_;
+    std::vector<const Json*> nodes_;
 public:
-    path_term(const string_type& path)
-        : path_(path)
+    node_set_term()
     {
     }
 
-    void initialize(const Json& context_node,
-        std::vector<std::unique_ptr<Json>>& temp_json_values) override
+    node_set_term(std::vector<const Json*>&& nodes)
+        : nodes_(std::move(nodes))
     {
-        jsonpath_evaluator<Json,const Json&,VoidPathConstructor<Json>,'@'> evaluator;
-        evaluator.evaluate(context_node, path_, temp_json_values);
-        nodes_ = evaluator.get_values();
     }
 
     bool accept_single_node() const override
@@ -698,7 +965,17 @@ public:
 
     Json evaluate_single_node() const override
     {
-        return nodes_.size() == 1 ? nodes_[0] : nodes_;
+        if (nodes_.size() == 1)
+        {
+            return *nodes_[0];
+        }
+        Json result = typename Json::array();
+        result.reserve(nodes_.size());
+        for (auto p : nodes_)
+        {
+            result.push_back(*p);
+        }
+        return result;
     }
 
     bool exclaim() const override
@@ -714,7 +991,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = rhs.eq(nodes_[i]);
+                result = rhs.eq(*nodes_[i]);
             }
         }
         return result;
@@ -728,7 +1005,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = nodes_[i] == rhs;
+                result = *nodes_[i] == rhs;
             }
         }
         return result;
@@ -742,7 +1019,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = rhs.ne(nodes_[i]);
+                result = rhs.ne(*nodes_[i]);
             }
         }
         return result;
@@ -756,7 +1033,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = nodes_[i] != rhs;
+                result = *nodes_[i] != rhs;
             }
         }
         return result;
@@ -769,7 +1046,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = rhs.regex2(nodes_[i].as_string());
+                result = regex_subject(*nodes_[i], rhs);
             }
         }
         return result;
@@ -782,7 +1059,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = rhs.ampamp(nodes_[i]);
+                result = rhs.ampamp(*nodes_[i]);
             }
         }
         return result;
@@ -795,7 +1072,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = jsoncons::jsonpath::detail::ampamp(nodes_[i],rhs);
+                result = jsoncons::jsonpath::detail::ampamp(*nodes_[i],rhs);
             }
         }
         return result;
@@ -808,7 +1085,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = rhs.pipepipe(nodes_[i]);
+                result = rhs.pipepipe(*nodes_[i]);
             }
         }
         return result;
@@ -821,7 +1098,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = jsoncons::jsonpath::detail::pipepipe(nodes_[i],rhs);
+                result = jsoncons::jsonpath::detail::pipepipe(*nodes_[i],rhs);
             }
         }
         return result;
@@ -835,7 +1112,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = jsoncons::jsonpath::detail::lt(nodes_[i],rhs);
+                result = jsoncons::jsonpath::detail::lt(*nodes_[i],rhs);
             }
         }
         return result;
@@ -849,7 +1126,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = rhs.gt(nodes_[i]);
+                result = rhs.gt(*nodes_[i]);
             }
         }
         return result;
@@ -863,7 +1140,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = jsoncons::jsonpath::detail::gt(nodes_[i],rhs);
+                result = jsoncons::jsonpath::detail::gt(*nodes_[i],rhs);
             }
         }
         return result;
@@ -877,7 +1154,7 @@ public:
             result = true;
             for (size_t i = 0; result && i < nodes_.size(); ++i)
             {
-                result = rhs.lt(nodes_[i]);
+                result = rhs.lt(*nodes_[i]);
             }
         }
         return result;
@@ -886,77 +1163,127 @@ public:
     Json minus_term(const term<Json>& rhs) const override
     {
         static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? rhs.left_minus(nodes_[0]) : a_null;
+        return nodes_.size() == 1 ? rhs.left_minus(*nodes_[0]) : a_null;
     }
     Json minus(const Json& rhs) const override
     {
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::minus(nodes_[0],rhs) : Json(jsoncons::null_type());
+        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::minus(*nodes_[0],rhs) : Json(jsoncons::null_type());
     }
 
     Json left_minus(const Json& lhs) const override
     {
         static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::minus(lhs,nodes_[0]) : a_null;
+        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::minus(lhs,*nodes_[0]) : a_null;
     }
 
     Json unary_minus() const override
     {
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::unary_minus(nodes_[0]) : Json::null();
+        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::unary_minus(*nodes_[0]) : Json::null();
     }
 
     Json plus_term(const term<Json>& rhs) const override
     {
         static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? rhs.plus(nodes_[0]) : a_null;
+        return nodes_.size() == 1 ? rhs.plus(*nodes_[0]) : a_null;
     }
     Json plus(const Json& rhs) const override
     {
         static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::plus(nodes_[0],rhs) : a_null;
+        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::plus(*nodes_[0],rhs) : a_null;
     }
 
     Json mult_term(const term<Json>& rhs) const override
     {
         static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? rhs.mult(nodes_[0]) : a_null;
+        return nodes_.size() == 1 ? rhs.mult(*nodes_[0]) : a_null;
     }
     Json mult(const Json& rhs) const override
     {
         static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::mult(nodes_[0],rhs) : a_null;
+        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::mult(*nodes_[0],rhs) : a_null;
     }
 
     Json div_term(const term<Json>& rhs) const override
     {
         static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? rhs.left_div(nodes_[0]) : a_null;
+        return nodes_.size() == 1 ? rhs.left_div(*nodes_[0]) : a_null;
     }
     Json div(const Json& rhs) const override
     {
         static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::div(nodes_[0],rhs) : a_null;
+        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::div(*nodes_[0],rhs) : a_null;
     }
 
     Json left_div(const Json& lhs) const override
     {
         static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::div(lhs, nodes_[0]) : a_null;
+        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::div(lhs, *nodes_[0]) : a_null;
     }
 };
 
 template <class Json>
-token<Json> evaluate(const Json& context, std::vector<token<Json>>& tokens, std::vector<std::unique_ptr<Json>>& temp_json_values)
+class path_term final : public term<Json>
 {
-    for (auto it= tokens.begin(); it != tokens.end(); ++it)
+    std::shared_ptr<const compiled_path<Json>> path_;
+public:
+    path_term(std::shared_ptr<const compiled_path<Json>> path)
+        : path_(std::move(path))
+    {
+    }
+
+    const compiled_path<Json>* relative_path() const override
+    {
+        return path_.get();
+    }
+
+    std::shared_ptr<term<Json>> resolve(const Json&, const Json& context_node,
+                                        std::vector<std::unique_ptr<Json>>& temp_json_values) const override
     {
-        it->initialize(context, temp_json_values);
+        jsonpath_evaluator<Json,const Json&,VoidPathConstructor<Json>,'@'> evaluator;
+        evaluator.evaluate(context_node, *path_, temp_json_values);
+        return std::make_shared<node_set_term<Json>>(evaluator.get_pointers());
     }
+};
+
+// A function of a path, e.g. max($.store.book[*].price), evaluated against the root
+template <class Json>
+class function_term final : public term<Json>
+{
+    std::shared_ptr<const compiled_path<Json>> path_;
+public:
+    function_term(std::shared_ptr<const compiled_path<Json>> path)
+        : path_(std::move(path))
+    {
+    }
+
+    bool references_root() const override
+    {
+        return true;
+    }
+
+    std::shared_ptr<term<Json>> resolve(const Json& root, const Json&,
+                                        std::vector<std::unique_ptr<Json>>& temp_json_values) const override
+    {
+        jsonpath_evaluator<Json,const Json&,VoidPathConstructor<Json>,'$'> evaluator;
+        evaluator.evaluate(root, *path_, temp_json_values);
+        auto result = evaluator.get_values();
+        if (result.size() > 0)
+        {
+            return std::make_shared<value_term<Json>>(std::move(result[0]));
+        }
+        return std::make_shared<node_set_term<Json>>();
+    }
+};
+
+template <class Json>
+token<Json> evaluate(const Json& root, const Json& context, const std::vector<token<Json>>& tokens, std::vector<std::unique_ptr<Json>>& temp_json_values)
+{
     std::vector<token<Json>> stack;
-    for (auto t : tokens)
+    for (const auto& t : tokens)
     {
         if (t.is_operand())
         {
-            stack.push_back(t);
+            stack.push_back(t.resolve(root, context, temp_json_values));
         }
         else if (t.is_unary_operator())
         {
@@ -997,11 +1324,54 @@ public:
     {
     }
 
-    Json eval(const Json& context_node, std::vector<std::unique_ptr<Json>>& temp_json_values)
+    bool references_root() const
+    {
+        for (const auto& t : tokens_)
+        {
+            if (t.references_root())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // If the expression compares a path relative to the current node with 
+    // a constant, e.g. @.id == 'X', sets path and value and returns true
+    bool path_equals_constant(const compiled_path<Json>*& path, const Json*& value) const
+    {
+        if (tokens_.size() != 3 || !tokens_[2].is_equality() 
+            || tokens_[0].operand_term() == nullptr || tokens_[1].operand_term() == nullptr)
+        {
+            return false;
+        }
+        const term<Json>& a = *tokens_[0].operand_term();
+        const term<Json>& b = *tokens_[1].operand_term();
+        if (a.relative_path() != nullptr && b.constant() != nullptr)
+        {
+            path = a.relative_path();
+            value = b.constant();
+            return true;
+        }
+        if (b.relative_path() != nullptr && a.constant() != nullptr)
+        {
+            path = b.relative_path();
+            value = a.constant();
+            return true;
+        }
+        return false;
+    }
+
+    Json eval(const Json& context_node, std::vector<std::unique_ptr<Json>>& temp_json_values) const
+    {
+        return eval(context_node, context_node, temp_json_values);
+    }
+
+    Json eval(const Json& root, const Json& context_node, std::vector<std::unique_ptr<Json>>& temp_json_values) const
     {
         try
         {
-            auto t = evaluate(context_node, tokens_, temp_json_values);
+            auto t = evaluate(root, context_node, tokens_, temp_json_values);
 
             return t.operand().evaluate_single_node();
 
@@ -1012,11 +1382,16 @@ public:
         }
     }
 
-    bool exists(const Json& context_node, std::vector<std::unique_ptr<Json>>& temp_json_values)
+    bool exists(const Json& context_node, std::vector<std::unique_ptr<Json>>& temp_json_values) const
+    {
+        return exists(context_node, context_node, temp_json_values);
+    }
+
+    bool exists(const Json& root, const Json& context_node, std::vector<std::unique_ptr<Json>>& temp_json_values) const
     {
         try
         {
-            auto t = evaluate(context_node,tokens_,temp_json_values);
+            auto t = evaluate(root,context_node,tokens_,temp_json_values);
             return t.operand().accept_single_node();
         }
         catch (const serialization_error& e)
@@ -1096,10 +1471,16 @@ public:
         return column_;
     }
 
-    jsonpath_filter_expr<Json> parse(const Json& root, const char_type* p, size_t length, const char_type** end_ptr,
-                                     std::vector<std::unique_ptr<Json>>& temp_json_values)
+    jsonpath_filter_expr<Json> parse(const Json&, const char_type* p, size_t length, const char_type** end_ptr,
+                                     std::vector<std::unique_ptr<Json>>&)
+    {
+        return parse(p,p+length, end_ptr);
+    }
+
+    jsonpath_filter_expr<Json> parse(const Json&, const char_type* p, const char_type* end_expr, const char_type** end_ptr,
+                                     std::vector<std::unique_ptr<Json>>&)
     {
-        return parse(root, p,p+length, end_ptr, temp_json_values);
+        return parse(p, end_expr, end_ptr);
     }
 
     void push_state(filter_state state)
@@ -1177,8 +1558,21 @@ public:
         }
     }
 
-    jsonpath_filter_expr<Json> parse(const Json& root, const char_type* p, const char_type* end_expr, const char_type** end_ptr,
-        std::vector<std::unique_ptr<Json>>& temp_json_values)
+    void push_path(const string_type& buffer)
+    {
+        std::error_code ec;
+        jsonpath_compiler<Json> compiler;
+        auto path = compiler.compile(buffer.data(), buffer.length(), '@', ec);
+        if (ec)
+        {
+            throw serialization_error(ec,line_,column_);
+        }
+        push_token(token<Json>(token_type::operand,std::make_shared<path_term<Json>>(std::move(path))));
+    }
+
+    // Parses a filter expression without evaluating it, paths in the expression
+    // are evaluated when the expression is
+    jsonpath_filter_expr<Json> parse(const char_type* p, const char_type* end_expr, const char_type** end_ptr)
     {
         output_stack_.clear();
         operator_stack_.clear();
@@ -1286,23 +1680,14 @@ public:
                         buffer.push_back(*p);
                         if (buffer.length() > 0)
                         {
-                            try
+                            std::error_code ec;
+                            jsonpath_compiler<Json> compiler;
+                            auto path = compiler.compile(buffer.data(), buffer.length(), '$', ec);
+                            if (ec)
                             {
-                                // path, parse against root, get value
-                                jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>,'$'> evaluator;
-                                evaluator.evaluate(root, buffer, temp_json_values);
-                                auto result = evaluator.get_values();
-                                if (result.size() > 0)
-                                {
-                                    push_token(token<Json>(token_type::operand,
-                                                          std::make_shared<value_term<Json>>(std::move(result[0]))) // revisit this value_term
-                                              );
-                                }
-                            }
-                            catch (const serialization_error& e)
-                            {
-                                throw serialization_error(e.code(),line_,column_);
+                                throw serialization_error(ec,line_,column_);
                             }
+                            push_token(token<Json>(token_type::operand,std::make_shared<function_term<Json>>(std::move(path))));
                             buffer.clear();
                             state = filter_state::expect_oper_or_right_round_bracket;
                         }
@@ -1346,7 +1731,7 @@ public:
                             throw serialization_error(jsonpath_errc::invalid_filter_unsupported_operator, line_, column_);
                         }
                         buffer.clear();
-                        push_token(token<Json>(it->second));
+                        push_token(token<Json>(it->second, it->first == eq_literal<char_type>()));
                         state = filter_state::expect_path_or_value_or_unary_op;
                     }
                     break;
@@ -1698,7 +2083,7 @@ public:
                     {
                         if (buffer.length() > 0)
                         {
-                            push_token(token<Json>(token_type::operand,std::make_shared<path_term<Json>>(buffer)));
+                            push_path(buffer);
                             buffer.clear();
                         }
                         buffer.push_back(*p);
@@ -1710,7 +2095,7 @@ public:
                 case ')':
                     if (buffer.length() > 0)
                     {
-                        push_token(token<Json>(token_type::operand,std::make_shared<path_term<Json>>(buffer)));
+                        push_path(buffer);
                         push_token(token<Json>(token_type::rparen));
                         buffer.clear();
                     }
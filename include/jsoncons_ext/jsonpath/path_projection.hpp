@@ -0,0 +1,670 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_JSONPATH_PATH_PROJECTION_HPP
+#define JSONCONS_JSONPATH_PATH_PROJECTION_HPP
+
+#include <string>
+#include <vector>
+#include <utility> // std::pair
+#include <initializer_list>
+#include <system_error>
+#include <jsoncons/json_exception.hpp>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons/json_filter.hpp>
+#include <jsoncons/staj_reader.hpp>
+#include <jsoncons_ext/jsonpath/jsonpath_error.hpp>
+
+namespace jsoncons { namespace jsonpath {
+
+// A set of paths compiled into a trie. A path is either a JSON Pointer,
+// e.g. "/items/0/sku", or a JSONPath expression made of names, indices
+// and wildcards only, e.g. "$.items[*].sku" or "$['user']['id']".
+// Once constructed a projection is not modified, and may be shared
+// between threads.
+template <class CharT>
+class basic_path_projection
+{
+public:
+    typedef CharT char_type;
+    typedef std::basic_string<CharT> string_type;
+    typedef basic_string_view<CharT> string_view_type;
+
+    static const size_t npos = static_cast<size_t>(-1);
+private:
+    struct node
+    {
+        std::vector<std::pair<string_type,size_t>> names;
+        std::vector<std::pair<size_t,size_t>> indices;
+        size_t wildcard;
+        bool selected;
+
+        node()
+            : wildcard(npos), selected(false)
+        {
+        }
+    };
+
+    std::vector<node> nodes_;
+public:
+    basic_path_projection()
+        : nodes_(1)
+    {
+    }
+
+    basic_path_projection(std::initializer_list<string_view_type> paths)
+        : nodes_(1)
+    {
+        for (const auto& path : paths)
+        {
+            add(path);
+        }
+    }
+
+    basic_path_projection(const std::vector<string_type>& paths)
+        : nodes_(1)
+    {
+        for (const auto& path : paths)
+        {
+            add(path);
+        }
+    }
+
+    void add(const string_view_type& path)
+    {
+        std::error_code ec;
+        add(path, ec);
+        if (ec)
+        {
+            throw serialization_error(ec, 1, 1);
+        }
+    }
+
+    void add(const string_view_type& path, std::error_code& ec)
+    {
+        if (!path.empty() && path[0] == '$')
+        {
+            add_jsonpath(path, ec);
+        }
+        else
+        {
+            add_json_pointer(path, ec);
+        }
+    }
+
+    size_t root() const
+    {
+        return 0;
+    }
+
+    // The whole value at this node is kept
+    bool selected(size_t n) const
+    {
+        return nodes_[n].selected;
+    }
+
+    size_t find_name(size_t n, const string_view_type& name) const
+    {
+        const node& nd = nodes_[n];
+        for (const auto& item : nd.names)
+        {
+            if (string_view_type(item.first) == name)
+            {
+                return item.second;
+            }
+        }
+        return nd.wildcard;
+    }
+
+    size_t find_index(size_t n, size_t index) const
+    {
+        const node& nd = nodes_[n];
+        for (const auto& item : nd.indices)
+        {
+            if (item.first == index)
+            {
+                return item.second;
+            }
+        }
+        return nd.wildcard;
+    }
+
+private:
+    size_t name_child(size_t n, const string_type& name)
+    {
+        for (const auto& item : nodes_[n].names)
+        {
+            if (item.first == name)
+            {
+                return item.second;
+            }
+        }
+        size_t child = new_node();
+        nodes_[n].names.emplace_back(name, child);
+        return child;
+    }
+
+    size_t index_child(size_t n, size_t index)
+    {
+        for (const auto& item : nodes_[n].indices)
+        {
+            if (item.first == index)
+            {
+                return item.second;
+            }
+        }
+        size_t child = new_node();
+        nodes_[n].indices.emplace_back(index, child);
+        return child;
+    }
+
+    size_t wildcard_child(size_t n)
+    {
+        if (nodes_[n].wildcard == npos)
+        {
+            size_t child = new_node();
+            nodes_[n].wildcard = child;
+        }
+        return nodes_[n].wildcard;
+    }
+
+    size_t new_node()
+    {
+        nodes_.emplace_back();
+        return nodes_.size() - 1;
+    }
+
+    static bool is_index(const string_type& s, size_t* index)
+    {
+        if (s.empty() || (s.length() > 1 && s[0] == '0'))
+        {
+            return false;
+        }
+        size_t n = 0;
+        for (auto c : s)
+        {
+            if (c < '0' || c > '9')
+            {
+                return false;
+            }
+            n = n*10 + static_cast<size_t>(c - '0');
+        }
+        *index = n;
+        return true;
+    }
+
+    // A JSON Pointer token or dot-notation name may be a member name or,
+    // if all digits, an array index
+    size_t pointer_child(size_t n, const string_type& token)
+    {
+        size_t child = name_child(n, token);
+        size_t index;
+        if (is_index(token, &index))
+        {
+            bool found = false;
+            for (const auto& item : nodes_[n].indices)
+            {
+                found = found || item.first == index;
+            }
+            if (!found)
+            {
+                nodes_[n].indices.emplace_back(index, child);
+            }
+        }
+        return child;
+    }
+
+    void add_json_pointer(const string_view_type& path, std::error_code& ec)
+    {
+        size_t n = root();
+        size_t i = 0;
+        while (i < path.length())
+        {
+            if (path[i] != '/')
+            {
+                ec = jsonpath_errc::expected_separator;
+                return;
+            }
+            ++i;
+            string_type token;
+            while (i < path.length() && path[i] != '/')
+            {
+                if (path[i] == '~' && i+1 < path.length() && (path[i+1] == '0' || path[i+1] == '1'))
+                {
+                    token.push_back(path[i+1] == '0' ? '~' : '/');
+                    i += 2;
+                }
+                else
+                {
+                    token.push_back(path[i]);
+                    ++i;
+                }
+            }
+            n = pointer_child(n, token);
+        }
+        nodes_[n].selected = true;
+    }
+
+    void add_jsonpath(const string_view_type& path, std::error_code& ec)
+    {
+        size_t n = root();
+        size_t i = 1;
+        while (i < path.length())
+        {
+            if (path[i] == '.')
+            {
+                ++i;
+                if (i < path.length() && path[i] == '*')
+                {
+                    n = wildcard_child(n);
+                    ++i;
+                    continue;
+                }
+                string_type name;
+                while (i < path.length() && path[i] != '.' && path[i] != '[')
+                {
+                    name.push_back(path[i]);
+                    ++i;
+                }
+                if (name.empty())
+                {
+                    ec = jsonpath_errc::expected_name;
+                    return;
+                }
+                n = pointer_child(n, name);
+            }
+            else if (path[i] == '[')
+            {
+                ++i;
+                if (i < path.length() && (path[i] == '\'' || path[i] == '\"'))
+                {
+                    CharT quote = path[i++];
+                    string_type name;
+                    while (i < path.length() && path[i] != quote)
+                    {
+                        if (path[i] == '\\' && i+1 < path.length())
+                        {
+                            ++i;
+                        }
+                        name.push_back(path[i]);
+                        ++i;
+                    }
+                    if (i == path.length())
+                    {
+                        ec = jsonpath_errc::expected_right_bracket;
+                        return;
+                    }
+                    ++i;
+                    n = name_child(n, name);
+                }
+                else if (i < path.length() && path[i] == '*')
+                {
+                    ++i;
+                    n = wildcard_child(n);
+                }
+                else if (i < path.length() && path[i] >= '0' && path[i] <= '9')
+                {
+                    size_t index = 0;
+                    while (i < path.length() && path[i] >= '0' && path[i] <= '9')
+                    {
+                        index = index*10 + static_cast<size_t>(path[i] - '0');
+                        ++i;
+                    }
+                    n = index_child(n, index);
+                }
+                else
+                {
+                    ec = jsonpath_errc::expected_left_bracket_token;
+                    return;
+                }
+                if (i == path.length() || path[i] != ']')
+                {
+                    ec = jsonpath_errc::expected_right_bracket;
+                    return;
+                }
+                ++i;
+            }
+            else
+            {
+                ec = jsonpath_errc::expected_separator;
+                return;
+            }
+        }
+        nodes_[n].selected = true;
+    }
+};
+
+// Passes on the parts of the input selected by a path projection, and
+// discards everything else. Objects and arrays on the way to a selected
+// value are kept, with only the selected members and elements.
+template <class CharT>
+class basic_path_projection_filter : public basic_json_filter<CharT>
+{
+public:
+    using typename basic_json_filter<CharT>::string_view_type;
+    typedef std::basic_string<CharT> string_type;
+private:
+    static const size_t npos = basic_path_projection<CharT>::npos;
+
+    enum class value_action {discard, select, descend};
+
+    struct path_item
+    {
+        size_t node;
+        bool is_object;
+        size_t index;
+
+        path_item(size_t node, bool is_object)
+            : node(node), is_object(is_object), index(0)
+        {
+        }
+    };
+
+    const basic_path_projection<CharT>& projection_;
+    std::vector<path_item> stack_;
+    size_t select_depth_;
+    size_t discard_depth_;
+    size_t member_node_;
+    string_type member_name_;
+public:
+    basic_path_projection_filter(const basic_path_projection<CharT>& projection,
+                                 basic_json_content_handler<CharT>& handler)
+        : basic_json_filter<CharT>(handler),
+          projection_(projection),
+          select_depth_(0),
+          discard_depth_(0),
+          member_node_(npos)
+    {
+        stack_.reserve(16);
+    }
+
+    // True while the object or array that was last begun is being discarded
+    bool is_discarding() const
+    {
+        return discard_depth_ > 0;
+    }
+
+private:
+    value_action begin_value(size_t* node)
+    {
+        if (stack_.empty())
+        {
+            *node = projection_.root();
+        }
+        else if (stack_.back().is_object)
+        {
+            *node = member_node_;
+        }
+        else
+        {
+            *node = projection_.find_index(stack_.back().node, stack_.back().index++);
+        }
+        if (*node == npos)
+        {
+            return value_action::discard;
+        }
+        return projection_.selected(*node) ? value_action::select : value_action::descend;
+    }
+
+    bool write_member_name(const serializing_context& context)
+    {
+        if (!stack_.empty() && stack_.back().is_object)
+        {
+            return this->destination_handler().name(member_name_, context);
+        }
+        return true;
+    }
+
+    bool begin_container(bool is_object, size_t* length, semantic_tag_type tag, const serializing_context& context)
+    {
+        if (discard_depth_ > 0)
+        {
+            ++discard_depth_;
+            return true;
+        }
+        if (select_depth_ > 0)
+        {
+            ++select_depth_;
+        }
+        else
+        {
+            size_t node;
+            switch (begin_value(&node))
+            {
+                case value_action::discard:
+                    discard_depth_ = 1;
+                    return true;
+                case value_action::select:
+                    write_member_name(context);
+                    select_depth_ = 1;
+                    break;
+                case value_action::descend:
+                    write_member_name(context);
+                    stack_.emplace_back(node, is_object);
+                    // not all members or elements may be kept
+                    length = nullptr;
+                    break;
+            }
+        }
+        if (is_object)
+        {
+            return length ? this->destination_handler().begin_object(*length, tag, context)
+                          : this->destination_handler().begin_object(tag, context);
+        }
+        else
+        {
+            return length ? this->destination_handler().begin_array(*length, tag, context)
+                          : this->destination_handler().begin_array(tag, context);
+        }
+    }
+
+    bool end_container(bool is_object, const serializing_context& context)
+    {
+        if (discard_depth_ > 0)
+        {
+            --discard_depth_;
+            return true;
+        }
+        if (select_depth_ > 0)
+        {
+            --select_depth_;
+        }
+        else
+        {
+            stack_.pop_back();
+        }
+        return is_object ? this->destination_handler().end_object(context)
+                         : this->destination_handler().end_array(context);
+    }
+
+    // Returns true if the scalar value is to be written
+    bool begin_scalar(const serializing_context& context)
+    {
+        if (discard_depth_ > 0)
+        {
+            return false;
+        }
+        if (select_depth_ > 0)
+        {
+            return true;
+        }
+        size_t node;
+        if (begin_value(&node) == value_action::select)
+        {
+            write_member_name(context);
+            return true;
+        }
+        return false;
+    }
+
+    bool do_begin_object(semantic_tag_type tag, const serializing_context& context) override
+    {
+        return begin_container(true, nullptr, tag, context);
+    }
+
+    bool do_begin_object(size_t length, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return begin_container(true, &length, tag, context);
+    }
+
+    bool do_end_object(const serializing_context& context) override
+    {
+        return end_container(true, context);
+    }
+
+    bool do_begin_array(semantic_tag_type tag, const serializing_context& context) override
+    {
+        return begin_container(false, nullptr, tag, context);
+    }
+
+    bool do_begin_array(size_t length, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return begin_container(false, &length, tag, context);
+    }
+
+    bool do_end_array(const serializing_context& context) override
+    {
+        return end_container(false, context);
+    }
+
+    bool do_name(const string_view_type& name, const serializing_context& context) override
+    {
+        if (discard_depth_ > 0)
+        {
+            return true;
+        }
+        if (select_depth_ > 0)
+        {
+            return this->destination_handler().name(name, context);
+        }
+        member_node_ = projection_.find_name(stack_.back().node, name);
+        if (member_node_ != npos)
+        {
+            member_name_.assign(name.data(), name.length());
+        }
+        return true;
+    }
+
+    bool do_null_value(semantic_tag_type tag, const serializing_context& context) override
+    {
+        return begin_scalar(context) ? this->destination_handler().null_value(tag, context) : true;
+    }
+
+    bool do_string_value(const string_view_type& value, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return begin_scalar(context) ? this->destination_handler().string_value(value, tag, context) : true;
+    }
+
+    bool do_byte_string_value(const byte_string_view& b,
+                              byte_string_chars_format encoding_hint,
+                              semantic_tag_type tag,
+                              const serializing_context& context) override
+    {
+        return begin_scalar(context) ? this->destination_handler().byte_string_value(b, encoding_hint, tag, context) : true;
+    }
+
+    bool do_double_value(double value,
+                         const floating_point_options& fmt,
+                         semantic_tag_type tag,
+                         const serializing_context& context) override
+    {
+        return begin_scalar(context) ? this->destination_handler().double_value(value, fmt, tag, context) : true;
+    }
+
+    bool do_int64_value(int64_t value,
+                        semantic_tag_type tag,
+                        const serializing_context& context) override
+    {
+        return begin_scalar(context) ? this->destination_handler().int64_value(value, tag, context) : true;
+    }
+
+    bool do_uint64_value(uint64_t value,
+                         semantic_tag_type tag,
+                         const serializing_context& context) override
+    {
+        return begin_scalar(context) ? this->destination_handler().uint64_value(value, tag, context) : true;
+    }
+
+    bool do_bool_value(bool value, semantic_tag_type tag, const serializing_context& context) override
+    {
+        return begin_scalar(context) ? this->destination_handler().bool_value(value, tag, context) : true;
+    }
+};
+
+// Reads one value from a pull reader and sends the parts selected by
+// the projection to the handler. Discarded objects and arrays are
+// stepped over with the reader's skip(), without constructing their events.
+template <class CharT>
+void project(basic_staj_reader<CharT>& reader,
+             const basic_path_projection<CharT>& projection,
+             basic_json_content_handler<CharT>& handler,
+             std::error_code& ec)
+{
+    basic_path_projection_filter<CharT> filter(projection, handler);
+
+    size_t level = 0;
+    while (!ec)
+    {
+        const basic_staj_event<CharT>& event = reader.current();
+        switch (event.event_type())
+        {
+            case staj_event_type::begin_array:
+            case staj_event_type::begin_object:
+                jsoncons::detail::replay_staj_event(event, filter, reader.context());
+                if (filter.is_discarding())
+                {
+                    reader.skip(ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    jsoncons::detail::replay_staj_event(reader.current(), filter, reader.context());
+                }
+                else
+                {
+                    ++level;
+                }
+                break;
+            case staj_event_type::end_array:
+            case staj_event_type::end_object:
+                jsoncons::detail::replay_staj_event(event, filter, reader.context());
+                --level;
+                break;
+            default:
+                jsoncons::detail::replay_staj_event(event, filter, reader.context());
+                break;
+        }
+        if (level == 0)
+        {
+            break;
+        }
+        reader.next(ec);
+    }
+    filter.flush();
+}
+
+template <class CharT>
+void project(basic_staj_reader<CharT>& reader,
+             const basic_path_projection<CharT>& projection,
+             basic_json_content_handler<CharT>& handler)
+{
+    std::error_code ec;
+    project(reader, projection, handler, ec);
+    if (ec)
+    {
+        throw serialization_error(ec,reader.context().line_number(),reader.context().column_number());
+    }
+}
+
+typedef basic_path_projection<char> path_projection;
+typedef basic_path_projection<wchar_t> wpath_projection;
+
+typedef basic_path_projection_filter<char> path_projection_filter;
+typedef basic_path_projection_filter<wchar_t> wpath_projection_filter;
+
+}}
+
+#endif
@@ -0,0 +1,469 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_JSONPATH_STREAM_QUERY_HPP
+#define JSONCONS_JSONPATH_STREAM_QUERY_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm> // std::find_if
+#include <system_error>
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_decoder.hpp>
+#include <jsoncons/staj_reader.hpp>
+#include <jsoncons_ext/jsonpath/json_query.hpp>
+
+namespace jsoncons { namespace jsonpath {
+
+namespace detail {
+
+// Evaluates a compiled JSONPath expression over the events of a pull reader.
+// Names, indices, non-negative slices, wildcards and recursive descent are
+// matched against the events as they are read, and subtrees that cannot
+// match are skipped. A subtree is only decoded into a Json value when it is
+// selected, or when the rest of the expression cannot be matched against
+// events, e.g. a filter, in which case the rest of the expression is
+// evaluated against the decoded value.
+template <class Json,class PathCons>
+class jsonpath_stream_evaluator
+{
+    typedef typename Json::char_type char_type;
+    typedef typename Json::string_type string_type;
+    typedef typename Json::string_view_type string_view_type;
+
+    // A step of the expression that applies to a node
+    struct position
+    {
+        size_t step;
+        // reached by recursive descent, the step applies to containers only
+        bool descendant;
+        // the node is an array element that must pass the step's filter
+        bool filter;
+
+        position(size_t step, bool descendant, bool filter)
+            : step(step), descendant(descendant), filter(filter)
+        {
+        }
+    };
+
+    struct name_match
+    {
+        string_type name;
+        bool is_index;
+        size_t index;
+    };
+
+    struct step_info
+    {
+        bool streamable;
+        bool element_filter;
+        bool string_selector;
+        std::vector<name_match> names;
+        std::vector<const path_selector<Json>*> slices;
+
+        step_info()
+            : streamable(false), element_filter(false), string_selector(false)
+        {
+        }
+    };
+
+    struct frame
+    {
+        bool is_object;
+        size_t index;
+        std::vector<position> positions;
+        string_type path;
+    };
+
+    static string_view_type length_literal()
+    {
+        static const char_type data[] = {'l','e','n','g','t','h'};
+        return string_view_type{data,sizeof(data)/sizeof(char_type)};
+    }
+
+    const compiled_path<Json>& path_;
+    std::vector<step_info> steps_;
+    std::vector<std::shared_ptr<compiled_path<Json>>> suffixes_;
+    std::vector<frame> stack_;
+    json_decoder<Json> decoder_;
+    string_type name_;
+    bool references_root_;
+public:
+    jsonpath_stream_evaluator(const compiled_path<Json>& path)
+        : path_(path), references_root_(false)
+    {
+        const auto& steps = path_.steps;
+        for (size_t k = 0; k <= steps.size(); ++k)
+        {
+            auto suffix = std::make_shared<compiled_path<Json>>();
+            suffix->root_kind = path_root_kind::node;
+            suffix->steps.assign(steps.begin()+k, steps.end());
+            suffixes_.push_back(suffix);
+        }
+        for (const auto& step : steps)
+        {
+            steps_.push_back(make_step_info(step));
+            for (const auto& selector : step.selectors)
+            {
+                if (selector.expr && selector.expr->references_root())
+                {
+                    references_root_ = true;
+                }
+            }
+        }
+    }
+
+    template <class Callback>
+    void evaluate(basic_staj_reader<char_type>& reader, Callback callback, std::error_code& ec)
+    {
+        stack_.clear();
+        string_type root_path;
+        root_path.push_back('$');
+
+        std::vector<position> root_positions;
+        if (path_.root_kind == path_root_kind::node && !references_root_)
+        {
+            root_positions.emplace_back(0, false, false);
+        }
+        else if (path_.root_kind != path_root_kind::none)
+        {
+            // Functions, and filters that refer to '$', need the whole value
+            reader.accept(decoder_, ec);
+            if (ec) return;
+            Json val = decoder_.get_result();
+            std::vector<std::unique_ptr<Json>> temp_json_values;
+            jsonpath_evaluator<Json,const Json&,PathCons,'$'> evaluator;
+            evaluator.evaluate(val, path_, temp_json_values);
+            evaluator.visit(callback);
+            return;
+        }
+        else
+        {
+            reader.skip(ec);
+            return;
+        }
+
+        read_node(reader, std::move(root_positions), root_path, callback, ec);
+
+        while (!ec && !stack_.empty())
+        {
+            reader.next(ec);
+            if (ec) return;
+
+            const auto& event = reader.current();
+            switch (event.event_type())
+            {
+                case staj_event_type::end_array:
+                case staj_event_type::end_object:
+                    stack_.pop_back();
+                    break;
+                case staj_event_type::name:
+                    name_ = event.template as<string_type>();
+                    break;
+                default:
+                {
+                    frame& parent = stack_.back();
+                    std::vector<position> positions;
+                    string_type path;
+                    if (parent.is_object)
+                    {
+                        child_positions(parent, name_, 0, positions);
+                        if (!positions.empty())
+                        {
+                            path = PathCons()(parent.path, name_);
+                        }
+                    }
+                    else
+                    {
+                        size_t index = parent.index++;
+                        child_positions(parent, string_view_type(), index, positions);
+                        if (!positions.empty())
+                        {
+                            path = PathCons()(parent.path, index);
+                        }
+                    }
+                    if (positions.empty())
+                    {
+                        reader.skip(ec);
+                    }
+                    else
+                    {
+                        read_node(reader, std::move(positions), path, callback, ec);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+private:
+
+    step_info make_step_info(const path_step<Json>& step) const
+    {
+        step_info info;
+        switch (step.kind)
+        {
+            case path_step_kind::wildcard:
+                info.streamable = true;
+                break;
+            case path_step_kind::name:
+                info.streamable = add_name(step.name, info);
+                break;
+            case path_step_kind::brackets:
+                if (!step.recursive_descent && !step.wildcard && step.selectors.size() == 1
+                    && step.selectors[0].kind == selector_kind::filter)
+                {
+                    info.element_filter = true;
+                    break;
+                }
+                info.streamable = !(step.wildcard && step.recursive_descent);
+                for (const auto& selector : step.selectors)
+                {
+                    switch (selector.kind)
+                    {
+                        case selector_kind::name:
+                            if (!add_name(selector.name, info))
+                            {
+                                info.streamable = false;
+                            }
+                            break;
+                        case selector_kind::array_slice:
+                            if (selector.positive_start && (selector.positive_end || selector.undefined_end)
+                                && selector.positive_step && selector.step > 0)
+                            {
+                                info.slices.push_back(std::addressof(selector));
+                            }
+                            else
+                            {
+                                info.streamable = false;
+                            }
+                            break;
+                        default:
+                            info.streamable = false;
+                            break;
+                    }
+                }
+                break;
+        }
+        return info;
+    }
+
+    // Returns false if the name cannot be matched against events
+    static bool add_name(const string_type& name, step_info& info)
+    {
+        if (name.empty() || string_view_type(name) == length_literal())
+        {
+            return false;
+        }
+        name_match match;
+        match.name = name;
+        bool positive = true;
+        match.is_index = try_string_to_index(name.data(), name.size(), &match.index, &positive);
+        if (match.is_index)
+        {
+            if (!positive)
+            {
+                return false;
+            }
+            info.string_selector = true;
+        }
+        info.names.push_back(std::move(match));
+        return true;
+    }
+
+    static void add_position(std::vector<position>& positions, size_t step, bool descendant, bool filter)
+    {
+        auto it = std::find_if(positions.begin(), positions.end(),
+                               [&](const position& p){return p.step == step && p.filter == filter;});
+        if (it == positions.end())
+        {
+            positions.emplace_back(step, descendant, filter);
+        }
+        else if (!descendant)
+        {
+            it->descendant = false;
+        }
+    }
+
+    void child_positions(const frame& parent, const string_view_type& name, size_t index,
+                         std::vector<position>& positions) const
+    {
+        for (const auto& p : parent.positions)
+        {
+            const auto& step = path_.steps[p.step];
+            const auto& info = steps_[p.step];
+            if (info.element_filter)
+            {
+                if (!parent.is_object)
+                {
+                    add_position(positions, p.step, false, true);
+                }
+                continue;
+            }
+            if (step.kind == path_step_kind::wildcard || step.wildcard)
+            {
+                add_position(positions, p.step+1, false, false);
+            }
+            for (const auto& match : info.names)
+            {
+                if (parent.is_object ? string_view_type(match.name) == name
+                                     : (match.is_index && match.index == index))
+                {
+                    add_position(positions, p.step+1, false, false);
+                }
+            }
+            if (!parent.is_object)
+            {
+                for (auto slice : info.slices)
+                {
+                    if (index >= slice->start && (slice->undefined_end || index < slice->end)
+                        && (index - slice->start) % slice->step == 0)
+                    {
+                        add_position(positions, p.step+1, false, false);
+                    }
+                }
+            }
+            if (step.recursive_descent)
+            {
+                add_position(positions, p.step, true, false);
+            }
+        }
+    }
+
+    // Whether the node must be decoded to apply the steps at these positions
+    bool must_decode(const std::vector<position>& positions, staj_event_type event_type) const
+    {
+        bool is_object = event_type == staj_event_type::begin_object;
+        bool is_container = is_object || event_type == staj_event_type::begin_array;
+        for (const auto& p : positions)
+        {
+            if (p.filter || p.step == path_.steps.size())
+            {
+                return true;
+            }
+            const auto& info = steps_[p.step];
+            if (is_container)
+            {
+                if (info.element_filter ? is_object : !info.streamable)
+                {
+                    return true;
+                }
+            }
+            else if (!p.descendant && !info.element_filter && (info.string_selector || !info.streamable))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <class Callback>
+    void read_node(basic_staj_reader<char_type>& reader, std::vector<position>&& positions,
+                   const string_type& path, Callback callback, std::error_code& ec)
+    {
+        staj_event_type event_type = reader.current().event_type();
+        if (must_decode(positions, event_type))
+        {
+            reader.accept(decoder_, ec);
+            if (ec) return;
+            Json val = decoder_.get_result();
+            evaluate_decoded(val, positions, path, callback);
+        }
+        else if (event_type == staj_event_type::begin_object || event_type == staj_event_type::begin_array)
+        {
+            frame f;
+            f.is_object = event_type == staj_event_type::begin_object;
+            f.index = 0;
+            f.positions = std::move(positions);
+            f.path = path;
+            stack_.push_back(std::move(f));
+        }
+    }
+
+    template <class Callback>
+    void evaluate_decoded(const Json& val, const std::vector<position>& positions,
+                          const string_type& path, Callback callback)
+    {
+        std::vector<std::unique_ptr<Json>> temp_json_values;
+        bool is_container = val.is_object() || val.is_array();
+        for (const auto& p : positions)
+        {
+            size_t step = p.step;
+            if (p.filter)
+            {
+                if (!path_.steps[step].selectors[0].expr->exists(val, val, temp_json_values))
+                {
+                    continue;
+                }
+                ++step;
+            }
+            else if (p.descendant && !is_container)
+            {
+                continue;
+            }
+            jsonpath_evaluator<Json,const Json&,PathCons,'$'> evaluator;
+            evaluator.evaluate(val, *suffixes_[step], path, temp_json_values);
+            evaluator.visit(callback);
+        }
+    }
+};
+
+}
+
+// Reads one value from a pull reader and calls callback(path, value) for
+// each part of it selected by a JSONPath expression. Parts that cannot be
+// selected are skipped without being decoded. path is the normalized path
+// of the value if result_t is result_type::path, otherwise empty.
+template <class Json, class Callback>
+void stream_query(basic_staj_reader<typename Json::char_type>& reader,
+                  const typename Json::string_view_type& path,
+                  Callback callback,
+                  result_type result_t,
+                  std::error_code& ec)
+{
+    detail::jsonpath_compiler<Json> compiler;
+    auto compiled = compiler.compile(path.data(), path.length(), '$', ec);
+    if (ec)
+    {
+        return;
+    }
+    try
+    {
+        if (result_t == result_type::value)
+        {
+            detail::jsonpath_stream_evaluator<Json,detail::VoidPathConstructor<Json>> evaluator(*compiled);
+            evaluator.evaluate(reader, callback, ec);
+        }
+        else
+        {
+            detail::jsonpath_stream_evaluator<Json,detail::PathConstructor<Json>> evaluator(*compiled);
+            evaluator.evaluate(reader, callback, ec);
+        }
+    }
+    catch (const serialization_error& e)
+    {
+        ec = e.code();
+    }
+}
+
+template <class Json, class Callback>
+void stream_query(basic_staj_reader<typename Json::char_type>& reader,
+                  const typename Json::string_view_type& path,
+                  Callback callback,
+                  result_type result_t = result_type::value)
+{
+    std::error_code ec;
+    stream_query<Json>(reader, path, callback, result_t, ec);
+    if (ec)
+    {
+        throw serialization_error(ec,reader.context().line_number(),reader.context().column_number());
+    }
+}
+
+}}
+
+#endif
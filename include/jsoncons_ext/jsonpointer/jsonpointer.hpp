@@ -12,6 +12,7 @@
 #include <vector>
 #include <memory>
 #include <utility> // std::move
+#include <algorithm> // std::stable_sort
 #include <type_traits> // std::enable_if, std::true_type
 #include <jsoncons/json.hpp>
 #include <jsoncons_ext/jsonpointer/jsonpointer_error.hpp>
@@ -155,6 +156,29 @@ struct path_resolver
 
     jsonpointer_errc operator()(std::vector<handle_type<J,JReference>>& current,
                                 const string_view_type& name) const
+    {
+        return resolve_name(current, name, is_accessible_by_reference<J>());
+    }
+private:
+    // Looks up the member once
+    jsonpointer_errc resolve_name(std::vector<handle_type<J,JReference>>& current,
+                                  const string_view_type& name,
+                                  std::true_type) const
+    {
+        typename handle_type<J,JReference>::type parent = current.back().get();
+        auto it = parent.find(name);
+        if (it == parent.object_range().end())
+        {
+            return jsonpointer_errc::name_not_found;
+        }
+        current.push_back(it->value());
+        return jsonpointer_errc();
+    }
+
+    // Values returned by value, such as cbor_view, may not have find
+    jsonpointer_errc resolve_name(std::vector<handle_type<J,JReference>>& current,
+                                  const string_view_type& name,
+                                  std::false_type) const
     {
         if (!current.back().get().contains(name))
         {
@@ -824,6 +848,714 @@ void replace(J& root, const typename J::string_view_type& path, const J& value,
     ec = evaluator.replace(root,path,value);
 }
 
+namespace detail {
+
+// A reference token of a json_pointer, unescaped, with its value as an array
+// index decoded in advance
+template <class CharT>
+struct pointer_token
+{
+    typedef std::basic_string<CharT> string_type;
+
+    string_type name;
+    size_t index;
+    jsonpointer_errc index_ec; // why the token does not select an array element
+    bool after_last;           // the token is "-"
+
+    pointer_token(string_type&& s)
+        : name(std::move(s)), index(0), index_ec(jsonpointer_errc()), after_last(false)
+    {
+        if (name.empty())
+        {
+            index_ec = jsonpointer_errc::expected_digit_or_dash;
+        }
+        else if (name.size() == 1 && name[0] == '-')
+        {
+            after_last = true;
+            index_ec = jsonpointer_errc::index_exceeds_array_size;
+        }
+        else if (name[0] == '0' && name.size() > 1)
+        {
+            index_ec = (name[1] >= '0' && name[1] <= '9') ? jsonpointer_errc::unexpected_leading_zero : jsonpointer_errc::expected_digit_or_dash;
+        }
+        else
+        {
+            for (auto c : name)
+            {
+                if (c < '0' || c > '9')
+                {
+                    index_ec = jsonpointer_errc::expected_digit_or_dash;
+                    break;
+                }
+                index = index * 10 + static_cast<size_t>(c - '0');
+            }
+        }
+    }
+};
+
+template <class J,class JReference,class CharT>
+jsonpointer_errc select_token(handle_type<J,JReference>& current, const pointer_token<CharT>& token)
+{
+    if (current.get().is_array())
+    {
+        if (token.index_ec != jsonpointer_errc())
+        {
+            return token.index_ec;
+        }
+        if (token.index >= current.get().size())
+        {
+            return jsonpointer_errc::index_exceeds_array_size;
+        }
+        current = handle_type<J,JReference>(current.get().at(token.index));
+    }
+    else if (current.get().is_object())
+    {
+        auto it = current.get().find(token.name);
+        if (it == current.get().object_range().end())
+        {
+            return jsonpointer_errc::name_not_found;
+        }
+        current = handle_type<J,JReference>(it->value());
+    }
+    else
+    {
+        return jsonpointer_errc::expected_object_or_array;
+    }
+    return jsonpointer_errc();
+}
+
+// Follows the first count tokens from current
+template <class J,class JReference,class CharT>
+jsonpointer_errc select_tokens(handle_type<J,JReference>& current, 
+                               const std::vector<pointer_token<CharT>>& tokens, 
+                               size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        jsonpointer_errc ec = select_token(current, tokens[i]);
+        if (ec != jsonpointer_errc())
+        {
+            return ec;
+        }
+    }
+    return jsonpointer_errc();
+}
+
+template <class J,class CharT>
+jsonpointer_errc insert_token(J& parent, const pointer_token<CharT>& token, const J& value, bool assign)
+{
+    if (parent.is_array())
+    {
+        if (token.after_last)
+        {
+            parent.push_back(value);
+            return jsonpointer_errc();
+        }
+        if (token.index_ec != jsonpointer_errc())
+        {
+            return token.index_ec;
+        }
+        if (token.index > parent.size())
+        {
+            return jsonpointer_errc::index_exceeds_array_size;
+        }
+        if (token.index == parent.size())
+        {
+            parent.push_back(value);
+        }
+        else
+        {
+            parent.insert(parent.array_range().begin()+token.index,value);
+        }
+    }
+    else if (parent.is_object())
+    {
+        if (!assign && parent.contains(token.name))
+        {
+            return jsonpointer_errc::key_already_exists;
+        }
+        parent.insert_or_assign(token.name,value);
+    }
+    else
+    {
+        return jsonpointer_errc::expected_object_or_array;
+    }
+    return jsonpointer_errc();
+}
+
+}
+
+// A JSON Pointer parsed once into its reference tokens. Overloads of get, 
+// contains, insert_or_assign, insert, remove and replace that take a 
+// json_pointer follow the decoded tokens without parsing the pointer again.
+template <class CharT>
+class basic_json_pointer
+{
+public:
+    typedef CharT char_type;
+    typedef std::basic_string<CharT> string_type;
+    typedef basic_string_view<CharT> string_view_type;
+    typedef detail::pointer_token<CharT> token_type;
+private:
+    std::vector<token_type> tokens_;
+public:
+    // The pointer to the whole document
+    basic_json_pointer()
+    {
+    }
+
+    explicit basic_json_pointer(const string_view_type& s)
+    {
+        std::error_code ec;
+        parse(s, ec);
+        if (ec)
+        {
+            JSONCONS_THROW(jsonpointer_error(ec));
+        }
+    }
+
+    basic_json_pointer(const string_view_type& s, std::error_code& ec)
+    {
+        parse(s, ec);
+    }
+
+    // Appends the token name, which is not escaped
+    basic_json_pointer& operator/=(const string_view_type& name)
+    {
+        tokens_.emplace_back(string_type(name.data(), name.size()));
+        return *this;
+    }
+
+    basic_json_pointer& operator/=(size_t index)
+    {
+        string_type name;
+        std::string s = std::to_string(index);
+        for (auto c : s)
+        {
+            name.push_back(c);
+        }
+        tokens_.emplace_back(std::move(name));
+        return *this;
+    }
+
+    friend basic_json_pointer operator/(const basic_json_pointer& lhs, const string_view_type& name)
+    {
+        basic_json_pointer p(lhs);
+        p /= name;
+        return p;
+    }
+
+    friend basic_json_pointer operator/(const basic_json_pointer& lhs, size_t index)
+    {
+        basic_json_pointer p(lhs);
+        p /= index;
+        return p;
+    }
+
+    bool empty() const
+    {
+        return tokens_.empty();
+    }
+
+    // The number of reference tokens
+    size_t size() const
+    {
+        return tokens_.size();
+    }
+
+    // The unescaped reference token at position i
+    const string_type& operator[](size_t i) const
+    {
+        return tokens_[i].name;
+    }
+
+    const std::vector<token_type>& tokens() const
+    {
+        return tokens_;
+    }
+
+    string_type to_string() const
+    {
+        string_type s;
+        for (const auto& token : tokens_)
+        {
+            s.push_back('/');
+            for (auto c : token.name)
+            {
+                if (c == '~')
+                {
+                    s.push_back('~');
+                    s.push_back('0');
+                }
+                else if (c == '/')
+                {
+                    s.push_back('~');
+                    s.push_back('1');
+                }
+                else
+                {
+                    s.push_back(c);
+                }
+            }
+        }
+        return s;
+    }
+
+    friend bool operator==(const basic_json_pointer& lhs, const basic_json_pointer& rhs)
+    {
+        if (lhs.tokens_.size() != rhs.tokens_.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < lhs.tokens_.size(); ++i)
+        {
+            if (lhs.tokens_[i].name != rhs.tokens_[i].name)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend bool operator!=(const basic_json_pointer& lhs, const basic_json_pointer& rhs)
+    {
+        return !(lhs == rhs);
+    }
+private:
+    void parse(const string_view_type& s, std::error_code& ec)
+    {
+        auto p = s.begin();
+        auto end = s.end();
+        if (p == end)
+        {
+            return;
+        }
+        if (*p != '/')
+        {
+            ec = jsonpointer_errc::expected_slash;
+            return;
+        }
+        string_type buffer;
+        ++p;
+        while (p != end)
+        {
+            switch (*p)
+            {
+                case '/':
+                    tokens_.emplace_back(std::move(buffer));
+                    buffer = string_type();
+                    break;
+                case '~':
+                    ++p;
+                    if (p == end || (*p != '0' && *p != '1'))
+                    {
+                        ec = jsonpointer_errc::expected_0_or_1;
+                        tokens_.clear();
+                        return;
+                    }
+                    buffer.push_back(*p == '0' ? '~' : '/');
+                    break;
+                default:
+                    buffer.push_back(*p);
+                    break;
+            }
+            ++p;
+        }
+        tokens_.emplace_back(std::move(buffer));
+    }
+};
+
+typedef basic_json_pointer<char> json_pointer;
+typedef basic_json_pointer<wchar_t> wjson_pointer;
+
+template<class J>
+typename std::enable_if<is_accessible_by_reference<J>::value,J&>::type
+get(J& root, const basic_json_pointer<typename J::char_type>& ptr, std::error_code& ec)
+{
+    detail::handle_type<J,J&> current(root);
+    ec = detail::select_tokens(current, ptr.tokens(), ptr.size());
+    return current.get();
+}
+
+template<class J>
+typename std::enable_if<is_accessible_by_reference<J>::value,const J&>::type
+get(const J& root, const basic_json_pointer<typename J::char_type>& ptr, std::error_code& ec)
+{
+    detail::handle_type<J,const J&> current(root);
+    ec = detail::select_tokens(current, ptr.tokens(), ptr.size());
+    return current.get();
+}
+
+template<class J>
+typename std::enable_if<!is_accessible_by_reference<J>::value,J>::type
+get(const J& root, const basic_json_pointer<typename J::char_type>& ptr, std::error_code& ec)
+{
+    detail::handle_type<J,const J&> current(root);
+    ec = detail::select_tokens(current, ptr.tokens(), ptr.size());
+    return current.get();
+}
+
+template<class J>
+typename std::enable_if<is_accessible_by_reference<J>::value,J&>::type
+get(J& root, const basic_json_pointer<typename J::char_type>& ptr)
+{
+    std::error_code ec;
+    J& val = get(root, ptr, ec);
+    if (ec)
+    {
+        JSONCONS_THROW(jsonpointer_error(ec));
+    }
+    return val;
+}
+
+template<class J>
+typename std::enable_if<is_accessible_by_reference<J>::value,const J&>::type
+get(const J& root, const basic_json_pointer<typename J::char_type>& ptr)
+{
+    std::error_code ec;
+    const J& val = get(root, ptr, ec);
+    if (ec)
+    {
+        JSONCONS_THROW(jsonpointer_error(ec));
+    }
+    return val;
+}
+
+template<class J>
+typename std::enable_if<!is_accessible_by_reference<J>::value,J>::type
+get(const J& root, const basic_json_pointer<typename J::char_type>& ptr)
+{
+    std::error_code ec;
+    J val = get(root, ptr, ec);
+    if (ec)
+    {
+        JSONCONS_THROW(jsonpointer_error(ec));
+    }
+    return val;
+}
+
+template<class J>
+bool contains(const J& root, const basic_json_pointer<typename J::char_type>& ptr)
+{
+    detail::handle_type<J,const J&> current(root);
+    return detail::select_tokens(current, ptr.tokens(), ptr.size()) == jsonpointer_errc();
+}
+
+template<class J>
+void insert_or_assign(J& root, const basic_json_pointer<typename J::char_type>& ptr, const J& value, std::error_code& ec)
+{
+    if (ptr.empty())
+    {
+        ec = std::error_code();
+        return;
+    }
+    detail::handle_type<J,J&> parent(root);
+    ec = detail::select_tokens(parent, ptr.tokens(), ptr.size()-1);
+    if (!ec)
+    {
+        ec = detail::insert_token(parent.get(), ptr.tokens().back(), value, true);
+    }
+}
+
+template<class J>
+void insert_or_assign(J& root, const basic_json_pointer<typename J::char_type>& ptr, const J& value)
+{
+    std::error_code ec;
+    insert_or_assign(root, ptr, value, ec);
+    if (ec)
+    {
+        JSONCONS_THROW(jsonpointer_error(ec));
+    }
+}
+
+template<class J>
+void insert(J& root, const basic_json_pointer<typename J::char_type>& ptr, const J& value, std::error_code& ec)
+{
+    if (ptr.empty())
+    {
+        ec = std::error_code();
+        return;
+    }
+    detail::handle_type<J,J&> parent(root);
+    ec = detail::select_tokens(parent, ptr.tokens(), ptr.size()-1);
+    if (!ec)
+    {
+        ec = detail::insert_token(parent.get(), ptr.tokens().back(), value, false);
+    }
+}
+
+template<class J>
+void insert(J& root, const basic_json_pointer<typename J::char_type>& ptr, const J& value)
+{
+    std::error_code ec;
+    insert(root, ptr, value, ec);
+    if (ec)
+    {
+        JSONCONS_THROW(jsonpointer_error(ec));
+    }
+}
+
+template<class J>
+void remove(J& root, const basic_json_pointer<typename J::char_type>& ptr, std::error_code& ec)
+{
+    ec = std::error_code();
+    if (ptr.empty())
+    {
+        return;
+    }
+    detail::handle_type<J,J&> parent(root);
+    ec = detail::select_tokens(parent, ptr.tokens(), ptr.size()-1);
+    if (ec)
+    {
+        return;
+    }
+    J& val = parent.get();
+    const auto& token = ptr.tokens().back();
+    if (val.is_array())
+    {
+        if (token.index_ec != jsonpointer_errc())
+        {
+            ec = token.index_ec;
+        }
+        else if (token.index >= val.size())
+        {
+            ec = jsonpointer_errc::index_exceeds_array_size;
+        }
+        else
+        {
+            val.erase(val.array_range().begin()+token.index);
+        }
+    }
+    else if (val.is_object())
+    {
+        if (!val.contains(token.name))
+        {
+            ec = jsonpointer_errc::name_not_found;
+        }
+        else
+        {
+            val.erase(token.name);
+        }
+    }
+    else
+    {
+        ec = jsonpointer_errc::expected_object_or_array;
+    }
+}
+
+template<class J>
+void remove(J& root, const basic_json_pointer<typename J::char_type>& ptr)
+{
+    std::error_code ec;
+    remove(root, ptr, ec);
+    if (ec)
+    {
+        JSONCONS_THROW(jsonpointer_error(ec));
+    }
+}
+
+template<class J>
+void replace(J& root, const basic_json_pointer<typename J::char_type>& ptr, const J& value, std::error_code& ec)
+{
+    ec = std::error_code();
+    if (ptr.empty())
+    {
+        return;
+    }
+    detail::handle_type<J,J&> target(root);
+    ec = detail::select_tokens(target, ptr.tokens(), ptr.size());
+    if (!ec)
+    {
+        target.get() = value;
+    }
+}
+
+template<class J>
+void replace(J& root, const basic_json_pointer<typename J::char_type>& ptr, const J& value)
+{
+    std::error_code ec;
+    replace(root, ptr, value, ec);
+    if (ec)
+    {
+        JSONCONS_THROW(jsonpointer_error(ec));
+    }
+}
+
+// The value selected by one of the pointers passed to get_many, or why 
+// it could not be selected
+template <class J>
+struct get_result
+{
+    J* value;
+    std::error_code ec;
+
+    get_result()
+        : value(nullptr)
+    {
+    }
+};
+
+namespace detail {
+
+template <class CharT>
+bool token_less(const basic_json_pointer<CharT>& lhs, const basic_json_pointer<CharT>& rhs)
+{
+    size_t n = (std::min)(lhs.size(), rhs.size());
+    for (size_t i = 0; i < n; ++i)
+    {
+        int c = lhs[i].compare(rhs[i]);
+        if (c != 0)
+        {
+            return c < 0;
+        }
+    }
+    return lhs.size() < rhs.size();
+}
+
+// Resolves the pointers order[first,last), sorted by their tokens, that share 
+// the first depth tokens and whose common prefix has been resolved to 
+// current.back(). Pointers that share a token at depth are resolved together, 
+// so a node of the implicit prefix trie is looked up once.
+template <class J,class JReference,class CharT>
+void resolve_sorted(std::vector<handle_type<J,JReference>>& current,
+                    const std::vector<basic_json_pointer<CharT>>& pointers,
+                    const std::vector<size_t>& order, size_t first, size_t last, size_t depth,
+                    std::vector<get_result<typename std::remove_reference<JReference>::type>>& out)
+{
+    path_resolver<J,JReference> op;
+
+    // Pointers that end here sort before those that continue
+    while (first < last && pointers[order[first]].size() == depth)
+    {
+        out[order[first]].value = std::addressof(current.back().get());
+        ++first;
+    }
+    while (first < last)
+    {
+        const auto& token = pointers[order[first]].tokens()[depth];
+        size_t group_last = first + 1;
+        while (group_last < last && pointers[order[group_last]][depth] == token.name)
+        {
+            ++group_last;
+        }
+
+        jsonpointer_errc ec;
+        if (current.back().get().is_array())
+        {
+            ec = token.index_ec != jsonpointer_errc() ? token.index_ec : op(current, token.index);
+        }
+        else if (current.back().get().is_object())
+        {
+            ec = op(current, token.name);
+        }
+        else
+        {
+            ec = jsonpointer_errc::expected_object_or_array;
+        }
+
+        if (ec == jsonpointer_errc())
+        {
+            resolve_sorted(current, pointers, order, first, group_last, depth+1, out);
+            current.pop_back();
+        }
+        else
+        {
+            for (size_t i = first; i < group_last; ++i)
+            {
+                out[order[i]].ec = ec;
+            }
+        }
+        first = group_last;
+    }
+}
+
+template <class J,class JReference,class CharT>
+void get_many(JReference root, 
+              const std::vector<basic_json_pointer<CharT>>& pointers, 
+              std::vector<get_result<typename std::remove_reference<JReference>::type>>& out)
+{
+    out.assign(pointers.size(), get_result<typename std::remove_reference<JReference>::type>());
+
+    std::vector<size_t> order(pointers.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    auto less = [&pointers](size_t a, size_t b){return token_less(pointers[a], pointers[b]);};
+    if (!std::is_sorted(order.begin(), order.end(), less))
+    {
+        std::stable_sort(order.begin(), order.end(), less);
+    }
+
+    std::vector<handle_type<J,JReference>> current;
+    current.push_back(root);
+    resolve_sorted(current, pointers, order, 0, order.size(), 0, out);
+}
+
+template <class J,class JReference>
+void get_many(JReference root, 
+              const std::vector<typename J::string_type>& pointers, 
+              std::vector<get_result<typename std::remove_reference<JReference>::type>>& out)
+{
+    std::vector<basic_json_pointer<typename J::char_type>> parsed;
+    std::vector<std::error_code> parse_errors(pointers.size());
+    parsed.reserve(pointers.size());
+    for (size_t i = 0; i < pointers.size(); ++i)
+    {
+        parsed.emplace_back(pointers[i], parse_errors[i]);
+    }
+    get_many<J,JReference>(root, parsed, out);
+    for (size_t i = 0; i < pointers.size(); ++i)
+    {
+        if (parse_errors[i])
+        {
+            out[i].value = nullptr;
+            out[i].ec = parse_errors[i];
+        }
+    }
+}
+
+}
+
+// Resolves many pointers at once, looking up the tokens that pointers have 
+// in common once. out[i] receives the value selected by pointers[i], or 
+// the error that prevented it being selected.
+template<class J>
+typename std::enable_if<is_accessible_by_reference<J>::value && !std::is_const<J>::value>::type
+get_many(J& root, 
+         const std::vector<basic_json_pointer<typename J::char_type>>& pointers, 
+         std::vector<get_result<J>>& out)
+{
+    detail::get_many<J,J&>(root, pointers, out);
+}
+
+template<class J>
+typename std::enable_if<is_accessible_by_reference<J>::value>::type
+get_many(const J& root, 
+         const std::vector<basic_json_pointer<typename J::char_type>>& pointers, 
+         std::vector<get_result<const J>>& out)
+{
+    detail::get_many<J,const J&>(root, pointers, out);
+}
+
+template<class J>
+typename std::enable_if<is_accessible_by_reference<J>::value && !std::is_const<J>::value>::type
+get_many(J& root, 
+         const std::vector<typename J::string_type>& pointers, 
+         std::vector<get_result<J>>& out)
+{
+    detail::get_many<J,J&>(root, pointers, out);
+}
+
+template<class J>
+typename std::enable_if<is_accessible_by_reference<J>::value>::type
+get_many(const J& root, 
+         const std::vector<typename J::string_type>& pointers, 
+         std::vector<get_result<const J>>& out)
+{
+    detail::get_many<J,const J&>(root, pointers, out);
+}
+
 template <class String>
 void escape(const String& s, std::basic_ostringstream<typename String::value_type>& os)
 {
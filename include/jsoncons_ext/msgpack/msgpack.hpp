@@ -10,15 +10,197 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <limits> // std::numeric_limits
 #include <type_traits> // std::enable_if
 #include <istream> // std::basic_istream
 #include <jsoncons/json.hpp>
 #include <jsoncons/config/binary_detail.hpp>
 #include <jsoncons_ext/msgpack/msgpack_serializer.hpp>
 #include <jsoncons_ext/msgpack/msgpack_reader.hpp>
+#include <jsoncons_ext/msgpack/msgpack_staj_reader.hpp>
 
 namespace jsoncons { namespace msgpack {
 
+namespace detail {
+
+// The number of bytes in the format and length of a str (fix_max 31) or 
+// of a map or array (fix_max 15), or 0 if the length is too large
+inline
+size_t header_length(uint64_t length, uint64_t fix_max)
+{
+    if (length <= fix_max)
+    {
+        return 1;
+    }
+    else if (fix_max == 31 && length <= 0xff)
+    {
+        return 2;
+    }
+    else if (length <= 0xffff)
+    {
+        return 3;
+    }
+    else if (length <= 0xffffffff)
+    {
+        return 5;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+// The number of bytes in a non-negative integer
+inline
+size_t uint64_length(uint64_t val)
+{
+    if (val <= 0x7f)
+    {
+        return 1;
+    }
+    else if (val <= 0xff)
+    {
+        return 2;
+    }
+    else if (val <= 0xffff)
+    {
+        return 3;
+    }
+    else if (val <= 0xffffffff)
+    {
+        return 5;
+    }
+    else
+    {
+        return 9;
+    }
+}
+
+// The number of bytes in a negative integer
+inline
+size_t negative_int64_length(int64_t val)
+{
+    if (val >= -32)
+    {
+        return 1;
+    }
+    else if (val >= (std::numeric_limits<int8_t>::lowest)())
+    {
+        return 2;
+    }
+    else if (val >= (std::numeric_limits<int16_t>::lowest)())
+    {
+        return 3;
+    }
+    else if (val >= (std::numeric_limits<int32_t>::lowest)())
+    {
+        return 5;
+    }
+    else
+    {
+        return 9;
+    }
+}
+
+// Adds the number of bytes that basic_msgpack_serializer writes for j to 
+// length, and returns true. Returns false if j has wide characters, or a
+// string, array or map that is too long for MessagePack, and then j is 
+// encoded without sizing it first.
+template<class Json>
+bool encoded_size(const Json& j, size_t& length)
+{
+    if (!std::is_same<typename Json::char_type,char>::value)
+    {
+        return false;
+    }
+    switch (j.structure_tag())
+    {
+        case structure_tag_type::null_tag:
+        case structure_tag_type::bool_tag:
+            length += 1;
+            return true;
+        case structure_tag_type::int64_tag:
+        {
+            int64_t val = j.template as_integer<int64_t>();
+            length += val >= 0 ? uint64_length(static_cast<uint64_t>(val)) : negative_int64_length(val);
+            return true;
+        }
+        case structure_tag_type::uint64_tag:
+            length += uint64_length(j.template as_integer<uint64_t>());
+            return true;
+        case structure_tag_type::double_tag:
+        {
+            double val = j.as_double();
+            length += (double)(float)val == val ? 5 : 9;
+            return true;
+        }
+        case structure_tag_type::short_string_tag:
+        case structure_tag_type::long_string_tag:
+        {
+            size_t n = j.as_string_view().length();
+            size_t header = header_length(n, 31);
+            length += header + n;
+            return header != 0;
+        }
+        case structure_tag_type::byte_string_tag:
+        {
+            // There is no fix format for bin, the smallest is bin 8
+            size_t n = j.as_byte_string_view().length();
+            size_t header = header_length(n, 31);
+            length += (header == 1 ? 2 : header) + n;
+            return header != 0;
+        }
+        case structure_tag_type::empty_object_tag:
+            length += 1;
+            return true;
+        case structure_tag_type::object_tag:
+        {
+            size_t header = header_length(j.size(), 15);
+            if (header == 0)
+            {
+                return false;
+            }
+            length += header;
+            for (const auto& member : j.object_range())
+            {
+                size_t n = member.key().length();
+                size_t key_header = header_length(n, 31);
+                if (key_header == 0)
+                {
+                    return false;
+                }
+                length += key_header + n;
+                if (!encoded_size(member.value(), length))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case structure_tag_type::array_tag:
+        {
+            size_t header = header_length(j.size(), 15);
+            if (header == 0)
+            {
+                return false;
+            }
+            length += header;
+            for (const auto& item : j.array_range())
+            {
+                if (!encoded_size(item, length))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+}
+
 // encode_msgpack
 
 template<class Json>
@@ -33,8 +215,28 @@ template<class Json>
 void encode_msgpack(const Json& j, std::vector<uint8_t>& v)
 {
     typedef typename Json::char_type char_type;
-    basic_msgpack_serializer<char_type,jsoncons::buffer_result> serializer(v);
-    j.dump(serializer);
+
+    // Size the encoding first, so that v is resized once and then 
+    // written without capacity checks
+    size_t length = 0;
+    if (!detail::encoded_size(j, length))
+    {
+        basic_msgpack_serializer<char_type,jsoncons::buffer_result> serializer(v);
+        j.dump(serializer);
+        return;
+    }
+    size_t offset = v.size();
+    v.resize(offset + length);
+    try
+    {
+        basic_msgpack_serializer<char_type,jsoncons::unchecked_buffer_result> serializer(v.data() + offset);
+        j.dump(serializer);
+    }
+    catch (...)
+    {
+        v.resize(offset);
+        throw;
+    }
 }
 
 // decode_msgpack
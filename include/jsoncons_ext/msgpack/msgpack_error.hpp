@@ -21,7 +21,9 @@ enum class msgpack_errc
     array_length_required,
     object_length_required,
     too_many_items,
-    too_few_items
+    too_few_items,
+    unknown_type,
+    expected_name
 };
 
 class msgpack_error_category_impl
@@ -50,6 +52,10 @@ public:
                 return "Too many items were added to a MessagePack object or array";
             case msgpack_errc::too_few_items:
                 return "Too few items were added to a MessagePack object or array";
+            case msgpack_errc::unknown_type:
+                return "An unknown type was found in the stream";
+            case msgpack_errc::expected_name:
+                return "Expected a string for a MessagePack map key";
             default:
                 return "Unknown MessagePack parser error";
         }
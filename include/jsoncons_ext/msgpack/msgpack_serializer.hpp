@@ -12,6 +12,7 @@
 #include <limits> // std::numeric_limits
 #include <memory>
 #include <utility> // std::move
+#include <type_traits> // std::is_same
 #include <jsoncons/json_exception.hpp>
 #include <jsoncons/jsoncons_utilities.hpp>
 #include <jsoncons/json_content_handler.hpp>
@@ -219,6 +220,22 @@ private:
     }
 
     void write_string_value(const string_view_type& sv) 
+    {
+        write_string_value(sv, std::is_same<CharT,char>());
+    }
+
+    // UTF-8 text is validated and written as is
+    void write_string_value(const string_view_type& sv, std::true_type) 
+    {
+        auto result = unicons::validate(sv.begin(), sv.end());
+        if (result.ec != unicons::conv_errc())
+        {
+            throw serialization_error(msgpack_errc::invalid_utf8_text_string);
+        }
+        write_text_string(reinterpret_cast<const uint8_t*>(sv.data()), sv.length());
+    }
+
+    void write_string_value(const string_view_type& sv, std::false_type) 
     {
         std::basic_string<uint8_t> target;
         auto result = unicons::convert(
@@ -228,8 +245,11 @@ private:
         {
             throw serialization_error(msgpack_errc::invalid_utf8_text_string);
         }
+        write_text_string(target.data(), target.length());
+    }
 
-        const size_t length = target.length();
+    void write_text_string(const uint8_t* data, size_t length) 
+    {
         if (length <= 31)
         {
             // fixstr stores a byte array whose length is upto 31 bytes
@@ -254,10 +274,7 @@ private:
             jsoncons::detail::to_big_endian(static_cast<uint32_t>(length),std::back_inserter(result_));
         }
 
-        for (auto c : target)
-        {
-            result_.push_back(c);
-        }
+        result_.insert(data, length);
     }
 
     bool do_byte_string_value(const byte_string_view& b, 
@@ -286,10 +303,7 @@ private:
             jsoncons::detail::to_big_endian(static_cast<uint32_t>(length),std::back_inserter(result_));
         }
 
-        for (auto c : b)
-        {
-            result_.push_back(c);
-        }
+        result_.insert(b.data(), length);
 
         end_value();
         return true;
@@ -0,0 +1,701 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_MSGPACK_MSGPACK_STAJ_READER_HPP
+#define JSONCONS_MSGPACK_MSGPACK_STAJ_READER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility> // std::move
+#include <system_error>
+#include <jsoncons/json.hpp>
+#include <jsoncons/source.hpp>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons/staj_reader.hpp>
+#include <jsoncons/json_staj_reader.hpp>
+#include <jsoncons/config/binary_detail.hpp>
+#include <jsoncons_ext/msgpack/msgpack_detail.hpp>
+#include <jsoncons_ext/msgpack/msgpack_error.hpp>
+
+namespace jsoncons { namespace msgpack {
+
+enum class msgpack_parse_mode {root,array,map_key,map_value};
+
+struct msgpack_parse_state
+{
+    msgpack_parse_mode mode;
+    size_t length;
+    size_t index;
+
+    msgpack_parse_state(msgpack_parse_mode mode, size_t length)
+        : mode(mode), length(length), index(0)
+    {
+    }
+};
+
+template <class Source>
+class basic_msgpack_staj_reader : public basic_staj_reader<char>, private virtual serializing_context
+{
+    Source source_;
+    basic_staj_event_handler<char> event_handler_;
+    default_basic_staj_filter<char> default_filter_;
+    basic_staj_filter<char>& filter_;
+    std::vector<msgpack_parse_state> state_stack_;
+    std::string buffer_;
+    std::vector<uint8_t> bytes_buffer_;
+    bool more_;
+    bool done_;
+
+    // Noncopyable and nonmoveable
+    basic_msgpack_staj_reader(const basic_msgpack_staj_reader&) = delete;
+    basic_msgpack_staj_reader& operator=(const basic_msgpack_staj_reader&) = delete;
+public:
+    basic_msgpack_staj_reader(Source source)
+        : basic_msgpack_staj_reader(std::move(source), default_filter_)
+    {
+    }
+
+    basic_msgpack_staj_reader(Source source, basic_staj_filter<char>& filter)
+       : source_(std::move(source)),
+         filter_(filter),
+         more_(true),
+         done_(false)
+    {
+        state_stack_.emplace_back(msgpack_parse_mode::root,0);
+        next();
+    }
+
+    basic_msgpack_staj_reader(Source source, std::error_code& ec)
+        : basic_msgpack_staj_reader(std::move(source), default_filter_, ec)
+    {
+    }
+
+    basic_msgpack_staj_reader(Source source,
+                              basic_staj_filter<char>& filter,
+                              std::error_code& ec)
+       : source_(std::move(source)),
+         filter_(filter),
+         more_(true),
+         done_(false)
+    {
+        state_stack_.emplace_back(msgpack_parse_mode::root,0);
+        next(ec);
+    }
+
+    bool done() const override
+    {
+        return done_;
+    }
+
+    const basic_staj_event<char>& current() const override
+    {
+        return event_handler_.event();
+    }
+
+    void accept(basic_json_content_handler<char>& handler) override
+    {
+        std::error_code ec;
+        accept(handler, ec);
+        if (ec)
+        {
+            throw serialization_error(ec,line_number(),column_number());
+        }
+    }
+
+    void accept(basic_json_content_handler<char>& handler,
+                std::error_code& ec) override
+    {
+        const basic_staj_event<char>& event = event_handler_.event();
+        switch (event.event_type())
+        {
+            case staj_event_type::begin_array:
+            case staj_event_type::begin_object:
+            {
+                // The begin event has already been read, its parse state
+                // is on top of the stack
+                const size_t level = state_stack_.size();
+                if (event.event_type() == staj_event_type::begin_array)
+                {
+                    more_ = handler.begin_array(state_stack_.back().length, event.semantic_tag(), *this);
+                }
+                else
+                {
+                    more_ = handler.begin_object(state_stack_.back().length, event.semantic_tag(), *this);
+                }
+                while (more_ && !ec && state_stack_.size() >= level)
+                {
+                    read_next(handler, ec);
+                }
+                break;
+            }
+            default:
+                jsoncons::detail::replay_staj_event(event, handler, *this);
+                break;
+        }
+    }
+
+    void next() override
+    {
+        std::error_code ec;
+        next(ec);
+        if (ec)
+        {
+            throw serialization_error(ec,line_number(),column_number());
+        }
+    }
+
+    void next(std::error_code& ec) override
+    {
+        do
+        {
+            read_next(event_handler_, ec);
+        }
+        while (!ec && !done() && !filter_.accept(event_handler_.event(), *this));
+    }
+
+    const serializing_context& context() const override
+    {
+        return *this;
+    }
+
+    size_t line_number() const override
+    {
+        return 0;
+    }
+
+    size_t column_number() const override
+    {
+        return source_.position();
+    }
+private:
+    // Steps over the remaining items of the innermost open container 
+    // using the length prefixes, without delivering any events
+    void do_skip_to_end_of_container(std::error_code& ec) override
+    {
+        if (state_stack_.back().mode == msgpack_parse_mode::root)
+        {
+            return;
+        }
+        const msgpack_parse_state& state = state_stack_.back();
+        size_t remaining = state.length - state.index;
+        switch (state.mode)
+        {
+            case msgpack_parse_mode::map_key:
+                remaining *= 2;
+                break;
+            case msgpack_parse_mode::map_value:
+                remaining = remaining*2 + 1;
+                break;
+            default:
+                break;
+        }
+        while (remaining > 0)
+        {
+            --remaining;
+            size_t count = 0;
+            skip_item(count, ec);
+            if (ec)
+            {
+                return;
+            }
+            remaining += count;
+        }
+        const bool is_array = state.mode == msgpack_parse_mode::array;
+        state_stack_.pop_back();
+        if (is_array)
+        {
+            event_handler_.end_array(*this);
+        }
+        else
+        {
+            event_handler_.end_object(*this);
+        }
+        end_item();
+    }
+
+
+    void read_next(basic_json_content_handler<char>& handler, std::error_code& ec)
+    {
+        more_ = true;
+        if (source_.is_error())
+        {
+            ec = msgpack_errc::source_error;
+            return;
+        }
+        if (done_)
+        {
+            ec = msgpack_errc::unexpected_eof;
+            return;
+        }
+        msgpack_parse_state& state = state_stack_.back();
+        switch (state.mode)
+        {
+            case msgpack_parse_mode::array:
+                if (state.index < state.length)
+                {
+                    ++state.index;
+                    read_item(handler, ec);
+                }
+                else
+                {
+                    state_stack_.pop_back();
+                    more_ = handler.end_array(*this);
+                    end_item();
+                }
+                break;
+            case msgpack_parse_mode::map_key:
+                if (state.index < state.length)
+                {
+                    ++state.index;
+                    state.mode = msgpack_parse_mode::map_value;
+                    read_name(handler, ec);
+                }
+                else
+                {
+                    state_stack_.pop_back();
+                    more_ = handler.end_object(*this);
+                    end_item();
+                }
+                break;
+            case msgpack_parse_mode::map_value:
+                state.mode = msgpack_parse_mode::map_key;
+                read_item(handler, ec);
+                break;
+            case msgpack_parse_mode::root:
+                read_item(handler, ec);
+                break;
+        }
+    }
+
+    void end_item()
+    {
+        if (state_stack_.back().mode == msgpack_parse_mode::root)
+        {
+            done_ = true;
+        }
+    }
+
+    void read_item(basic_json_content_handler<char>& handler, std::error_code& ec)
+    {
+        uint8_t type{};
+        if (source_.get(type) == 0)
+        {
+            ec = msgpack_errc::unexpected_eof;
+            return;
+        }
+
+        if (type <= 0xbf)
+        {
+            if (type <= 0x7f)
+            {
+                // positive fixint
+                more_ = handler.uint64_value(type, semantic_tag_type::none, *this);
+                end_item();
+            }
+            else if (type <= 0x8f)
+            {
+                // fixmap
+                begin_map(handler, type & 0x0f);
+            }
+            else if (type <= 0x9f)
+            {
+                // fixarray
+                begin_array(handler, type & 0x0f);
+            }
+            else
+            {
+                // fixstr
+                if (read_text_string(type & 0x1f, ec))
+                {
+                    more_ = handler.string_value(basic_string_view<char>(buffer_.data(),buffer_.length()), semantic_tag_type::none, *this);
+                    end_item();
+                }
+            }
+            return;
+        }
+        if (type >= 0xe0)
+        {
+            // negative fixint
+            more_ = handler.int64_value(static_cast<int8_t>(type), semantic_tag_type::none, *this);
+            end_item();
+            return;
+        }
+
+        switch (type)
+        {
+            case msgpack_format::nil_cd:
+                more_ = handler.null_value(semantic_tag_type::none, *this);
+                break;
+            case msgpack_format::true_cd:
+                more_ = handler.bool_value(true, semantic_tag_type::none, *this);
+                break;
+            case msgpack_format::false_cd:
+                more_ = handler.bool_value(false, semantic_tag_type::none, *this);
+                break;
+            case msgpack_format::float32_cd:
+            {
+                float val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.double_value(val, floating_point_options(), semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::float64_cd:
+            {
+                double val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.double_value(val, floating_point_options(), semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::uint8_cd:
+            {
+                uint8_t val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.uint64_value(val, semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::uint16_cd:
+            {
+                uint16_t val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.uint64_value(val, semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::uint32_cd:
+            {
+                uint32_t val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.uint64_value(val, semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::uint64_cd:
+            {
+                uint64_t val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.uint64_value(val, semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::int8_cd:
+            {
+                int8_t val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.int64_value(val, semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::int16_cd:
+            {
+                int16_t val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.int64_value(val, semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::int32_cd:
+            {
+                int32_t val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.int64_value(val, semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::int64_cd:
+            {
+                int64_t val{};
+                if (!read_number(val, ec)) return;
+                more_ = handler.int64_value(val, semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::str8_cd:
+            case msgpack_format::str16_cd:
+            case msgpack_format::str32_cd:
+            {
+                size_t len;
+                if (!read_length(type, msgpack_format::str8_cd, len, ec)) return;
+                if (!read_text_string(len, ec)) return;
+                more_ = handler.string_value(basic_string_view<char>(buffer_.data(),buffer_.length()), semantic_tag_type::none, *this);
+                break;
+            }
+            case msgpack_format::bin8_cd:
+            case msgpack_format::bin16_cd:
+            case msgpack_format::bin32_cd:
+            {
+                size_t len;
+                if (!read_length(type, msgpack_format::bin8_cd, len, ec)) return;
+                bytes_buffer_.clear();
+                bytes_buffer_.reserve(len);
+                source_.read(std::back_inserter(bytes_buffer_), len);
+                if (bytes_buffer_.size() != len)
+                {
+                    ec = msgpack_errc::unexpected_eof;
+                    return;
+                }
+                more_ = handler.byte_string_value(byte_string_view(bytes_buffer_.data(),bytes_buffer_.size()),
+                                          byte_string_chars_format::none,
+                                          semantic_tag_type::none,
+                                          *this);
+                break;
+            }
+            case msgpack_format::array16_cd:
+            {
+                uint16_t len{};
+                if (!read_number(len, ec)) return;
+                begin_array(handler, len);
+                return;
+            }
+            case msgpack_format::array32_cd:
+            {
+                uint32_t len{};
+                if (!read_number(len, ec)) return;
+                begin_array(handler, len);
+                return;
+            }
+            case msgpack_format::map16_cd:
+            {
+                uint16_t len{};
+                if (!read_number(len, ec)) return;
+                begin_map(handler, len);
+                return;
+            }
+            case msgpack_format::map32_cd:
+            {
+                uint32_t len{};
+                if (!read_number(len, ec)) return;
+                begin_map(handler, len);
+                return;
+            }
+            default:
+                ec = msgpack_errc::unknown_type;
+                return;
+        }
+        end_item();
+    }
+
+    // Steps over one item, setting count to the number of nested items
+    // that follow it if it is an array or map
+    void skip_item(size_t& count, std::error_code& ec)
+    {
+        uint8_t type{};
+        if (source_.get(type) == 0)
+        {
+            ec = msgpack_errc::unexpected_eof;
+            return;
+        }
+        if (type <= 0x7f || type >= 0xe0)
+        {
+            return;
+        }
+        if (type <= 0x8f)
+        {
+            count = (type & 0x0f)*2;
+            return;
+        }
+        if (type <= 0x9f)
+        {
+            count = type & 0x0f;
+            return;
+        }
+        if (type <= 0xbf)
+        {
+            skip_bytes(type & 0x1f, ec);
+            return;
+        }
+
+        switch (type)
+        {
+            case msgpack_format::nil_cd:
+            case msgpack_format::true_cd:
+            case msgpack_format::false_cd:
+                break;
+            case msgpack_format::uint8_cd:
+            case msgpack_format::int8_cd:
+                skip_bytes(1, ec);
+                break;
+            case msgpack_format::uint16_cd:
+            case msgpack_format::int16_cd:
+                skip_bytes(2, ec);
+                break;
+            case msgpack_format::float32_cd:
+            case msgpack_format::uint32_cd:
+            case msgpack_format::int32_cd:
+                skip_bytes(4, ec);
+                break;
+            case msgpack_format::float64_cd:
+            case msgpack_format::uint64_cd:
+            case msgpack_format::int64_cd:
+                skip_bytes(8, ec);
+                break;
+            case msgpack_format::str8_cd:
+            case msgpack_format::str16_cd:
+            case msgpack_format::str32_cd:
+            {
+                size_t len;
+                if (!read_length(type, msgpack_format::str8_cd, len, ec)) return;
+                skip_bytes(len, ec);
+                break;
+            }
+            case msgpack_format::bin8_cd:
+            case msgpack_format::bin16_cd:
+            case msgpack_format::bin32_cd:
+            {
+                size_t len;
+                if (!read_length(type, msgpack_format::bin8_cd, len, ec)) return;
+                skip_bytes(len, ec);
+                break;
+            }
+            case msgpack_format::array16_cd:
+            {
+                uint16_t len{};
+                if (!read_number(len, ec)) return;
+                count = len;
+                break;
+            }
+            case msgpack_format::array32_cd:
+            {
+                uint32_t len{};
+                if (!read_number(len, ec)) return;
+                count = len;
+                break;
+            }
+            case msgpack_format::map16_cd:
+            {
+                uint16_t len{};
+                if (!read_number(len, ec)) return;
+                count = static_cast<size_t>(len)*2;
+                break;
+            }
+            case msgpack_format::map32_cd:
+            {
+                uint32_t len{};
+                if (!read_number(len, ec)) return;
+                count = static_cast<size_t>(len)*2;
+                break;
+            }
+            default:
+                ec = msgpack_errc::unknown_type;
+                break;
+        }
+    }
+
+    void skip_bytes(size_t len, std::error_code& ec)
+    {
+        source_.ignore(len);
+        if (source_.eof() && len > 0)
+        {
+            ec = msgpack_errc::unexpected_eof;
+        }
+    }
+
+    void read_name(basic_json_content_handler<char>& handler, std::error_code& ec)
+    {
+        uint8_t type{};
+        if (source_.get(type) == 0)
+        {
+            ec = msgpack_errc::unexpected_eof;
+            return;
+        }
+
+        size_t len;
+        if (type >= 0xa0 && type <= 0xbf)
+        {
+            // fixstr
+            len = type & 0x1f;
+        }
+        else if (type == msgpack_format::str8_cd || type == msgpack_format::str16_cd || type == msgpack_format::str32_cd)
+        {
+            if (!read_length(type, msgpack_format::str8_cd, len, ec)) return;
+        }
+        else
+        {
+            ec = msgpack_errc::expected_name;
+            return;
+        }
+        if (!read_text_string(len, ec)) return;
+        more_ = handler.name(basic_string_view<char>(buffer_.data(),buffer_.length()), *this);
+    }
+
+    void begin_array(basic_json_content_handler<char>& handler, size_t length)
+    {
+        state_stack_.emplace_back(msgpack_parse_mode::array,length);
+        more_ = handler.begin_array(length, semantic_tag_type::none, *this);
+    }
+
+    void begin_map(basic_json_content_handler<char>& handler, size_t length)
+    {
+        state_stack_.emplace_back(msgpack_parse_mode::map_key,length);
+        more_ = handler.begin_object(length, semantic_tag_type::none, *this);
+    }
+
+    // Reads the 8, 16 or 32 bit length that follows a str/bin type code,
+    // base is the 8 bit code of the family
+    bool read_length(uint8_t type, uint8_t base, size_t& len, std::error_code& ec)
+    {
+        switch (type - base)
+        {
+            case 0:
+            {
+                uint8_t n{};
+                if (!read_number(n, ec)) return false;
+                len = n;
+                break;
+            }
+            case 1:
+            {
+                uint16_t n{};
+                if (!read_number(n, ec)) return false;
+                len = n;
+                break;
+            }
+            default:
+            {
+                uint32_t n{};
+                if (!read_number(n, ec)) return false;
+                len = n;
+                break;
+            }
+        }
+        return true;
+    }
+
+    template <class T>
+    bool read_number(T& val, std::error_code& ec)
+    {
+        uint8_t buf[sizeof(T)];
+        if (source_.read(buf, sizeof(T)) != sizeof(T))
+        {
+            ec = msgpack_errc::unexpected_eof;
+            return false;
+        }
+        const uint8_t* endp;
+        val = jsoncons::detail::from_big_endian<T>(buf,buf+sizeof(buf),&endp);
+        return true;
+    }
+
+    bool read_text_string(size_t len, std::error_code& ec)
+    {
+        buffer_.clear();
+        buffer_.reserve(len);
+        source_.read(std::back_inserter(buffer_), len);
+        if (buffer_.length() != len)
+        {
+            ec = msgpack_errc::unexpected_eof;
+            return false;
+        }
+        auto result = unicons::validate(buffer_.begin(),buffer_.end());
+        if (result.ec != unicons::conv_errc())
+        {
+            ec = msgpack_errc::invalid_utf8_text_string;
+            return false;
+        }
+        return true;
+    }
+};
+
+typedef basic_msgpack_staj_reader<jsoncons::binary_stream_source> msgpack_staj_reader;
+
+typedef basic_msgpack_staj_reader<jsoncons::buffer_source> msgpack_buffer_staj_reader;
+
+}}
+
+#endif
+
@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <limits> // std::numeric_limits
 #include <type_traits> // std::enable_if
 #include <istream> // std::basic_istream
 #include <jsoncons/json.hpp>
@@ -19,6 +20,159 @@
 
 namespace jsoncons { namespace ubjson {
 
+namespace detail {
+
+// The number of bytes in the type marker and value of a length, or 0 
+// if the length is not sized
+inline
+size_t length_length(uint64_t length)
+{
+    if (length <= (std::numeric_limits<uint8_t>::max)())
+    {
+        return 2;
+    }
+    else if (length <= (std::numeric_limits<int16_t>::max)())
+    {
+        return 3;
+    }
+    else if (length <= (std::numeric_limits<int32_t>::max)())
+    {
+        return 5;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+// Adds the number of bytes that basic_ubjson_serializer writes for j to 
+// length, and returns true. Returns false if j has wide characters, an 
+// unsigned integer that does not fit in int64, or a string, array or map 
+// with a length that does not fit in int32, and then j is encoded without 
+// sizing it first.
+template<class Json>
+bool encoded_size(const Json& j, size_t& length)
+{
+    if (!std::is_same<typename Json::char_type,char>::value)
+    {
+        return false;
+    }
+    switch (j.structure_tag())
+    {
+        case structure_tag_type::null_tag:
+        case structure_tag_type::bool_tag:
+            length += 1;
+            return true;
+        case structure_tag_type::int64_tag:
+        {
+            int64_t val = j.template as_integer<int64_t>();
+            if (val >= 0)
+            {
+                size_t n = length_length(static_cast<uint64_t>(val));
+                length += n != 0 ? n : 9;
+            }
+            else if (val >= (std::numeric_limits<int8_t>::lowest)())
+            {
+                length += 2;
+            }
+            else if (val >= (std::numeric_limits<int16_t>::lowest)())
+            {
+                length += 3;
+            }
+            else if (val >= (std::numeric_limits<int32_t>::lowest)())
+            {
+                length += 5;
+            }
+            else
+            {
+                length += 9;
+            }
+            return true;
+        }
+        case structure_tag_type::uint64_tag:
+        {
+            uint64_t val = j.template as_integer<uint64_t>();
+            if (val > static_cast<uint64_t>((std::numeric_limits<int64_t>::max)()))
+            {
+                return false;
+            }
+            size_t n = length_length(val);
+            length += n != 0 ? n : 9;
+            return true;
+        }
+        case structure_tag_type::double_tag:
+        {
+            double val = j.as_double();
+            length += (double)(float)val == val ? 5 : 9;
+            return true;
+        }
+        case structure_tag_type::short_string_tag:
+        case structure_tag_type::long_string_tag:
+        {
+            size_t n = j.as_string_view().length();
+            size_t header = length_length(n);
+            length += 1 + header + n;
+            return header != 0;
+        }
+        case structure_tag_type::byte_string_tag:
+        {
+            // An array of uint8 with a type marker
+            size_t n = j.as_byte_string_view().length();
+            size_t header = length_length(n);
+            length += 3 + header + n;
+            return header != 0;
+        }
+        case structure_tag_type::empty_object_tag:
+            length += 2 + length_length(0);
+            return true;
+        case structure_tag_type::object_tag:
+        {
+            size_t header = length_length(j.size());
+            if (header == 0)
+            {
+                return false;
+            }
+            length += 2 + header;
+            for (const auto& member : j.object_range())
+            {
+                size_t n = member.key().length();
+                size_t key_header = length_length(n);
+                if (key_header == 0)
+                {
+                    return false;
+                }
+                length += key_header + n;
+                if (!encoded_size(member.value(), length))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case structure_tag_type::array_tag:
+        {
+            size_t header = length_length(j.size());
+            if (header == 0)
+            {
+                return false;
+            }
+            length += 2 + header;
+            for (const auto& item : j.array_range())
+            {
+                if (!encoded_size(item, length))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+}
+
 // encode_ubjson
 
 template<class Json>
@@ -33,8 +187,28 @@ template<class Json>
 void encode_ubjson(const Json& j, std::vector<uint8_t>& v)
 {
     typedef typename Json::char_type char_type;
-    basic_ubjson_serializer<char_type,jsoncons::buffer_result> serializer(v);
-    j.dump(serializer);
+
+    // Size the encoding first, so that v is resized once and then 
+    // written without capacity checks
+    size_t length = 0;
+    if (!detail::encoded_size(j, length))
+    {
+        basic_ubjson_serializer<char_type,jsoncons::buffer_result> serializer(v);
+        j.dump(serializer);
+        return;
+    }
+    size_t offset = v.size();
+    v.resize(offset + length);
+    try
+    {
+        basic_ubjson_serializer<char_type,jsoncons::unchecked_buffer_result> serializer(v.data() + offset);
+        j.dump(serializer);
+    }
+    catch (...)
+    {
+        v.resize(offset);
+        throw;
+    }
 }
 
 // decode_ubjson
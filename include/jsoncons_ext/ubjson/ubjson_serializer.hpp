@@ -12,6 +12,7 @@
 #include <limits> // std::numeric_limits
 #include <memory>
 #include <utility> // std::move
+#include <type_traits> // std::is_same
 #include <jsoncons/json_exception.hpp>
 #include <jsoncons/jsoncons_utilities.hpp>
 #include <jsoncons/json_content_handler.hpp>
@@ -181,6 +182,24 @@ private:
     }
 
     bool do_name(const string_view_type& name, const serializing_context&) override
+    {
+        write_name(name, std::is_same<CharT,char>());
+        return true;
+    }
+
+    // UTF-8 text is validated and written as is
+    void write_name(const string_view_type& name, std::true_type)
+    {
+        auto result = unicons::validate(name.begin(), name.end());
+        if (result.ec != unicons::conv_errc())
+        {
+            throw serialization_error(ubjson_errc::invalid_utf8_text_string);
+        }
+        put_length(name.length());
+        result_.insert(reinterpret_cast<const uint8_t*>(name.data()), name.length());
+    }
+
+    void write_name(const string_view_type& name, std::false_type)
     {
         std::basic_string<uint8_t> target;
         auto result = unicons::convert(
@@ -192,12 +211,7 @@ private:
         }
 
         put_length(target.length());
-
-        for (auto c : target)
-        {
-            result_.push_back(c);
-        }
-        return true;
+        result_.insert(target.data(), target.length());
     }
 
     bool do_null_value(semantic_tag_type, const serializing_context&) override
@@ -225,24 +239,37 @@ private:
             }
         }
 
-        std::basic_string<uint8_t> target;
-        auto result = unicons::convert(
-            sv.begin(), sv.end(), std::back_inserter(target), 
-            unicons::conv_flags::strict);
+        write_string(sv, std::is_same<CharT,char>());
+
+        end_value();
+        return true;
+    }
+
+    // UTF-8 text is validated and written as is
+    void write_string(const string_view_type& sv, std::true_type)
+    {
+        auto result = unicons::validate(sv.begin(), sv.end());
         if (result.ec != unicons::conv_errc())
         {
             JSONCONS_THROW(json_exception_impl<std::runtime_error>("Illegal unicode"));
         }
-
         put_length(sv.length());
+        result_.insert(reinterpret_cast<const uint8_t*>(sv.data()), sv.length());
+    }
 
-        for (auto c : target)
+    void write_string(const string_view_type& sv, std::false_type)
+    {
+        std::basic_string<uint8_t> target;
+        auto result = unicons::convert(
+            sv.begin(), sv.end(), std::back_inserter(target), 
+            unicons::conv_flags::strict);
+        if (result.ec != unicons::conv_errc())
         {
-            result_.push_back(c);
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Illegal unicode"));
         }
 
-        end_value();
-        return true;
+        put_length(target.length());
+        result_.insert(target.data(), target.length());
     }
 
     void put_length(size_t length)
@@ -280,11 +307,7 @@ private:
         jsoncons::detail::to_big_endian(static_cast<uint8_t>(ubjson_format::type_marker), std::back_inserter(result_));
         jsoncons::detail::to_big_endian(static_cast<uint8_t>(ubjson_format::uint8_type), std::back_inserter(result_));
         put_length(length);
-
-        for (auto c : b)
-        {
-            result_.push_back(c);
-        }
+        result_.insert(b.data(), length);
 
         end_value();
         return true;
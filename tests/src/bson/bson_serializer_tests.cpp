@@ -246,3 +246,25 @@ TEST_CASE("serialize to bson")
     }
 }
 
+
+TEST_CASE("serialize documents one after another to bson")
+{
+    json j1 = json::parse(R"({"a":1,"b":"text"})");
+    json j2 = json::parse(R"({"c":[1.5,true]})");
+
+    std::vector<uint8_t> v1;
+    encode_bson(j1, v1);
+    std::vector<uint8_t> v2;
+    encode_bson(j2, v2);
+
+    // Each document is written to the result when it ends
+    std::vector<uint8_t> v;
+    bson_buffer_serializer serializer(v);
+    j1.dump(serializer);
+    CHECK(v == v1);
+    j2.dump(serializer);
+
+    std::vector<uint8_t> expected(v1);
+    expected.insert(expected.end(), v2.begin(), v2.end());
+    CHECK(v == expected);
+}
@@ -0,0 +1,205 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h"
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+#include <limits>
+#include <catch/catch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+namespace {
+
+std::vector<uint8_t> encode_canonical(const ojson& j)
+{
+    std::vector<uint8_t> buffer;
+    encode_cbor(j, buffer, cbor_options().canonical(true));
+    return buffer;
+}
+
+}
+
+TEST_CASE("cbor canonical map key order")
+{
+    // Keys are ordered by their encoded bytes, so shorter strings come first
+    ojson j = ojson::parse(R"({"bb":1,"a":2,"aa":3,"b":4})");
+    std::vector<uint8_t> expected = {0xa4,
+                                     0x61,'a',0x02,
+                                     0x61,'b',0x04,
+                                     0x62,'a','a',0x03,
+                                     0x62,'b','b',0x01};
+    CHECK(encode_canonical(j) == expected);
+
+    // The same content in any order gives the same bytes
+    ojson k = ojson::parse(R"({"b":4,"aa":3,"bb":1,"a":2})");
+    CHECK(encode_canonical(k) == expected);
+
+    // sorted json gives the same bytes
+    json l = json::parse(R"({"bb":1,"a":2,"aa":3,"b":4})");
+    std::vector<uint8_t> buffer;
+    encode_cbor(l, buffer, cbor_options().canonical(true));
+    CHECK(buffer == expected);
+
+    CHECK(decode_cbor<json>(expected) == l);
+}
+
+TEST_CASE("cbor canonical nested maps")
+{
+    ojson j = ojson::parse(R"(
+    {
+        "zebra": {"y": [1, {"d": 1, "c": 2}], "x": null},
+        "ant": [{"q": true, "p": false}],
+        "m": "value"
+    }
+    )");
+    ojson k = ojson::parse(R"(
+    {
+        "m": "value",
+        "ant": [{"p": false, "q": true}],
+        "zebra": {"x": null, "y": [1, {"c": 2, "d": 1}]}
+    }
+    )");
+    std::vector<uint8_t> a = encode_canonical(j);
+    std::vector<uint8_t> b = encode_canonical(k);
+    CHECK(a == b);
+    CHECK(decode_cbor<json>(a) == decode_cbor<json>(b));
+    CHECK(decode_cbor<ojson>(a) == ojson::parse(R"({"m":"value","ant":[{"p":false,"q":true}],"zebra":{"x":null,"y":[1,{"c":2,"d":1}]}})"));
+}
+
+TEST_CASE("cbor canonical definite lengths")
+{
+    std::vector<uint8_t> buffer;
+    cbor_buffer_serializer serializer(buffer, cbor_options().canonical(true));
+    serializer.begin_object(); 
+    serializer.name("b");
+    serializer.begin_array();
+    for (int i = 0; i < 30; ++i)
+    {
+        serializer.uint64_value(i);
+    }
+    serializer.end_array();
+    serializer.name("a");
+    serializer.begin_array();
+    serializer.end_array();
+    serializer.end_object();
+    serializer.flush();
+
+    REQUIRE(buffer.size() == 1 + 2 + 1 + 2 + 2 + 24 + 2*6);
+    CHECK(buffer[0] == 0xa2);
+    CHECK(buffer[1] == 0x61);
+    CHECK(buffer[2] == 'a');
+    CHECK(buffer[3] == 0x80);
+    CHECK(buffer[4] == 0x61);
+    CHECK(buffer[5] == 'b');
+    CHECK(buffer[6] == 0x98);
+    CHECK(buffer[7] == 30);
+
+    json j = decode_cbor<json>(buffer);
+    CHECK(j["b"].size() == 30);
+    CHECK(j["a"].empty());
+}
+
+TEST_CASE("cbor canonical floating point")
+{
+    std::vector<uint8_t> buffer;
+    encode_cbor(json(1.5), buffer, cbor_options().canonical(true));
+    CHECK(buffer == std::vector<uint8_t>{0xf9,0x3e,0x00});
+
+    buffer.clear();
+    encode_cbor(json(100000.0), buffer, cbor_options().canonical(true));
+    CHECK(buffer == std::vector<uint8_t>{0xfa,0x47,0xc3,0x50,0x00});
+
+    buffer.clear();
+    encode_cbor(json(1.1), buffer, cbor_options().canonical(true));
+    CHECK(buffer == std::vector<uint8_t>{0xfb,0x3f,0xf1,0x99,0x99,0x99,0x99,0x99,0x9a});
+
+    buffer.clear();
+    encode_cbor(json(std::numeric_limits<double>::quiet_NaN()), buffer, cbor_options().canonical(true));
+    CHECK(buffer == std::vector<uint8_t>{0xf9,0x7e,0x00});
+
+    buffer.clear();
+    encode_cbor(json(-std::numeric_limits<double>::infinity()), buffer, cbor_options().canonical(true));
+    CHECK(buffer == std::vector<uint8_t>{0xf9,0xfc,0x00});
+
+    // The default encoding is unchanged
+    buffer.clear();
+    encode_cbor(json(1.5), buffer);
+    CHECK(buffer == std::vector<uint8_t>{0xfa,0x3f,0xc0,0x00,0x00});
+}
+
+TEST_CASE("cbor canonical tagged values and typed arrays")
+{
+    ojson j;
+    j["z"] = ojson("2018-10-19 12:41:07-07:00", semantic_tag_type::date_time);
+    j["y"] = ojson(bignum("-18446744073709551617"));
+    j["x"] = ojson("273.15", semantic_tag_type::big_decimal);
+    std::vector<uint8_t> buffer = encode_canonical(j);
+    ojson j2 = decode_cbor<ojson>(buffer);
+    CHECK(j2.object_range().begin()->key() == "x");
+    CHECK(j2["x"].semantic_tag() == semantic_tag_type::big_decimal);
+    CHECK(j2["y"].as<std::string>() == "-18446744073709551617");
+    CHECK(j2["z"].as<std::string>() == "2018-10-19 12:41:07-07:00");
+
+    // Typed arrays are big endian
+    std::vector<uint16_t> v = {1, 2};
+    buffer.clear();
+    cbor_buffer_serializer serializer(buffer, cbor_options().canonical(true));
+    serializer.typed_array(v.data(), v.size());
+    serializer.flush();
+    CHECK(buffer == std::vector<uint8_t>{0xd8,0x41,0x44,0x00,0x01,0x00,0x02});
+    CHECK(decode_cbor<std::vector<uint16_t>>(buffer) == v);
+
+    // Stringrefs are not used
+    json records = json::parse(R"([{"name":"repeated"},{"name":"repeated"}])");
+    buffer.clear();
+    encode_cbor(records, buffer, cbor_options().canonical(true).pack_strings(true));
+    std::vector<uint8_t> plain;
+    encode_cbor(records, plain, cbor_options().canonical(true));
+    CHECK(buffer == plain);
+}
+
+TEST_CASE("cbor canonical stream and sequence")
+{
+    ojson j = ojson::parse(R"({"b":[1,2],"a":{"d":1,"c":2}})");
+    std::vector<uint8_t> expected = encode_canonical(j);
+
+    std::ostringstream os;
+    cbor_serializer serializer(os, cbor_options().canonical(true));
+    j.dump(serializer);
+    j.dump(serializer);
+    serializer.flush();
+    std::string s = os.str();
+    std::vector<uint8_t> twice = expected;
+    twice.insert(twice.end(), expected.begin(), expected.end());
+    CHECK(std::vector<uint8_t>(s.begin(), s.end()) == twice);
+}
+
+TEST_CASE("canonicalize_cbor")
+{
+    // {_ "b": [_ 1, 2], "a": 1.5}, indefinite lengths and a single precision float
+    std::vector<uint8_t> input = {0xbf,0x61,'b',0x9f,0x01,0x02,0xff,0x61,'a',0xfa,0x3f,0xc0,0x00,0x00,0xff};
+    std::vector<uint8_t> expected = {0xa2,0x61,'a',0xf9,0x3e,0x00,0x61,'b',0x82,0x01,0x02};
+
+    std::vector<uint8_t> result;
+    canonicalize_cbor(cbor_view(input), result);
+    CHECK(result == expected);
+
+    // Canonical input is unchanged
+    std::vector<uint8_t> again;
+    canonicalize_cbor(cbor_view(result), again);
+    CHECK(again == expected);
+
+    // Stringrefs are resolved
+    ojson records = ojson::parse(R"([{"name":"repeated","id":1},{"name":"repeated","id":2}])");
+    std::vector<uint8_t> packed;
+    encode_cbor(records, packed, cbor_options().pack_strings(true));
+    std::vector<uint8_t> canonical;
+    canonicalize_cbor(cbor_view(packed), canonical);
+    CHECK(canonical == encode_canonical(records));
+}
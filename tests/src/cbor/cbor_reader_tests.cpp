@@ -458,3 +458,96 @@ TEST_CASE("Compare CBOR packed item and jsoncons item")
     }
 }
 
+
+namespace {
+
+// Records whether the strings it sees point into the input buffer
+class string_location_filter : public basic_json_filter<char>
+{
+    const uint8_t* first_;
+    const uint8_t* last_;
+public:
+    std::vector<bool> in_buffer;
+
+    string_location_filter(json_content_handler& handler, const std::vector<uint8_t>& buffer)
+        : basic_json_filter<char>(handler), first_(buffer.data()), last_(buffer.data() + buffer.size())
+    {
+    }
+private:
+    void record(const void* p)
+    {
+        auto q = static_cast<const uint8_t*>(p);
+        in_buffer.push_back(q >= first_ && q < last_);
+    }
+
+    bool do_name(const string_view_type& name, const serializing_context& context) override
+    {
+        record(name.data());
+        return destination_handler().name(name, context);
+    }
+
+    bool do_string_value(const string_view_type& value, semantic_tag_type tag, const serializing_context& context) override
+    {
+        record(value.data());
+        return destination_handler().string_value(value, tag, context);
+    }
+
+    bool do_byte_string_value(const byte_string_view& b, byte_string_chars_format encoding_hint,
+                              semantic_tag_type tag, const serializing_context& context) override
+    {
+        record(b.data());
+        return destination_handler().byte_string_value(b, encoding_hint, tag, context);
+    }
+};
+
+}
+
+TEST_CASE("cbor_buffer_reader strings are views into the buffer")
+{
+    // {"name": "value", "bytes": h'0102', "chunked": (_ "ab", "cd")}
+    std::vector<uint8_t> buffer = {0xa3,
+                                   0x64,'n','a','m','e',0x65,'v','a','l','u','e',
+                                   0x65,'b','y','t','e','s',0x42,0x01,0x02,
+                                   0x67,'c','h','u','n','k','e','d',0x7f,0x62,'a','b',0x62,'c','d',0xff};
+
+    json_decoder<json> decoder;
+    string_location_filter filter(decoder, buffer);
+    cbor_buffer_reader reader(buffer, filter);
+    std::error_code ec;
+    reader.read(ec);
+    REQUIRE_FALSE(ec);
+
+    json expected;
+    expected["name"] = "value";
+    expected["bytes"] = byte_string({0x01,0x02});
+    expected["chunked"] = "abcd";
+    CHECK(decoder.get_result() == expected);
+    // Indefinite length strings are joined in a scratch buffer
+    CHECK(filter.in_buffer == std::vector<bool>{true, true, true, true, true, false});
+
+    // A stream source reads strings into the scratch buffer 
+    std::string s(buffer.begin(), buffer.end());
+    std::istringstream is(s);
+    json_decoder<json> decoder2;
+    cbor_reader stream_reader(is, decoder2);
+    stream_reader.read(ec);
+    REQUIRE_FALSE(ec);
+    CHECK(decoder2.get_result() == expected);
+}
+
+TEST_CASE("cbor_buffer_reader truncated strings")
+{
+    std::vector<std::vector<uint8_t>> inputs = {{0x65,'v','a','l'},
+                                                {0x44,0x01,0x02},
+                                                {0x7f,0x62,'a','b',0x62,'c'},
+                                                {0x7f,0x62,'a','b'},
+                                                {0xa1,0x64,'n','a'}};
+    for (const auto& input : inputs)
+    {
+        json_decoder<json> decoder;
+        cbor_buffer_reader reader(input, decoder);
+        std::error_code ec;
+        reader.read(ec);
+        CHECK(ec == cbor_errc::unexpected_eof);
+    }
+}
@@ -0,0 +1,151 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h"
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <catch/catch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+namespace {
+
+std::vector<json> make_events(size_t count)
+{
+    std::vector<json> events;
+    for (size_t i = 0; i < count; ++i)
+    {
+        json event;
+        event["sequence"] = i;
+        event["message"] = "event " + std::to_string(i);
+        if (i % 3 == 0)
+        {
+            event["values"] = json::array{1.5, i, "text"};
+        }
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+}
+
+TEST_CASE("cbor sequence encode and decode")
+{
+    // 1, "a", [2]
+    std::vector<uint8_t> expected = {0x01,0x61,'a',0x81,0x02};
+
+    std::vector<uint8_t> buffer;
+    encode_cbor_sequence(json(1), buffer);
+    encode_cbor_sequence(json("a"), buffer);
+    encode_cbor_sequence(json(json::array{2}), buffer);
+    CHECK(buffer == expected);
+
+    std::vector<json> values = {json(1), json("a"), json(json::array{2})};
+    std::vector<uint8_t> buffer2;
+    encode_cbor_sequence(values.begin(), values.end(), buffer2);
+    CHECK(buffer2 == expected);
+
+    std::ostringstream os;
+    for (const auto& val : values)
+    {
+        encode_cbor_sequence(val, os);
+    }
+    std::string s = os.str();
+    CHECK(std::vector<uint8_t>(s.begin(), s.end()) == expected);
+
+    CHECK(decode_cbor_sequence<json>(buffer) == values);
+
+    std::istringstream is(s);
+    CHECK(decode_cbor_sequence<json>(is) == values);
+
+    // An empty sequence has no items
+    CHECK(decode_cbor_sequence<json>(std::vector<uint8_t>()).empty());
+}
+
+TEST_CASE("cbor sequence parallel decode")
+{
+    std::vector<json> events = make_events(1000);
+    std::vector<uint8_t> buffer;
+    encode_cbor_sequence(events.begin(), events.end(), buffer);
+
+    cbor_sequence_reader reader(buffer);
+    REQUIRE(reader.size() == events.size());
+    CHECK(reader[500]["message"].as<std::string>() == "event 500");
+
+    CHECK(reader.decode<json>() == events);
+    CHECK(reader.decode<json>(4) == events);
+    CHECK(decode_cbor_sequence<json>(buffer, 3) == events);
+
+    // More threads than items
+    std::vector<uint8_t> small;
+    encode_cbor_sequence(events.begin(), events.begin() + 2, small);
+    CHECK(decode_cbor_sequence<json>(small, 8) == std::vector<json>(events.begin(), events.begin() + 2));
+
+    std::vector<wjson> wevents = decode_cbor_sequence<wjson>(buffer, 2);
+    REQUIRE(wevents.size() == events.size());
+    CHECK(wevents[999][L"message"].as<std::wstring>() == L"event 999");
+}
+
+TEST_CASE("cbor sequence per thread handlers")
+{
+    std::vector<json> events = make_events(100);
+    std::vector<uint8_t> buffer;
+    encode_cbor_sequence(events.begin(), events.end(), buffer);
+    cbor_sequence_reader reader(buffer);
+
+    // Each handler writes its items, in order, as a JSON text sequence
+    std::vector<std::string> outputs(3);
+    std::vector<std::unique_ptr<json_compressed_string_serializer>> serializers;
+    std::vector<json_content_handler*> handlers;
+    for (auto& output : outputs)
+    {
+        serializers.emplace_back(new json_compressed_string_serializer(output));
+        handlers.push_back(serializers.back().get());
+    }
+    std::error_code ec;
+    reader.read(handlers, ec);
+    REQUIRE_FALSE(ec);
+
+    std::string expected;
+    for (const auto& event : events)
+    {
+        expected.append(event.to_string());
+    }
+    CHECK(outputs[0] + outputs[1] + outputs[2] == expected);
+    CHECK(outputs[0].substr(0, events[0].to_string().size()) == events[0].to_string());
+}
+
+TEST_CASE("cbor sequence errors")
+{
+    std::vector<json> events = make_events(10);
+    std::vector<uint8_t> buffer;
+    encode_cbor_sequence(events.begin(), events.end(), buffer);
+
+    SECTION("truncated last item")
+    {
+        buffer.pop_back();
+        CHECK_THROWS_AS(cbor_sequence_reader(buffer), serialization_error);
+        CHECK_THROWS_AS(decode_cbor_sequence<json>(buffer, 2), serialization_error);
+
+        std::error_code ec;
+        cbor_sequence_reader reader(buffer.data(), buffer.size(), ec);
+        CHECK(ec == cbor_errc::unexpected_eof);
+        CHECK(reader.size() == 0);
+
+        std::string s(buffer.begin(), buffer.end());
+        std::istringstream is(s);
+        CHECK_THROWS_AS(decode_cbor_sequence<json>(is), serialization_error);
+    }
+
+    SECTION("invalid utf8 in an item")
+    {
+        std::vector<uint8_t> bad = {0x01,0x62,0xff,0xfe,0x02};
+        CHECK_THROWS_AS(decode_cbor_sequence<json>(bad, 2), serialization_error);
+    }
+}
@@ -0,0 +1,221 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h"
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+#include <catch/catch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+namespace {
+
+byte_string as_bytes(const std::string& s)
+{
+    return byte_string(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+}
+
+json make_records(size_t count)
+{
+    const char* cities[] = {"Springfield", "Shelbyville", "Capital City"};
+    json j = json::array();
+    for (size_t i = 0; i < count; ++i)
+    {
+        json record;
+        record["customer_id"] = i;
+        record["customer_name"] = "Customer " + std::to_string(i % 10);
+        record["city"] = cities[i % 3];
+        record["status"] = "active";
+        j.push_back(std::move(record));
+    }
+    return j;
+}
+
+}
+
+TEST_CASE("cbor stringref example")
+{
+    // The example of the stringref specification, with byte strings
+    const char* strings[] = {"1", "222", "333", "4", "555", "666", "777", "888", "999",
+                             "aaa", "bbb", "ccc", "ddd", "eee", "fff", "ggg", "hhh", "iii",
+                             "jjj", "kkk", "lll", "mmm", "nnn", "ooo", "ppp", "qqq", "rrr",
+                             "333", "ssss", "qqq", "rrr", "ssss"};
+    json j = json::array();
+    std::vector<uint8_t> expected = {0xd9,0x01,0x00,0x98,0x20};
+    for (size_t i = 0; i < 27; ++i)
+    {
+        std::string s = strings[i];
+        j.emplace_back(as_bytes(s));
+        expected.push_back(static_cast<uint8_t>(0x40 + s.size()));
+        expected.insert(expected.end(), s.begin(), s.end());
+    }
+    for (size_t i = 27; i < 32; ++i)
+    {
+        std::string s = strings[i];
+        j.emplace_back(as_bytes(s));
+    }
+    std::vector<uint8_t> tail = {0xd8,0x19,0x01, // "333"
+                                 0x44,'s','s','s','s',
+                                 0xd8,0x19,0x17, // "qqq"
+                                 0x43,'r','r','r', // too short for the 25th string
+                                 0xd8,0x19,0x18,0x18}; // "ssss"
+    expected.insert(expected.end(), tail.begin(), tail.end());
+
+    std::vector<uint8_t> buffer;
+    encode_cbor(j, buffer, cbor_options().pack_strings(true));
+    CHECK(buffer == expected);
+
+    CHECK(decode_cbor<json>(buffer) == j);
+
+    cbor_view v(buffer);
+    CHECK(v[27].as_byte_string() == as_bytes("333"));
+    CHECK(v[31].as_byte_string() == as_bytes("ssss"));
+    CHECK(v.indexed()[29].as_byte_string() == as_bytes("qqq"));
+}
+
+TEST_CASE("cbor stringref records")
+{
+    json j = make_records(100);
+
+    std::vector<uint8_t> plain;
+    encode_cbor(j, plain);
+    std::vector<uint8_t> packed;
+    encode_cbor(j, packed, cbor_options().pack_strings(true));
+
+    CHECK(packed.size() < plain.size()/2);
+
+    SECTION("cbor_reader")
+    {
+        CHECK(decode_cbor<json>(packed) == j);
+
+        std::string s(packed.begin(), packed.end());
+        std::istringstream is(s);
+        CHECK(decode_cbor<json>(is) == j);
+
+        CHECK(decode_cbor<wjson>(packed) == decode_cbor<wjson>(plain));
+    }
+
+    SECTION("cbor_view")
+    {
+        cbor_view v(packed);
+        REQUIRE(v.size() == 100);
+        CHECK(v[49]["city"].as<std::string>() == "Shelbyville");
+        CHECK(v[99]["customer_name"].as<std::string>() == "Customer 9");
+        CHECK(v[99].contains("status"));
+
+        json j2;
+        std::string s;
+        v.dump(s);
+        CHECK(json::parse(s) == j);
+
+        CHECK(decode_cbor<json>(v[42]) == j[42]);
+    }
+
+    SECTION("indexed cbor_view")
+    {
+        cbor_view v = cbor_view(packed).indexed();
+        for (size_t i = 0; i < 100; ++i)
+        {
+            CHECK(v[i]["customer_id"].as<size_t>() == i);
+            CHECK(v[i]["customer_name"].as<std::string>() == j[i]["customer_name"].as<std::string>());
+            CHECK(v[i].at("city").as<std::string>() == j[i]["city"].as<std::string>());
+        }
+        std::string s;
+        v.dump(s);
+        CHECK(json::parse(s) == j);
+    }
+}
+
+TEST_CASE("cbor stringref with tagged strings")
+{
+    // Tagged strings are added to the namespace but not replaced by stringrefs
+    ojson j = ojson::array();
+    j.emplace_back("2018-10-19 12:41:07-07:00", semantic_tag_type::date_time);
+    j.emplace_back("2018-10-19 12:41:07-07:00", semantic_tag_type::date_time);
+    j.emplace_back(byte_string({'H','e','l','l','o'}), byte_string_chars_format::base64url);
+    j.emplace_back(bignum("-18446744073709551617"));
+    j.emplace_back("184467440737095516170.5", semantic_tag_type::big_decimal);
+    j.emplace_back("184467440737095516170.5", semantic_tag_type::big_decimal);
+    j.emplace_back("repeated");
+    j.emplace_back(byte_string({'H','e','l','l','o'}));
+    j.emplace_back("repeated");
+    j.emplace_back(byte_string({'H','e','l','l','o'}));
+
+    std::vector<uint8_t> buffer;
+    encode_cbor(j, buffer, cbor_options().pack_strings(true));
+
+    ojson j2 = decode_cbor<ojson>(buffer);
+    CHECK(j2 == j);
+
+    cbor_view v(buffer);
+    CHECK(v[8].as<std::string>() == "repeated");
+    CHECK(v[9].as_byte_string() == byte_string({'H','e','l','l','o'}));
+    CHECK(v.indexed()[8].as<std::string>() == "repeated");
+}
+
+TEST_CASE("cbor stringref nested namespaces")
+{
+    // 256(["aaa", 25(0), 256(["bbb", "aaa", 25(1)]), 25(0)])
+    std::vector<uint8_t> buffer = {0xd9,0x01,0x00,0x84,0x63,'a','a','a',0xd8,0x19,0x00,
+                                   0xd9,0x01,0x00,0x83,0x63,'b','b','b',0x63,'a','a','a',0xd8,0x19,0x01,
+                                   0xd8,0x19,0x00};
+    json expected = json::parse(R"(["aaa","aaa",["bbb","aaa","aaa"],"aaa"])");
+
+    CHECK(decode_cbor<json>(buffer) == expected);
+
+    cbor_view v(buffer);
+    CHECK(v[3].as<std::string>() == "aaa");
+    CHECK(v[2][2].as<std::string>() == "aaa");
+    CHECK(v.indexed()[2][2].as<std::string>() == "aaa");
+    CHECK(decode_cbor<json>(v[2]) == expected[2]);
+}
+
+TEST_CASE("cbor stringref keys")
+{
+    // 256({"name": 1, "other": {"name": 2, 25(1): 3}})
+    std::vector<uint8_t> buffer = {0xd9,0x01,0x00,0xa2,0x64,'n','a','m','e',0x01,
+                                   0x65,'o','t','h','e','r',0xa2,0xd8,0x19,0x00,0x02,0xd8,0x19,0x01,0x03};
+    json j = decode_cbor<json>(buffer);
+    CHECK(j == json::parse(R"({"name":1,"other":{"name":2,"other":3}})"));
+
+    cbor_view v(buffer);
+    CHECK(v["other"]["other"].as<int>() == 3);
+    CHECK(v.indexed()["other"]["name"].as<int>() == 2);
+}
+
+TEST_CASE("cbor stringref errors")
+{
+    SECTION("no namespace")
+    {
+        std::vector<uint8_t> buffer = {0x82,0x63,'a','a','a',0xd8,0x19,0x00};
+        CHECK_THROWS_AS(decode_cbor<json>(buffer), serialization_error);
+        CHECK_THROWS_AS(cbor_view(buffer)[1].as<std::string>(), serialization_error);
+    }
+    SECTION("index too large")
+    {
+        std::vector<uint8_t> buffer = {0xd9,0x01,0x00,0x82,0x63,'a','a','a',0xd8,0x19,0x01};
+        std::error_code ec;
+        json_decoder<json> decoder;
+        cbor_buffer_reader reader(buffer_source(buffer.data(), buffer.size()), decoder);
+        reader.read(ec);
+        CHECK(ec == cbor_errc::stringref_too_large);
+        CHECK_THROWS_AS(cbor_view(buffer)[1].as<std::string>(), serialization_error);
+        CHECK_THROWS_AS(cbor_view(buffer).indexed()[1].as<std::string>(), serialization_error);
+    }
+}
+
+TEST_CASE("cbor stringref off by default")
+{
+    json j = make_records(3);
+    std::vector<uint8_t> buffer1;
+    encode_cbor(j, buffer1);
+    std::vector<uint8_t> buffer2;
+    encode_cbor(j, buffer2, cbor_options());
+    CHECK(buffer1 == buffer2);
+    CHECK(buffer1[0] == 0x83);
+}
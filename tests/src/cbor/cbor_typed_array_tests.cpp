@@ -0,0 +1,177 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h"
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+#include <limits>
+#include <catch/catch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+namespace {
+
+template <class T>
+void check_round_trip(const std::vector<T>& v)
+{
+    std::vector<uint8_t> buffer;
+    encode_cbor(v, buffer);
+    CHECK(decode_cbor<std::vector<T>>(buffer) == v);
+
+    json j = decode_cbor<json>(buffer);
+    REQUIRE(j.is_array());
+    REQUIRE(j.size() == v.size());
+    for (size_t i = 0; i < v.size(); ++i)
+    {
+        CHECK(j[i].as<T>() == v[i]);
+    }
+}
+
+}
+
+TEST_CASE("cbor typed array encoding")
+{
+    std::vector<double> v = {1.5, -2.25, 1e300};
+
+    std::vector<uint8_t> buffer;
+    encode_cbor(v, buffer);
+
+    REQUIRE(buffer.size() == 2 + 2 + 24);
+    CHECK(buffer[0] == 0xd8);
+    if (jsoncons::detail::endian::native == jsoncons::detail::endian::little)
+    {
+        CHECK(buffer[1] == 0x56); // float64, little endian
+    }
+    else
+    {
+        CHECK(buffer[1] == 0x52); // float64, big endian
+    }
+    CHECK(buffer[2] == 0x58);
+    CHECK(buffer[3] == 24);
+
+    // conversion_traits writes the same typed array
+    std::vector<uint8_t> buffer2;
+    cbor_buffer_serializer serializer(buffer2);
+    encode_stream(v, serializer);
+    CHECK(buffer2 == buffer);
+
+    std::ostringstream os;
+    encode_cbor(v, os);
+    std::string s = os.str();
+    CHECK(std::vector<uint8_t>(s.begin(), s.end()) == buffer);
+}
+
+TEST_CASE("cbor typed array round trip")
+{
+    check_round_trip(std::vector<uint8_t>{0, 1, 255});
+    check_round_trip(std::vector<uint16_t>{0, 1, 65535});
+    check_round_trip(std::vector<uint32_t>{0, 1, (std::numeric_limits<uint32_t>::max)()});
+    check_round_trip(std::vector<uint64_t>{0, 1, (std::numeric_limits<uint64_t>::max)()});
+    check_round_trip(std::vector<int8_t>{-128, 0, 127});
+    check_round_trip(std::vector<int16_t>{-32768, 0, 32767});
+    check_round_trip(std::vector<int32_t>{(std::numeric_limits<int32_t>::lowest)(), 0, 1});
+    check_round_trip(std::vector<int64_t>{(std::numeric_limits<int64_t>::lowest)(), 0, 1});
+    check_round_trip(std::vector<float>{1.5f, -0.25f, 3.0f});
+    check_round_trip(std::vector<double>{0.1, -1e-300, 42.0});
+    check_round_trip(std::vector<double>());
+
+    std::istringstream is(std::string("\xd8\x48\x43\xff\x00\x01", 6));
+    CHECK(decode_cbor<std::vector<int8_t>>(is) == std::vector<int8_t>{-1, 0, 1});
+}
+
+TEST_CASE("cbor typed array byte order")
+{
+    // uint16 big endian, [258, 772]
+    std::vector<uint8_t> be = {0xd8,0x41,0x44,0x01,0x02,0x03,0x04};
+    CHECK(decode_cbor<std::vector<uint16_t>>(be) == std::vector<uint16_t>{258, 772});
+
+    // uint16 little endian, [513, 1027]
+    std::vector<uint8_t> le = {0xd8,0x45,0x44,0x01,0x02,0x03,0x04};
+    CHECK(decode_cbor<std::vector<uint16_t>>(le) == std::vector<uint16_t>{513, 1027});
+
+    // sint32 big endian, [-2]
+    std::vector<uint8_t> sbe = {0xd8,0x4a,0x44,0xff,0xff,0xff,0xfe};
+    CHECK(decode_cbor<json>(sbe) == json::parse("[-2]"));
+
+    // float16 big endian, [1.0, -2.0]
+    std::vector<uint8_t> half = {0xd8,0x50,0x44,0x3c,0x00,0xc0,0x00};
+    CHECK(decode_cbor<std::vector<double>>(half) == std::vector<double>{1.0, -2.0});
+
+    // clamped uint8
+    std::vector<uint8_t> clamped = {0xd8,0x44,0x42,0x07,0xff};
+    CHECK(decode_cbor<json>(clamped) == json::parse("[7,255]"));
+}
+
+TEST_CASE("cbor typed array unsupported")
+{
+    // float128 is read as a byte string
+    std::vector<uint8_t> f128 = {0xd8,0x53,0x50,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+    CHECK(decode_cbor<json>(f128).is_byte_string());
+
+    // A length that is not a multiple of the element size
+    std::vector<uint8_t> odd = {0xd8,0x41,0x43,0x01,0x02,0x03};
+    CHECK(decode_cbor<json>(odd).is_byte_string());
+}
+
+TEST_CASE("cbor typed array decoding arrays of numbers")
+{
+    json j = json::parse("[1,-2,3.5]");
+    std::vector<uint8_t> buffer;
+    encode_cbor(j, buffer);
+    CHECK(decode_cbor<std::vector<double>>(buffer) == std::vector<double>{1.0, -2.0, 3.5});
+
+    json k = json::parse(R"({"a":[1,2]})");
+    buffer.clear();
+    encode_cbor(k, buffer);
+    CHECK_THROWS(decode_cbor<std::vector<double>>(buffer));
+
+    json l = json::parse(R"([1,[2]])");
+    buffer.clear();
+    encode_cbor(l, buffer);
+    CHECK_THROWS(decode_cbor<std::vector<double>>(buffer));
+}
+
+TEST_CASE("cbor typed array in cbor_view and other handlers")
+{
+    std::vector<int32_t> v = {1, -2, 3};
+    std::vector<uint8_t> buffer;
+    cbor_buffer_serializer serializer(buffer);
+    serializer.begin_object(2);
+    serializer.name("values");
+    serializer.typed_array(v.data(), v.size());
+    serializer.name("other");
+    serializer.string_value("other");
+    serializer.end_object();
+    serializer.flush();
+
+    cbor_view view(buffer);
+    std::string s;
+    view.dump(s);
+    CHECK(s == R"({"values":[1,-2,3],"other":"other"})");
+
+    CHECK(decode_cbor<json>(buffer) == json::parse(s));
+    CHECK(decode_cbor<wjson>(buffer) == wjson::parse(L"{\"values\":[1,-2,3],\"other\":\"other\"}"));
+
+    // Typed array byte strings are counted in stringref namespaces
+    std::vector<uint8_t> packed;
+    cbor_buffer_serializer packed_serializer(packed, cbor_options().pack_strings(true));
+    packed_serializer.begin_array(3);
+    packed_serializer.typed_array(v.data(), v.size());
+    packed_serializer.string_value("repeated");
+    packed_serializer.string_value("repeated");
+    packed_serializer.end_array();
+    packed_serializer.flush();
+    CHECK(decode_cbor<json>(packed) == json::parse(R"([[1,-2,3],"repeated","repeated"])"));
+    CHECK(cbor_view(packed)[2].as<std::string>() == "repeated");
+
+    std::string json_text;
+    json_compressed_string_serializer js(json_text);
+    js.typed_array(v.data(), v.size());
+    js.flush();
+    CHECK(json_text == "[1,-2,3]");
+}
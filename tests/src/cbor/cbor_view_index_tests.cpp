@@ -0,0 +1,105 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h"
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <jsoncons_ext/jsonpointer/jsonpointer.hpp>
+#include <string>
+#include <vector>
+#include <catch/catch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+TEST_CASE("cbor_view indexed array")
+{
+    json j = json::array();
+    for (int i = 0; i < 100; ++i)
+    {
+        json record;
+        record["id"] = i;
+        record["name"] = "name" + std::to_string(i);
+        record["values"] = json::array{i, i+1, i+2};
+        j.push_back(std::move(record));
+    }
+    std::vector<uint8_t> buffer;
+    encode_cbor(j, buffer);
+
+    cbor_view v(buffer);
+    cbor_view iv = v.indexed();
+    CHECK_FALSE(v.is_indexed());
+    REQUIRE(iv.is_indexed());
+    REQUIRE(iv.size() == 100);
+
+    for (size_t i = 0; i < iv.size(); ++i)
+    {
+        CHECK(iv[i] == v[i]);
+        CHECK(iv[i].is_indexed());
+        CHECK(iv[i]["id"].as<size_t>() == i);
+        CHECK(iv[i].at("name").as<std::string>() == "name" + std::to_string(i));
+        CHECK(iv[i]["values"][2].as<size_t>() == i+2);
+        CHECK_FALSE(iv[i]["id"].is_indexed());
+    }
+    CHECK_THROWS_AS(iv.at(100), std::out_of_range);
+    CHECK_THROWS_AS(iv[0].at("missing"), std::out_of_range);
+
+    cbor_view copy = iv;
+    CHECK(copy.is_indexed());
+    CHECK(copy[99]["id"].as<int>() == 99);
+}
+
+TEST_CASE("cbor_view indexed map")
+{
+    ojson j;
+    for (int i = 0; i < 50; ++i)
+    {
+        j["key" + std::to_string(i)] = i;
+    }
+    j["nested"]["a"] = 1;
+    j["key0"] = "duplicate names are not encoded, but the first of equal keys is found";
+
+    std::vector<uint8_t> buffer;
+    encode_cbor(j, buffer);
+
+    cbor_view iv = cbor_view(buffer).indexed();
+    for (int i = 1; i < 50; ++i)
+    {
+        std::string key = "key" + std::to_string(i);
+        CHECK(iv.contains(key));
+        CHECK(iv[key].as<int>() == i);
+    }
+    CHECK_FALSE(iv.contains("key50"));
+    CHECK(iv["nested"]["a"].as<int>() == 1);
+    CHECK_THROWS_AS(iv.at("key50"), std::out_of_range);
+
+    CHECK(jsonpointer::get(iv, "/nested/a").as<int>() == 1);
+}
+
+TEST_CASE("cbor_view indexed indefinite length")
+{
+    // [_ 1, {_ "a": [_ 2, 3], "bb": 4}, "x"]
+    std::vector<uint8_t> buffer = {0x9f, 0x01, 0xbf, 0x61, 'a', 0x9f, 0x02, 0x03, 0xff, 0x62, 'b', 'b', 0x04, 0xff, 0x61, 'x', 0xff};
+
+    cbor_view v(buffer);
+    cbor_view iv = v.indexed();
+    CHECK(iv[0].as<int>() == 1);
+    CHECK(iv[1]["a"][1].as<int>() == 3);
+    CHECK(iv[1]["bb"].as<int>() == 4);
+    CHECK(iv[2].as<std::string>() == "x");
+    CHECK(iv[1] == v[1]);
+    CHECK_THROWS_AS(iv.at(3), std::out_of_range);
+}
+
+TEST_CASE("cbor_view indexed scalar and truncated")
+{
+    std::vector<uint8_t> scalar = {0x18, 0x64};
+    cbor_view v = cbor_view(scalar).indexed();
+    CHECK_FALSE(v.is_indexed());
+    CHECK(v.as<int>() == 100);
+
+    std::vector<uint8_t> truncated = {0x83, 0x01, 0x02};
+    CHECK_THROWS_AS(cbor_view(truncated).indexed(), serialization_error);
+}
@@ -0,0 +1,191 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons/staj_iterator.hpp>
+#include <jsoncons_ext/csv/csv_reader.hpp>
+#include <jsoncons_ext/csv/csv_staj_reader.hpp>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <catch/catch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::csv;
+
+TEST_CASE("csv_staj_reader n_objects events")
+{
+    const std::string s = R"(name,age,score
+Tom,55,1.5
+Catherine,  44 ,2
+)";
+
+    csv_options options;
+    options.assume_header(true)
+           .trim(true);
+
+    std::istringstream is(s);
+    csv_staj_reader reader(is, options);
+
+    std::vector<staj_event_type> expected = {staj_event_type::begin_array,
+        staj_event_type::begin_object,
+        staj_event_type::name, staj_event_type::string_value,
+        staj_event_type::name, staj_event_type::uint64_value,
+        staj_event_type::name, staj_event_type::double_value,
+        staj_event_type::end_object,
+        staj_event_type::begin_object,
+        staj_event_type::name, staj_event_type::string_value,
+        staj_event_type::name, staj_event_type::uint64_value,
+        staj_event_type::name, staj_event_type::uint64_value,
+        staj_event_type::end_object,
+        staj_event_type::end_array};
+
+    std::vector<staj_event_type> actual;
+    std::vector<std::string> names;
+    for (; !reader.done(); reader.next())
+    {
+        actual.push_back(reader.current().event_type());
+        if (reader.current().event_type() == staj_event_type::name)
+        {
+            names.push_back(reader.current().as<std::string>());
+        }
+    }
+    actual.push_back(reader.current().event_type());
+
+    CHECK(actual == expected);
+    CHECK(names.size() == 6);
+    CHECK(names[3] == "name");
+}
+
+TEST_CASE("csv_staj_reader staj_array_iterator")
+{
+    const std::string s = R"(Date,1Y,2Y,3Y,5Y
+2017-01-09,0.0062,0.0075,0.0083,0.011
+2017-01-08,0.0063,0.0076,0.0084,0.0112
+2017-01-08,0.0063,0.0076,0.0084,0.0112
+)";
+
+    SECTION("n_objects to json")
+    {
+        csv_options options;
+        options.assume_header(true);
+
+        std::istringstream is(s);
+        csv_staj_reader reader(is, options);
+        staj_array_iterator<json> it(reader);
+
+        std::vector<json> rows;
+        for (const auto& row : it)
+        {
+            rows.push_back(row);
+        }
+        REQUIRE(rows.size() == 3);
+        CHECK(rows[0]["Date"].as<std::string>() == "2017-01-09");
+        CHECK(rows[2]["5Y"].as<double>() == Approx(0.0112).epsilon(0.00001));
+    }
+
+    SECTION("n_rows to tuple")
+    {
+        csv_options options;
+        options.header_lines(1)
+               .mapping(mapping_type::n_rows);
+
+        std::istringstream is(s);
+        csv_staj_reader reader(is, options);
+        staj_array_iterator<std::tuple<std::string,double,double,double,double>> it(reader);
+
+        std::vector<std::tuple<std::string,double,double,double,double>> rows;
+        for (const auto& row : it)
+        {
+            rows.push_back(row);
+        }
+        REQUIRE(rows.size() == 3);
+        CHECK(std::get<0>(rows[1]) == "2017-01-08");
+        CHECK(std::get<4>(rows[1]) == Approx(0.0112).epsilon(0.00001));
+    }
+
+    SECTION("matches csv_reader")
+    {
+        csv_options options;
+        options.assume_header(true);
+
+        json_decoder<ojson> decoder;
+        csv_string_reader reader1(s, decoder, options);
+        reader1.read();
+        ojson expected = decoder.get_result();
+
+        csv_string_staj_reader reader2(s, options);
+        json_decoder<ojson> decoder2;
+        reader2.accept(decoder2);
+        CHECK(decoder2.get_result() == expected);
+    }
+}
+
+TEST_CASE("csv_staj_reader small buffer")
+{
+    std::string s = "a,b\n";
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.append(std::to_string(i));
+        s.append(",\"x");
+        s.append(std::to_string(i));
+        s.append("\"\n");
+    }
+
+    csv_options options;
+    options.assume_header(true);
+
+    std::istringstream is(s);
+    csv_staj_reader reader(is, options);
+    reader.buffer_length(7);
+
+    staj_array_iterator<std::map<std::string,json>> it(reader);
+    int count = 0;
+    for (const auto& row : it)
+    {
+        CHECK(row.at("a").as<int>() == count);
+        CHECK(row.at("b").as<std::string>() == "x" + std::to_string(count));
+        ++count;
+    }
+    CHECK(count == 1000);
+}
+
+TEST_CASE("csv_staj_reader column_types")
+{
+    const std::string s = R"(id,flag,price
+1,true,1.25
+2,false,bad
+)";
+
+    csv_options options;
+    options.assume_header(true)
+           .column_types("integer,boolean,float");
+
+    csv_string_staj_reader reader(s, options);
+
+    std::vector<staj_event_type> values;
+    for (; !reader.done(); reader.next())
+    {
+        switch (reader.current().event_type())
+        {
+            case staj_event_type::int64_value:
+            case staj_event_type::bool_value:
+            case staj_event_type::double_value:
+            case staj_event_type::null_value:
+                values.push_back(reader.current().event_type());
+                break;
+            default:
+                break;
+        }
+    }
+    std::vector<staj_event_type> expected = {
+        staj_event_type::int64_value, staj_event_type::bool_value, staj_event_type::double_value,
+        staj_event_type::int64_value, staj_event_type::bool_value, staj_event_type::null_value};
+    CHECK(values == expected);
+}
+
@@ -0,0 +1,124 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_document_reader.hpp>
+#include <catch/catch.hpp>
+#include <sstream>
+#include <vector>
+#include <utility>
+
+using namespace jsoncons;
+
+TEST_CASE("json_document_reader newline delimited")
+{
+    std::string s = "{\"a\":1}\n[1,2]\r\n\"str\"\n  10 \n\n";
+
+    SECTION("read_next")
+    {
+        std::istringstream is(s);
+        json_document_reader reader(is);
+
+        std::vector<json> docs;
+        json val;
+        while (reader.read_next(val))
+        {
+            docs.push_back(val);
+        }
+        REQUIRE(docs.size() == 4);
+        CHECK(docs[0] == json::parse("{\"a\":1}"));
+        CHECK(docs[1] == json::parse("[1,2]"));
+        CHECK(docs[2].as<std::string>() == "str");
+        CHECK(docs[3].as<int>() == 10);
+        CHECK(reader.eof());
+        CHECK_FALSE(reader.read_next(val));
+    }
+
+    SECTION("iterator")
+    {
+        json_string_document_reader reader(s);
+        std::vector<json> docs;
+        for (const auto& doc : json_string_document_iterator(reader))
+        {
+            docs.push_back(doc);
+        }
+        CHECK(docs.size() == 4);
+    }
+
+    SECTION("small buffer")
+    {
+        std::istringstream is(s);
+        json_document_reader reader(is);
+        reader.buffer_length(3);
+        size_t count = 0;
+        for (const auto& doc : json_document_iterator(reader))
+        {
+            (void)doc;
+            ++count;
+        }
+        CHECK(count == 4);
+    }
+}
+
+TEST_CASE("json_document_reader concatenated")
+{
+    std::string s = "{}{\"b\":[true]}[]1 2";
+    json_string_document_reader reader(s);
+
+    std::vector<json> docs;
+    json val;
+    while (reader.read_next(val))
+    {
+        docs.push_back(val);
+    }
+    REQUIRE(docs.size() == 5);
+    CHECK(docs[1]["b"][0].as<bool>());
+    CHECK(docs[4].as<int>() == 2);
+}
+
+TEST_CASE("json_document_reader empty input")
+{
+    SECTION("empty")
+    {
+        std::string s;
+        json_string_document_reader reader(s);
+        json val;
+        CHECK_FALSE(reader.read_next(val));
+    }
+    SECTION("whitespace")
+    {
+        std::string s = " \n\t \r\n";
+        json_string_document_reader reader(s);
+        json val;
+        CHECK_FALSE(reader.read_next(val));
+    }
+}
+
+TEST_CASE("json_document_reader handler")
+{
+    std::string s = "[1,2]\n{\"x\":null}\n";
+    json_string_document_reader reader(s);
+
+    std::ostringstream os;
+    json_compressed_serializer serializer(os);
+    CHECK(reader.read_next(serializer));
+    CHECK(reader.read_next(serializer));
+    CHECK_FALSE(reader.read_next(serializer));
+    CHECK(os.str() == "[1,2]{\"x\":null}");
+}
+
+TEST_CASE("json_document_reader error")
+{
+    std::string s = "{\"a\":1}\n{\"a\":}\n";
+    json_string_document_reader reader(s);
+
+    json val;
+    std::error_code ec;
+    CHECK(reader.read_next(val, ec));
+    CHECK_FALSE(ec);
+    CHECK_FALSE(reader.read_next(val, ec));
+    CHECK(ec == json_errc::expected_value);
+}
@@ -336,3 +336,113 @@ TEST_CASE("json_staj_reader object_value test")
 
 
 
+
+TEST_CASE("json_staj_reader skip test")
+{
+    std::string s = R"(
+    [
+        {"id" : 1, "payload" : {"a" : "x}]\"", "b" : [[1,2],{"c":null}], "d" : -1.5e3}},
+        {"id" : 2, "payload" : ["[", "\\", "{"]},
+        {"id" : 3, "payload" : []}
+    ]
+    )";
+
+    SECTION("skip payloads")
+    {
+        std::istringstream is(s);
+        json_staj_reader reader(is);
+        reader.buffer_length(5);
+
+        std::vector<int> ids;
+        std::vector<staj_event_type> events;
+        for (; !reader.done(); reader.next())
+        {
+            const auto& event = reader.current();
+            events.push_back(event.event_type());
+            if (event.event_type() == staj_event_type::name && event.as<std::string>() == "payload")
+            {
+                reader.next();
+                reader.skip();
+                events.push_back(reader.current().event_type());
+            }
+            else if (event.event_type() == staj_event_type::uint64_value)
+            {
+                ids.push_back(event.as<int>());
+            }
+        }
+        CHECK(ids == std::vector<int>{1,2,3});
+
+        std::vector<staj_event_type> expected = {staj_event_type::begin_array};
+        for (size_t i = 0; i < 3; ++i)
+        {
+            expected.push_back(staj_event_type::begin_object);
+            expected.push_back(staj_event_type::name);
+            expected.push_back(staj_event_type::uint64_value);
+            expected.push_back(staj_event_type::name);
+            expected.push_back(i == 0 ? staj_event_type::end_object : staj_event_type::end_array);
+            expected.push_back(staj_event_type::end_object);
+        }
+        expected.push_back(staj_event_type::end_array);
+        CHECK(events == expected);
+    }
+
+    SECTION("skip_to_end_of_container")
+    {
+        json_staj_reader reader(s);
+        reader.next(); // begin_object
+        reader.next(); // "id"
+        reader.next(); // 1
+        REQUIRE(reader.current().as<int>() == 1);
+        reader.skip_to_end_of_container();
+        CHECK(reader.current().event_type() == staj_event_type::end_object);
+        reader.next();
+        CHECK(reader.current().event_type() == staj_event_type::begin_object);
+        reader.skip_to_end_of_container();
+        CHECK(reader.current().event_type() == staj_event_type::end_object);
+        reader.next();
+        reader.next();
+        reader.next();
+        CHECK(reader.current().as<int>() == 3);
+        reader.skip_to_end_of_container();
+        CHECK(reader.current().event_type() == staj_event_type::end_object);
+        reader.skip_to_end_of_container();
+        CHECK(reader.current().event_type() == staj_event_type::end_array);
+        reader.next();
+        CHECK(reader.done());
+    }
+
+    SECTION("skip a scalar does nothing")
+    {
+        json_staj_reader reader(std::string("[1,2]"));
+        reader.next();
+        reader.skip();
+        CHECK(reader.current().as<int>() == 1);
+        reader.next();
+        CHECK(reader.current().as<int>() == 2);
+    }
+
+    SECTION("unexpected end of input")
+    {
+        json_staj_reader reader(std::string("[1,[2,\"]\""));
+        reader.next();
+        reader.next();
+        std::error_code ec;
+        reader.skip(ec);
+        CHECK(ec == json_errc::unexpected_eof);
+    }
+}
+
+TEST_CASE("json_staj_reader skip with line breaks and comments")
+{
+    std::string s = "[\n{\"a\" : 1 // ]\n, \"b\" : /* } */ 2\n},\n3\n]";
+
+    std::istringstream is(s);
+    json_staj_reader reader(is);
+    reader.next();
+    REQUIRE(reader.current().event_type() == staj_event_type::begin_object);
+    reader.skip();
+    CHECK(reader.current().event_type() == staj_event_type::end_object);
+    CHECK(reader.context().line_number() == 4);
+    reader.next();
+    CHECK(reader.current().as<int>() == 3);
+}
@@ -0,0 +1,138 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <catch/catch.hpp>
+#include <string>
+#include <vector>
+#include <utility>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpatch/jsonpatch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::literals;
+
+TEST_CASE("apply_patch atomic rollback")
+{
+    const json original = R"(
+        {"foo": ["bar", "baz"], "qux": {"a": 1, "b": [1,2]}, "s": "t"}
+    )"_json;
+
+    json patch = R"(
+    [
+        { "op": "add", "path": "/foo/-", "value": "end" },
+        { "op": "add", "path": "/foo/0", "value": "start" },
+        { "op": "add", "path": "/qux/a", "value": 2 },
+        { "op": "add", "path": "/qux/c", "value": 3 },
+        { "op": "remove", "path": "/qux/b/0" },
+        { "op": "remove", "path": "/s" },
+        { "op": "replace", "path": "/foo/1", "value": "BAR" },
+        { "op": "move", "from": "/qux/b", "path": "/b" },
+        { "op": "move", "from": "/foo/0", "path": "/qux/a" },
+        { "op": "copy", "from": "/foo", "path": "/foo2" },
+        { "op": "copy", "from": "/qux", "path": "/foo/1" },
+        { "op": "test", "path": "/s", "value": "t" }
+    ]
+    )"_json;
+
+    SECTION("const patch")
+    {
+        json target = original;
+        std::error_code ec;
+        jsonpatch::apply_patch(target, patch, ec);
+        CHECK(ec == jsonpatch::jsonpatch_errc::test_failed);
+        CHECK(target == original);
+    }
+    SECTION("rvalue patch")
+    {
+        json target = original;
+        std::error_code ec;
+        jsonpatch::apply_patch(target, json(patch), ec);
+        CHECK(ec == jsonpatch::jsonpatch_errc::test_failed);
+        CHECK(target == original);
+    }
+    SECTION("whole document")
+    {
+        json target = original;
+        json patch2 = R"(
+        [
+            { "op": "replace", "path": "", "value": [1] },
+            { "op": "add", "path": "/-", "value": 2 },
+            { "op": "remove", "path": "/5" }
+        ]
+        )"_json;
+        std::error_code ec;
+        jsonpatch::apply_patch(target, patch2, ec);
+        CHECK(ec == jsonpatch::jsonpatch_errc::remove_failed);
+        CHECK(target == original);
+    }
+}
+
+TEST_CASE("apply_patch rvalue patch")
+{
+    json target = R"({"foo": "bar"})"_json;
+    json patch = R"(
+    [
+        { "op": "add", "path": "/baz", "value": {"long": "a value that is not a short string"} },
+        { "op": "add", "path": "/foo", "value": ["bar", "baz"] },
+        { "op": "replace", "path": "", "value": {"x": [1, 2, 3]} },
+        { "op": "add", "path": "/x/1", "value": 4 }
+    ]
+    )"_json;
+
+    jsonpatch::apply_patch(target, std::move(patch));
+    CHECK(target == R"({"x": [1, 4, 2, 3]})"_json);
+}
+
+TEST_CASE("apply_patch best_effort")
+{
+    json target = R"({"foo": ["bar", "baz"], "qux": 1})"_json;
+    json patch = R"(
+    [
+        { "op": "add", "path": "/a", "value": 1 },
+        { "op": "remove", "path": "/missing" },
+        { "op": "add", "path": "/foo/-", "value": "end" },
+        { "op": "test", "path": "/qux", "value": 2 },
+        { "op": "replace", "path": "/qux", "value": 3 }
+    ]
+    )"_json;
+
+    SECTION("error code")
+    {
+        std::error_code ec;
+        jsonpatch::apply_patch(target, patch, jsonpatch::apply_mode::best_effort, ec);
+        CHECK(ec == jsonpatch::jsonpatch_errc::remove_failed);
+        CHECK(target == R"({"a": 1, "foo": ["bar", "baz", "end"], "qux": 3})"_json);
+    }
+    SECTION("exception")
+    {
+        CHECK_THROWS_AS(jsonpatch::apply_patch(target, std::move(patch), jsonpatch::apply_mode::best_effort), 
+                        jsonpatch::jsonpatch_error);
+        CHECK(target == R"({"a": 1, "foo": ["bar", "baz", "end"], "qux": 3})"_json);
+    }
+    SECTION("atomic")
+    {
+        json expected = target;
+        CHECK_THROWS_AS(jsonpatch::apply_patch(target, patch, jsonpatch::apply_mode::atomic), 
+                        jsonpatch::jsonpatch_error);
+        CHECK(target == expected);
+    }
+}
+
+TEST_CASE("apply_patch best_effort success")
+{
+    json target = R"({"foo": "bar"})"_json;
+    json patch = R"(
+    [
+        { "op": "move", "from": "/foo", "path": "/baz" },
+        { "op": "copy", "from": "/baz", "path": "/qux" }
+    ]
+    )"_json;
+
+    std::error_code ec;
+    jsonpatch::apply_patch(target, patch, jsonpatch::apply_mode::best_effort, ec);
+    CHECK_FALSE(ec);
+    CHECK(target == R"({"baz": "bar", "qux": "bar"})"_json);
+}
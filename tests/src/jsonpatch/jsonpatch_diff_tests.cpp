@@ -0,0 +1,160 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <catch/catch.hpp>
+#include <random>
+#include <string>
+#include <vector>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpatch/jsonpatch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::literals;
+
+namespace {
+
+template <class Json>
+Json check_diff(const Json& source, const Json& target)
+{
+    Json patch = jsonpatch::from_diff(source, target);
+    Json result = source;
+    std::error_code ec;
+    jsonpatch::apply_patch(result, patch, ec);
+    CHECK_FALSE(ec);
+    CHECK(result == target);
+    return patch;
+}
+
+json make_array(size_t n)
+{
+    json a = json::array();
+    for (size_t i = 0; i < n; ++i)
+    {
+        json item;
+        item["id"] = i;
+        item["name"] = "item " + std::to_string(i);
+        a.push_back(std::move(item));
+    }
+    return a;
+}
+
+}
+
+TEST_CASE("from_diff equal documents")
+{
+    json doc = R"({"a": [1, 2, {"b": null}], "c": 1.5})"_json;
+    CHECK(jsonpatch::from_diff(doc, doc).size() == 0);
+    CHECK(jsonpatch::from_diff(json(1), json(1.0)).size() == 0);
+    CHECK(jsonpatch::from_diff(R"({"x":1,"y":2})"_json, R"({"y":2,"x":1})"_json).size() == 0);
+
+    ojson o1 = ojson::parse(R"({"x":1,"y":[true]})");
+    ojson o2 = ojson::parse(R"({"y":[true],"x":1})");
+    CHECK(jsonpatch::from_diff(o1, o2).size() == 0);
+}
+
+TEST_CASE("from_diff array edits")
+{
+    json source = make_array(1000);
+
+    SECTION("insert at front")
+    {
+        json target = source;
+        target.insert(target.array_range().begin(), json("new"));
+        json patch = check_diff(source, target);
+        CHECK(patch == R"([{"op":"add","path":"/0","value":"new"}])"_json);
+    }
+    SECTION("remove from middle")
+    {
+        json target = source;
+        target.erase(target.array_range().begin()+500);
+        json patch = check_diff(source, target);
+        CHECK(patch == R"([{"op":"remove","path":"/500"}])"_json);
+    }
+    SECTION("modify an element")
+    {
+        json target = source;
+        target[10]["name"] = "changed";
+        json patch = check_diff(source, target);
+        CHECK(patch == R"([{"op":"replace","path":"/10/name","value":"changed"}])"_json);
+    }
+    SECTION("move forward")
+    {
+        json target = source;
+        json item = target[3];
+        target.erase(target.array_range().begin()+3);
+        target.insert(target.array_range().begin()+700, item);
+        json patch = check_diff(source, target);
+        REQUIRE(patch.size() == 1);
+        CHECK(patch[0]["op"] == json("move"));
+    }
+    SECTION("move backward")
+    {
+        json target = source;
+        json item = target[900];
+        target.erase(target.array_range().begin()+900);
+        target.insert(target.array_range().begin()+2, item);
+        json patch = check_diff(source, target);
+        REQUIRE(patch.size() == 1);
+        CHECK(patch[0]["op"] == json("move"));
+    }
+    SECTION("replace everything")
+    {
+        json target = make_array(10);
+        for (auto& item : target.array_range())
+        {
+            item["name"] = "other";
+        }
+        check_diff(source, target);
+    }
+}
+
+TEST_CASE("from_diff escapes keys")
+{
+    json source = R"({"a/b": {"~": [1, 2]}, "c": 1})"_json;
+    json target = R"({"a/b": {"~": [2, 1, 3]}, "d~/": 2})"_json;
+    check_diff(source, target);
+}
+
+TEST_CASE("from_diff random arrays")
+{
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> value(0, 9);
+    std::uniform_int_distribution<int> length(0, 30);
+
+    for (int round = 0; round < 300; ++round)
+    {
+        json source = json::array();
+        json target = json::array();
+        int n = length(gen);
+        int m = length(gen);
+        for (int i = 0; i < n; ++i)
+        {
+            source.push_back(value(gen));
+        }
+        for (int i = 0; i < m; ++i)
+        {
+            if (value(gen) < 3)
+            {
+                json obj;
+                obj["v"] = value(gen);
+                target.push_back(std::move(obj));
+            }
+            else
+            {
+                target.push_back(value(gen));
+            }
+        }
+        check_diff(source, target);
+
+        json nested_source;
+        nested_source["a"] = source;
+        json nested_target;
+        nested_target["a"] = target;
+        nested_target["b"] = source;
+        check_diff(nested_source, nested_target);
+        check_diff(nested_target, nested_source);
+    }
+}
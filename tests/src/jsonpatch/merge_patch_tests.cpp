@@ -0,0 +1,171 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <catch/catch.hpp>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <utility>
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_staj_reader.hpp>
+#include <jsoncons_ext/jsonpatch/merge_patch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::literals;
+
+namespace {
+
+// RFC 7396 Appendix A
+const std::vector<std::vector<std::string>> rfc7396_examples = {
+    {R"({"a":"b"})", R"({"a":"c"})", R"({"a":"c"})"},
+    {R"({"a":"b"})", R"({"b":"c"})", R"({"a":"b","b":"c"})"},
+    {R"({"a":"b"})", R"({"a":null})", R"({})"},
+    {R"({"a":"b","b":"c"})", R"({"a":null})", R"({"b":"c"})"},
+    {R"({"a":["b"]})", R"({"a":"c"})", R"({"a":"c"})"},
+    {R"({"a":"c"})", R"({"a":["b"]})", R"({"a":["b"]})"},
+    {R"({"a":{"b":"c"}})", R"({"a":{"b":"d","c":null}})", R"({"a":{"b":"d"}})"},
+    {R"({"a":[{"b":"c"}]})", R"({"a":[1]})", R"({"a":[1]})"},
+    {R"(["a","b"])", R"(["c","d"])", R"(["c","d"])"},
+    {R"({"a":"b"})", R"(["c"])", R"(["c"])"},
+    {R"({"a":"foo"})", R"(null)", R"(null)"},
+    {R"({"a":"foo"})", R"("bar")", R"("bar")"},
+    {R"({"e":null})", R"({"a":1})", R"({"e":null,"a":1})"},
+    {R"([1,2])", R"({"a":"b","c":null})", R"({"a":"b"})"},
+    {R"({})", R"({"a":{"bb":{"ccc":null}}})", R"({"a":{"bb":{}}})"}
+};
+
+json stream_merge(const std::string& source, const json& patch)
+{
+    std::istringstream is(source);
+    json_staj_reader reader(is);
+    std::string buffer;
+    json_compressed_string_serializer serializer(buffer);
+    jsonpatch::merge_patch(reader, patch, serializer);
+    return json::parse(buffer);
+}
+
+}
+
+TEST_CASE("merge_patch rfc7396 examples")
+{
+    for (const auto& example : rfc7396_examples)
+    {
+        const json patch = json::parse(example[1]);
+        const json expected = json::parse(example[2]);
+
+        SECTION("in place")
+        {
+            json target = json::parse(example[0]);
+            jsonpatch::merge_patch(target, patch);
+            CHECK(target == expected);
+        }
+        SECTION("moved patch")
+        {
+            json target = json::parse(example[0]);
+            json p = patch;
+            jsonpatch::merge_patch(target, std::move(p));
+            CHECK(target == expected);
+        }
+        SECTION("streaming")
+        {
+            CHECK(stream_merge(example[0], patch) == expected);
+        }
+    }
+}
+
+TEST_CASE("merge_patch nested document")
+{
+    std::string source = R"(
+    {
+        "title": "Goodbye!",
+        "author" : {
+            "givenName" : "John",
+            "familyName" : "Doe"
+        },
+        "tags":[ "example", "sample" ],
+        "content": "This will be unchanged",
+        "meta": {"views": 10, "ratings": [4.5, 3.0, {"by": null}]}
+    }
+    )";
+
+    json patch = R"(
+    {
+        "title": "Hello!",
+        "phoneNumber": "+01-123-456-7890",
+        "author": {
+            "familyName": null
+        },
+        "tags": [ "example" ],
+        "extra": {"a": null, "b": {"c": 1, "d": null}}
+    }
+    )"_json;
+
+    json expected = R"(
+    {
+        "title": "Hello!",
+        "author" : {
+            "givenName" : "John"
+        },
+        "tags": [ "example" ],
+        "content": "This will be unchanged",
+        "meta": {"views": 10, "ratings": [4.5, 3.0, {"by": null}]},
+        "phoneNumber": "+01-123-456-7890",
+        "extra": {"b": {"c": 1}}
+    }
+    )"_json;
+
+    json target = json::parse(source);
+    jsonpatch::merge_patch(target, patch);
+    CHECK(target == expected);
+
+    CHECK(stream_merge(source, patch) == expected);
+
+    ojson otarget = ojson::parse(source);
+    jsonpatch::merge_patch(otarget, ojson::parse(patch.to_string()));
+    CHECK(otarget == ojson::parse(expected.to_string()));
+}
+
+TEST_CASE("merge_patch streaming preserves unpatched order")
+{
+    std::string source = R"({"z":1,"y":{"b":2,"a":3},"x":[1,{"k":null}]})";
+
+    std::istringstream is(source);
+    json_staj_reader reader(is);
+    std::string buffer;
+    json_compressed_string_serializer serializer(buffer);
+    jsonpatch::merge_patch(reader, json::parse(R"({"y":{"a":4},"w":true})"), serializer);
+
+    CHECK(buffer == R"({"z":1,"y":{"b":2,"a":4},"x":[1,{"k":null}],"w":true})");
+}
+
+TEST_CASE("merge_patch streaming error")
+{
+    std::istringstream is(R"({"a":1,"b":)");
+    json_staj_reader reader(is);
+    std::string buffer;
+    json_compressed_string_serializer serializer(buffer);
+
+    std::error_code ec;
+    jsonpatch::merge_patch(reader, json::parse(R"({"c":1})"), serializer, ec);
+    CHECK(ec);
+}
+
+TEST_CASE("create_merge_patch")
+{
+    for (const auto& example : rfc7396_examples)
+    {
+        json source = json::parse(example[0]);
+        json target = json::parse(example[2]);
+
+        json patch = jsonpatch::create_merge_patch(source, target);
+        jsonpatch::merge_patch(source, patch);
+        CHECK(source == target);
+    }
+
+    json patch = jsonpatch::create_merge_patch(R"({"a":1,"b":{"c":2,"d":3},"e":4})"_json,
+                                               R"({"a":1,"b":{"c":2,"d":5},"f":6})"_json);
+    CHECK(patch == R"({"b":{"d":5},"e":null,"f":6})"_json);
+}
@@ -0,0 +1,176 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpath/json_query.hpp>
+#include <catch/catch.hpp>
+#include <string>
+#include <vector>
+#include <thread>
+
+using namespace jsoncons;
+using namespace jsoncons::jsonpath;
+
+namespace {
+
+const std::string store = R"(
+{ "store": {
+    "book": [
+      { "category": "reference",
+        "author": "Nigel Rees",
+        "title": "Sayings of the Century",
+        "price": 8.95
+      },
+      { "category": "fiction",
+        "author": "Evelyn Waugh",
+        "title": "Sword of Honour",
+        "price": 12.99
+      },
+      { "category": "fiction",
+        "author": "Herman Melville",
+        "title": "Moby Dick",
+        "isbn": "0-553-21311-3",
+        "price": 8.99
+      },
+      { "category": "fiction",
+        "author": "J. R. R. Tolkien",
+        "title": "The Lord of the Rings",
+        "isbn": "0-395-19395-8",
+        "price": 22.99
+      }
+    ],
+    "bicycle": {
+      "color": "red",
+      "price": 19.95
+    }
+  }
+}
+)";
+
+}
+
+TEST_CASE("jsonpath compile matches json_query")
+{
+    json root = json::parse(store);
+
+    std::vector<std::string> paths = {
+        "$.store.book[0].title",
+        "$..author",
+        "$.store.*",
+        "$.store..price",
+        "$..book[2]",
+        "$..book[-1:]",
+        "$..book[0,1]",
+        "$..book[:2]",
+        "$..book[?(@.isbn)]",
+        "$..book[?(@.price<10)].title",
+        "$..book[?(@.price > max($..book[*].price) - 5)].title",
+        "$..book[(@.length-1)]",
+        "$.store.book.length",
+        "$..*",
+        "$['store']['book'][*]['author']",
+        "max($.store.book[*].price)",
+        "$..book[?(@.author =~ /.*Tolkien/)].title"
+    };
+
+    for (const auto& path : paths)
+    {
+        auto expr = jsonpath::compile<json>(path);
+        CHECK(expr.evaluate(root) == json_query(root, path));
+        CHECK(expr.evaluate(root, result_type::path) == json_query(root, path, result_type::path));
+    }
+}
+
+TEST_CASE("jsonpath compile evaluate against different roots")
+{
+    auto expr = jsonpath::compile<json>("$.books[?(@.price < 10)].title");
+
+    json doc1 = json::parse(R"({"books":[{"title":"A","price":8.95},{"title":"B","price":22.5}]})");
+    json doc2 = json::parse(R"({"books":[{"title":"C","price":5.0}]})");
+    json doc3 = json::parse(R"({"magazines":[]})");
+
+    CHECK(expr.evaluate(doc1) == json::parse(R"(["A"])"));
+    CHECK(expr.evaluate(doc2) == json::parse(R"(["C"])"));
+    CHECK(expr.evaluate(doc3) == json::array());
+    CHECK(expr.evaluate(doc1, result_type::path) == json::parse(R"(["$['books'][0]['title']"])"));
+}
+
+TEST_CASE("jsonpath compile replace")
+{
+    json root = json::parse(store);
+
+    auto expr = jsonpath::compile<json>("$..book[?(@.price > 20)].price");
+    expr.replace(root, 10.0);
+    CHECK(root["store"]["book"][3]["price"].as<double>() == 10.0);
+    CHECK(root["store"]["book"][1]["price"].as<double>() == 12.99);
+}
+
+TEST_CASE("jsonpath compile errors")
+{
+    std::error_code ec;
+    jsonpath::compile<json>("$.store['book' 0]", ec);
+    CHECK(ec == jsonpath_errc::expected_right_bracket);
+
+    ec = std::error_code();
+    jsonpath::compile<json>("$store", ec);
+    CHECK(ec == jsonpath_errc::expected_separator);
+
+    ec = std::error_code();
+    jsonpath::compile<json>("$..book[a:2]", ec);
+    CHECK(ec == jsonpath_errc::expected_index);
+
+    ec = std::error_code();
+    jsonpath::compile<json>("unknown($.store)", ec);
+    CHECK(ec == jsonpath_errc::invalid_filter_unsupported_operator);
+
+    CHECK_THROWS_AS(jsonpath::compile<json>(".store"), serialization_error);
+}
+
+TEST_CASE("jsonpath compile shared between threads")
+{
+    json root = json::parse(store);
+    auto expr = jsonpath::compile<json>("$..book[?(@.price < 10 && @.category == 'fiction')].author");
+    json expected = json_query(root, "$..book[?(@.price < 10 && @.category == 'fiction')].author");
+
+    std::vector<int> matches(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < matches.size(); ++i)
+    {
+        threads.emplace_back([&,i]()
+        {
+            for (int j = 0; j < 200; ++j)
+            {
+                if (expr.evaluate(root) == expected)
+                {
+                    ++matches[i];
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    for (auto count : matches)
+    {
+        CHECK(count == 200);
+    }
+}
+
+TEST_CASE("jsonpath compile evaluate_refs")
+{
+    json root = json::parse(store);
+    auto expr = jsonpath::compile<json>("$.store.book[*].title");
+
+    std::vector<const json*> refs;
+    expr.evaluate_refs(root, [&](const std::string&, const json& val){refs.push_back(std::addressof(val));});
+    REQUIRE(refs.size() == 4);
+    CHECK(refs[3] == std::addressof(root.at("store").at("book")[3].at("title")));
+
+    json paths = json::array();
+    expr.evaluate_refs(root, [&](const std::string& path, const json&){paths.push_back(path);}, result_type::path);
+    CHECK(paths == expr.evaluate(root, result_type::path));
+}
@@ -516,3 +516,84 @@ TEST_CASE("test_jsonpath_filter_regex")
 }
 #endif
 
+
+TEST_CASE("test_jsonpath_filter_path_terms_parsed_once")
+{
+    std::vector<std::unique_ptr<json>> temp_json_values;
+
+    const char* pend;
+    jsonpath_filter_parser<json> parser;
+
+    std::string s = "(@.price < 10 && @.tags[1] == 'b')";
+    auto expr = parser.parse(s.c_str(), s.c_str()+ s.length(), &pend);
+    CHECK(pend == s.c_str() + s.length());
+
+    json a = json::parse(R"({"price":8.95,"tags":["a","b"]})");
+    json b = json::parse(R"({"price":12.99,"tags":["a","b"]})");
+    json c = json::parse(R"({"price":5,"tags":["b"]})");
+    json d = json::parse(R"({"name":"no price"})");
+
+    CHECK(expr.exists(a, temp_json_values));
+    CHECK_FALSE(expr.exists(b, temp_json_values));
+    CHECK_FALSE(expr.exists(c, temp_json_values));
+    CHECK_FALSE(expr.exists(d, temp_json_values));
+    CHECK(expr.exists(a, temp_json_values));
+
+    std::string s2 = "(@..price)";
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    json e = json::parse(R"({"price":1,"items":[{"price":2},{"price":3}]})");
+    CHECK(expr2.eval(e, temp_json_values) == json::parse("[1,2,3]"));
+    CHECK(expr2.eval(a, temp_json_values) == json(8.95));
+
+    std::string s3 = "(@x > 1)";
+    CHECK_THROWS_AS(parser.parse(s3.c_str(), s3.c_str()+ s3.length(), &pend), serialization_error);
+}
+
+TEST_CASE("test_jsonpath_filter_literal_regex")
+{
+    std::vector<std::string> patterns = {"abc", "^abc$", "abc.*", "^abc.*$", ".*abc", ".*abc.*",
+                                         ".*", "", "a\\.c", "a\\/c.*", "a-c",
+                                         "a.c", "ab*", ".*a.*c", "[a-c]+", "abc.*?"};
+    std::vector<std::string> subjects = {"abc", "abcd", "xabc", "xabcx", "ab", "a.c", "a/cd", "a-c",
+                                         "", "abc\nx", "x\nabc", "x\nabc\ny"};
+
+    for (const auto& pattern : patterns)
+    {
+        std::regex expected(pattern, std::regex_constants::ECMAScript);
+        regex_term<json> term(pattern, std::regex_constants::ECMAScript);
+        for (const auto& subject : subjects)
+        {
+            INFO(pattern << " " << subject);
+            CHECK(term.regex2(subject) == std::regex_match(subject, expected));
+        }
+    }
+
+    std::string literal;
+    CHECK(parse_literal_pattern(std::string(".*Tolkien"), literal) == literal_match::suffix);
+    CHECK(literal == "Tolkien");
+    CHECK(parse_literal_pattern(std::string("a.c"), literal) == literal_match::none);
+
+    json root = json::parse(R"([{"author":"J. R. R. Tolkien"},{"author":"Nigel Rees"},{"author":"Tolkien, J."}])");
+    CHECK(json_query(root, "$[?(@.author =~ /.*Tolkien/)].author") == json::parse(R"(["J. R. R. Tolkien"])"));
+    CHECK(json_query(root, "$[?(@.author =~ /Tolkien.*/)].author") == json::parse(R"(["Tolkien, J."])"));
+    CHECK(json_query(root, "$[?(@.author =~ /.*tolkien.*/i)].author").size() == 2);
+}
+
+TEST_CASE("test_jsonpath_filter_regex_cache")
+{
+    auto& cache = regex_cache<char>::instance();
+    auto r1 = cache.get("[0-9]+x", std::regex_constants::ECMAScript);
+    auto r2 = cache.get("[0-9]+x", std::regex_constants::ECMAScript);
+    auto r3 = cache.get("[0-9]+x", std::regex_constants::ECMAScript | std::regex_constants::icase);
+    CHECK(r1 == r2);
+    CHECK(r1 != r3);
+    CHECK(std::regex_match(std::string("12X"), *r3));
+
+    for (size_t i = 0; i < regex_cache<char>::max_size + 10; ++i)
+    {
+        cache.get("[a-z]" + std::to_string(i), std::regex_constants::ECMAScript);
+    }
+    CHECK(cache.size() == regex_cache<char>::max_size);
+
+    CHECK_THROWS_AS(cache.get("[a-", std::regex_constants::ECMAScript), std::regex_error);
+}
@@ -138,3 +138,45 @@ TEST_CASE("jsonpath function tests")
 }
 
 
+
+TEST_CASE("jsonpath registered functions")
+{
+    json root = json::parse(R"({"values":[1.0, 1e100, 1.0, -1e100, 3, 4]})");
+
+    CHECK(json_query(root, "sum($.values[*])")[0].as<double>() == 0.0);
+
+    register_function<json>("compensated_sum", sum_function<json>(summation_kind::compensated));
+    CHECK(json_query(root, "compensated_sum($.values[*])")[0].as<double>() == 9.0);
+
+    register_function<json>("first", [](const std::vector<const json*>& nodes)
+                                     {
+                                         return nodes.empty() ? json::null() : *nodes[0];
+                                     });
+    CHECK(json_query(root, "first($.values[*])") == json::parse("[1.0]"));
+    CHECK(json_query(root, "$.values[?(@ > first($.values[*]))]") == json::parse("[1e100,3,4]"));
+
+    std::error_code ec;
+    jsoncons::jsonpath::compile<json>("unregistered($.values[*])", ec);
+    CHECK(ec == jsonpath_errc::invalid_filter_unsupported_operator);
+}
+
+TEST_CASE("jsonpath numeric aggregates")
+{
+    json values = json::array();
+    double sum = 0.0;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        double x = (i % 7) * 0.5 - 1.0;
+        values.push_back(x);
+        sum += x;
+    }
+    json root;
+    root["values"] = std::move(values);
+
+    CHECK(json_query(root, "sum($.values[*])")[0].as<double>() == Approx(sum).epsilon(1e-12));
+    CHECK(json_query(root, "avg($.values[*])")[0].as<double>() == Approx(sum/1000).epsilon(1e-12));
+    CHECK(json_query(root, "max($.values[*])")[0].as<double>() == 2.0);
+    CHECK(json_query(root, "min($.values[*])")[0].as<double>() == -1.0);
+    CHECK(json_query(root, "count($.values[*])")[0].as<size_t>() == 1000);
+    CHECK(json_query(root, "avg($.nothing[*])")[0].is_null());
+}
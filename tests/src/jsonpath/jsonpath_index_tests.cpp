@@ -0,0 +1,137 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpath/json_query.hpp>
+#include <catch/catch.hpp>
+#include <string>
+#include <vector>
+
+using namespace jsoncons;
+using namespace jsoncons::jsonpath;
+
+namespace {
+
+const std::string orders_text = R"(
+{
+    "orders": [
+        {"id": 1, "customer_id": "A", "total": 10.5},
+        {"id": 2, "customer_id": "B", "total": 3},
+        {"id": 3, "customer_id": "A", "total": 7.25},
+        {"id": 4, "customer_id": 1, "total": 1},
+        {"id": 5, "customer_id": 1.0, "total": 2},
+        {"id": 6, "total": 4},
+        {"id": 7, "customer_id": null},
+        {"id": 8, "customer_id": true},
+        {"id": 9, "customer_id": {"nested": 1}},
+        {"id": 10, "customer": {"id": "A"}}
+    ]
+}
+)";
+
+void check_same(const json& root, const jsonpath_index<json>& index, const std::string& path)
+{
+    auto expr = jsonpath::compile<json>(path);
+
+    CHECK(expr.evaluate(root, index) == expr.evaluate(root));
+    CHECK(expr.evaluate(root, index, result_type::path) == expr.evaluate(root, result_type::path));
+}
+
+}
+
+TEST_CASE("jsonpath index equality filter")
+{
+    json root = json::parse(orders_text);
+    auto index = jsonpath::build_index(root, "$.orders[*]", "@.customer_id");
+    CHECK(index.size() == 10);
+
+    SECTION("string key")
+    {
+        check_same(root, index, "$.orders[?(@.customer_id == 'A')]");
+        check_same(root, index, "$.orders[?('A' == @.customer_id)]");
+        check_same(root, index, "$.orders[?(@.customer_id == 'A')].total");
+        check_same(root, index, "$.orders[?(@.customer_id == 'Z')]");
+
+        auto expr = jsonpath::compile<json>("$.orders[?(@.customer_id == 'A')].id");
+        CHECK(expr.evaluate(root, index) == json::parse("[1,3]"));
+    }
+    SECTION("number key")
+    {
+        check_same(root, index, "$.orders[?(@.customer_id == 1)]");
+        check_same(root, index, "$.orders[?(@.customer_id == 1.0)]");
+
+        auto expr = jsonpath::compile<json>("$.orders[?(@.customer_id == 1)].id");
+        CHECK(expr.evaluate(root, index) == json::parse("[4,5]"));
+    }
+    SECTION("other keys")
+    {
+        check_same(root, index, "$.orders[?(@.customer_id == true)]");
+        check_same(root, index, "$.orders[?(@.customer_id == null)]");
+        check_same(root, index, "$.orders[?(@['customer_id'] == 'B')]");
+    }
+    SECTION("filters the index does not answer")
+    {
+        check_same(root, index, "$.orders[?(@.customer_id != 'A')]");
+        check_same(root, index, "$.orders[?(@.customer_id == 'A' && @.total > 8)]");
+        check_same(root, index, "$.orders[?(@.id == 2)]");
+    }
+}
+
+TEST_CASE("jsonpath index nested key")
+{
+    json root = json::parse(orders_text);
+    auto index = jsonpath::build_index(root, "$.orders.*", "@.customer.id");
+
+    auto expr = jsonpath::compile<json>("$.orders[?(@.customer.id == 'A')].id");
+    CHECK(expr.evaluate(root, index) == json::parse("[10]"));
+    check_same(root, index, "$.orders[?(@.customer_id == 'A')]");
+}
+
+TEST_CASE("jsonpath index refs")
+{
+    json root = json::parse(orders_text);
+    auto index = jsonpath::build_index(root, "$.orders[*]", "@.customer_id");
+
+    auto expr = jsonpath::compile<json>("$.orders[?(@.customer_id == 'B')]");
+    std::vector<const json*> refs;
+    expr.evaluate_refs(root, index, [&](const std::string&, const json& val) { refs.push_back(std::addressof(val)); });
+    REQUIRE(refs.size() == 1);
+    CHECK(refs[0] == std::addressof(root["orders"][1]));
+}
+
+TEST_CASE("jsonpath index rebuild")
+{
+    json root = json::parse(orders_text);
+    auto index = jsonpath::build_index(root, "$.orders[*]", "@.customer_id");
+    auto expr = jsonpath::compile<json>("$.orders[?(@.customer_id == 'C')].id");
+
+    CHECK(expr.evaluate(root, index) == json::array());
+
+    json order;
+    order["id"] = 11;
+    order["customer_id"] = "C";
+    root["orders"].push_back(std::move(order));
+    index.rebuild();
+    CHECK(index.size() == 11);
+    CHECK(expr.evaluate(root, index) == json::parse("[11]"));
+
+    root["orders"][0]["customer_id"] = "C";
+    index.clear();
+    CHECK(index.size() == 0);
+    CHECK(expr.evaluate(root, index) == json::parse("[1,11]"));
+}
+
+TEST_CASE("jsonpath index unsupported paths")
+{
+    json root = json::parse(orders_text);
+
+    CHECK_THROWS_AS(jsonpath::build_index(root, "$.orders", "@.customer_id"), serialization_error);
+    CHECK_THROWS_AS(jsonpath::build_index(root, "$.orders[0]", "@.customer_id"), serialization_error);
+    CHECK_THROWS_AS(jsonpath::build_index(root, "$.orders[*]", "@..customer_id"), serialization_error);
+    CHECK_THROWS_AS(jsonpath::build_index(root, "$.orders[*]", "@.customer_id[*]"), serialization_error);
+    CHECK_THROWS_AS(jsonpath::build_index(root, "$.orders[*]", "@.length"), serialization_error);
+    CHECK_THROWS_AS(jsonpath::build_index(root, "$.orders[*", "@.customer_id"), serialization_error);
+}
@@ -1400,3 +1400,87 @@ TEST_CASE("test_array_array_nested")
 
 
 
+
+TEST_CASE("test_json_query_refs")
+{
+    json root = json::parse(jsonpath_fixture::store_text());
+
+    SECTION("values are references into root")
+    {
+        std::vector<const json*> refs;
+        std::vector<std::string> paths;
+        json_query_refs(root, "$.store.book[?(@.price < 10)]", 
+                        [&](const std::string& path, const json& val)
+                        {
+                            paths.push_back(path);
+                            refs.push_back(std::addressof(val));
+                        });
+        REQUIRE(refs.size() == 2);
+        CHECK(refs[0] == std::addressof(root.at("store").at("book")[0]));
+        CHECK(refs[1] == std::addressof(root.at("store").at("book")[2]));
+        CHECK(paths[0].empty());
+    }
+
+    SECTION("normalized paths")
+    {
+        json values = json::array();
+        json paths = json::array();
+        json_query_refs(root, "$..author", 
+                        [&](const std::string& path, const json& val)
+                        {
+                            paths.push_back(path);
+                            values.push_back(val);
+                        }, 
+                        result_type::path);
+        CHECK(values == json_query(root, "$..author"));
+        CHECK(paths == json_query(root, "$..author", result_type::path));
+    }
+
+    SECTION("temporary values")
+    {
+        json values = json::array();
+        json_query_refs(root, "$.store.book.length", 
+                        [&](const std::string&, const json& val)
+                        {
+                            values.push_back(val);
+                        });
+        CHECK(values == json::parse("[4]"));
+    }
+}
+
+TEST_CASE("test_json_query_parallel")
+{
+    json products = json::array();
+    for (size_t i = 0; i < 500; ++i)
+    {
+        json product;
+        product["id"] = i;
+        product["price"] = 1.5*i;
+        product["offers"] = json::array();
+        product["offers"].push_back(json::object{{"price", 0.5*i},{"seller","a"}});
+        product["offers"].push_back(json::object{{"price", 0.25*i},{"seller","b"}});
+        products.push_back(std::move(product));
+    }
+    json root;
+    root["catalog"]["products"] = std::move(products);
+    root["catalog"]["price"] = 10;
+
+    query_options options;
+    options.max_threads(4).parallel_threshold(16);
+
+    std::vector<std::string> paths = {"$..price",
+                                      "$..offers[1].seller",
+                                      "$..['price','id']",
+                                      "$..offers[0:1]",
+                                      "$..products[?(@.id == 7)].price",
+                                      "$..[(@.length-1)]"};
+    for (const auto& path : paths)
+    {
+        CHECK(json_query(root, path, result_type::value, options) == json_query(root, path));
+        CHECK(json_query(root, path, result_type::path, options) == json_query(root, path, result_type::path));
+    }
+
+    auto expr = jsoncons::jsonpath::compile<json>("$..price");
+    CHECK(expr.evaluate(root, result_type::value, options) == json_query(root, "$..price"));
+    CHECK(expr.evaluate(root, result_type::value, options).size() == 1501);
+}
@@ -0,0 +1,151 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_staj_reader.hpp>
+#include <jsoncons_ext/jsonpath/path_projection.hpp>
+#include <jsoncons_ext/msgpack/msgpack.hpp>
+#include <catch/catch.hpp>
+#include <sstream>
+#include <vector>
+#include <utility>
+
+using namespace jsoncons;
+using namespace jsoncons::jsonpath;
+
+namespace {
+
+const std::string input = R"(
+{
+    "user" : {"id" : 10, "name" : "Tom", "tags" : ["a","b"]},
+    "items" : [
+        {"sku" : "A1", "qty" : 2, "extra" : {"x" : [1,2,3]}},
+        {"sku" : "B2", "qty" : 1},
+        {"qty" : 5}
+    ],
+    "notes" : "ignored"
+}
+)";
+
+}
+
+TEST_CASE("path_projection_filter tests")
+{
+    SECTION("jsonpath")
+    {
+        path_projection projection = {"$.user.id", "$.items[*].sku"};
+
+        json_decoder<json> decoder;
+        path_projection_filter filter(projection, decoder);
+        json_string_reader reader(input, filter);
+        reader.read();
+
+        json expected = json::parse(R"({"user":{"id":10},"items":[{"sku":"A1"},{"sku":"B2"},{}]})");
+        CHECK(decoder.get_result() == expected);
+    }
+
+    SECTION("json pointer")
+    {
+        path_projection projection = {"/user/tags", "/items/1"};
+
+        json_decoder<json> decoder;
+        path_projection_filter filter(projection, decoder);
+        json_string_reader reader(input, filter);
+        reader.read();
+
+        json expected = json::parse(R"({"user":{"tags":["a","b"]},"items":[{"sku":"B2","qty":1}]})");
+        CHECK(decoder.get_result() == expected);
+    }
+
+    SECTION("bracket notation")
+    {
+        path_projection projection = {"$['items'][0]['extra']", "$[\"notes\"]"};
+
+        json_decoder<json> decoder;
+        path_projection_filter filter(projection, decoder);
+        json_string_reader reader(input, filter);
+        reader.read();
+
+        json expected = json::parse(R"({"items":[{"extra":{"x":[1,2,3]}}],"notes":"ignored"})");
+        CHECK(decoder.get_result() == expected);
+    }
+
+    SECTION("root")
+    {
+        path_projection projection = {"$"};
+
+        json_decoder<json> decoder;
+        path_projection_filter filter(projection, decoder);
+        json_string_reader reader(input, filter);
+        reader.read();
+
+        CHECK(decoder.get_result() == json::parse(input));
+    }
+
+    SECTION("invalid paths")
+    {
+        path_projection projection;
+        std::error_code ec;
+        projection.add("$.items[*", ec);
+        CHECK(ec == jsonpath_errc::expected_right_bracket);
+        ec = std::error_code();
+        projection.add("$..sku", ec);
+        CHECK(ec == jsonpath_errc::expected_name);
+        ec = std::error_code();
+        projection.add("items", ec);
+        CHECK(ec == jsonpath_errc::expected_separator);
+    }
+}
+
+TEST_CASE("path_projection project from staj_reader")
+{
+    path_projection projection = {"$.user.id", "$.items[*].sku"};
+    json expected = json::parse(R"({"user":{"id":10},"items":[{"sku":"A1"},{"sku":"B2"},{}]})");
+
+    SECTION("json_staj_reader")
+    {
+        std::istringstream is(input);
+        json_staj_reader reader(is);
+
+        json_decoder<json> decoder;
+        project(reader, projection, decoder);
+        CHECK(decoder.get_result() == expected);
+    }
+
+    SECTION("msgpack_staj_reader")
+    {
+        std::vector<uint8_t> v;
+        msgpack::encode_msgpack(json::parse(input), v);
+        msgpack::msgpack_buffer_staj_reader reader(v);
+
+        json_decoder<json> decoder;
+        project(reader, projection, decoder);
+        CHECK(decoder.get_result() == expected);
+    }
+
+    SECTION("array elements")
+    {
+        json_staj_reader reader(std::string(R"([{"a":1,"b":[2]},{"b":3},[4]])"));
+        reader.next();
+        REQUIRE(reader.current().event_type() == staj_event_type::begin_object);
+
+        path_projection element_projection = {"/b"};
+
+        json_decoder<json> decoder1;
+        project(reader, element_projection, decoder1);
+        CHECK(decoder1.get_result() == json::parse(R"({"b":[2]})"));
+
+        reader.next();
+        json_decoder<json> decoder2;
+        project(reader, element_projection, decoder2);
+        CHECK(decoder2.get_result() == json::parse(R"({"b":3})"));
+
+        reader.next();
+        reader.skip();
+        reader.next();
+        CHECK(reader.current().event_type() == staj_event_type::end_array);
+    }
+}
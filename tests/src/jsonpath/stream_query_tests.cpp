@@ -0,0 +1,226 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_staj_reader.hpp>
+#include <jsoncons_ext/jsonpath/json_query.hpp>
+#include <jsoncons_ext/jsonpath/stream_query.hpp>
+#include <jsoncons_ext/msgpack/msgpack.hpp>
+#include <jsoncons_ext/msgpack/msgpack_staj_reader.hpp>
+#include <catch/catch.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+using namespace jsoncons;
+using namespace jsoncons::jsonpath;
+
+namespace {
+
+const std::string store = R"(
+{ "store": {
+    "book": [
+      { "category": "reference",
+        "author": "Nigel Rees",
+        "title": "Sayings of the Century",
+        "price": 8.95
+      },
+      { "category": "fiction",
+        "author": "Evelyn Waugh",
+        "title": "Sword of Honour",
+        "price": 12.99
+      },
+      { "category": "fiction",
+        "author": "Herman Melville",
+        "title": "Moby Dick",
+        "isbn": "0-553-21311-3",
+        "price": 8.99
+      },
+      { "category": "fiction",
+        "author": "J. R. R. Tolkien",
+        "title": "The Lord of the Rings",
+        "isbn": "0-395-19395-8",
+        "price": 22.99
+      }
+    ],
+    "bicycle": {
+      "color": "red",
+      "price": 19.95
+    }
+  }
+}
+)";
+
+std::vector<std::string> sorted_strings(const json& a)
+{
+    std::vector<std::string> result;
+    for (const auto& item : a.array_range())
+    {
+        result.push_back(item.is_string() ? item.as<std::string>() : item.to_string());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// The selected values, or their normalized paths, in sorted order
+std::vector<std::string> stream_strings(staj_reader& reader, const std::string& path, result_type result_t)
+{
+    json result = json::array();
+    stream_query<json>(reader, path,
+                       [&](const std::string& p, const json& val)
+                       {
+                           if (result_t == result_type::path)
+                           {
+                               result.push_back(p);
+                           }
+                           else
+                           {
+                               result.push_back(val);
+                           }
+                       },
+                       result_t);
+    return sorted_strings(result);
+}
+
+// json_query reports recursive descent matches with partial normalized paths,
+// so paths are only compared for expressions without recursive descent
+bool compare_paths(const std::string& path)
+{
+    return path.find("..") == std::string::npos;
+}
+
+const std::vector<std::string> stream_paths = {
+    "$",
+    "$.store",
+    "$.store.book[0].title",
+    "$.store.book[*].author",
+    "$['store']['book'][*]['author']",
+    "$.store.book[1:3]",
+    "$.store.book[1:]",
+    "$.store.book[::2].title",
+    "$.store.book[0,2].title",
+    "$.store.book[-1].title",
+    "$.store.book.length",
+    "$.store.*",
+    "$.store..price",
+    "$..author",
+    "$..price",
+    "$..book[2]",
+    "$..book[0,1]",
+    "$..book[:2]",
+    "$..book[-1:]",
+    "$..*",
+    "$..book[*]",
+    "$.store.book[?(@.price < 10)].title",
+    "$..book[?(@.isbn)]",
+    "$..book[?(@.price > max($..book[*].price) - 5)].title",
+    "$..book[(@.length-1)]",
+    "$..book[?(@.author =~ /.*Tolkien/)].title",
+    "$.store.bicycle[?(@.color)]",
+    "$.nothing.here",
+    "max($.store.book[*].price)"
+};
+
+}
+
+TEST_CASE("jsonpath stream_query json_staj_reader")
+{
+    json root = json::parse(store);
+
+    for (const auto& path : stream_paths)
+    {
+        std::istringstream is(store);
+        json_staj_reader reader(is);
+        CHECK(stream_strings(reader, path, result_type::value) == sorted_strings(json_query(root, path)));
+
+        if (compare_paths(path))
+        {
+            std::istringstream is2(store);
+            json_staj_reader reader2(is2);
+            CHECK(stream_strings(reader2, path, result_type::path) == sorted_strings(json_query(root, path, result_type::path)));
+        }
+    }
+}
+
+TEST_CASE("jsonpath stream_query msgpack_staj_reader")
+{
+    json root = json::parse(store);
+    std::vector<uint8_t> data;
+    msgpack::encode_msgpack(root, data);
+
+    for (const auto& path : stream_paths)
+    {
+        msgpack::msgpack_buffer_staj_reader reader(data);
+        CHECK(stream_strings(reader, path, result_type::value) == sorted_strings(json_query(root, path)));
+
+        if (compare_paths(path))
+        {
+            msgpack::msgpack_buffer_staj_reader reader2(data);
+            CHECK(stream_strings(reader2, path, result_type::path) == sorted_strings(json_query(root, path, result_type::path)));
+        }
+    }
+}
+
+TEST_CASE("jsonpath stream_query document order")
+{
+    std::istringstream is(store);
+    json_staj_reader reader(is);
+
+    std::vector<std::string> titles;
+    stream_query<json>(reader, "$.store.book[*].title",
+                       [&](const std::string&, const json& val)
+                       {
+                           titles.push_back(val.as<std::string>());
+                       });
+
+    std::vector<std::string> expected = {"Sayings of the Century", "Sword of Honour",
+                                         "Moby Dick", "The Lord of the Rings"};
+    CHECK(titles == expected);
+}
+
+TEST_CASE("jsonpath stream_query recursive descent paths")
+{
+    std::istringstream is(store);
+    json_staj_reader reader(is);
+
+    std::vector<std::string> expected = {"$['store']['bicycle']['price']",
+                                         "$['store']['book'][0]['price']",
+                                         "$['store']['book'][1]['price']",
+                                         "$['store']['book'][2]['price']",
+                                         "$['store']['book'][3]['price']"};
+    CHECK(stream_strings(reader, "$..price", result_type::path) == expected);
+}
+
+TEST_CASE("jsonpath stream_query errors")
+{
+    SECTION("invalid path")
+    {
+        std::istringstream is(store);
+        json_staj_reader reader(is);
+
+        std::error_code ec;
+        stream_query<json>(reader, "$.store['book' 0]",
+                           [](const std::string&, const json&){},
+                           result_type::value, ec);
+        CHECK(ec == jsonpath_errc::expected_right_bracket);
+
+        REQUIRE_THROWS_AS(stream_query<json>(reader, "$store", [](const std::string&, const json&){}),
+                          serialization_error);
+    }
+    SECTION("invalid input")
+    {
+        std::istringstream is(R"({"store":{"book":[1,2)");
+        json_staj_reader reader(is);
+
+        std::error_code ec;
+        stream_query<json>(reader, "$.store.book[*]",
+                           [](const std::string&, const json&){},
+                           result_type::value, ec);
+        CHECK(ec);
+    }
+}
@@ -0,0 +1,180 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpointer/jsonpointer.hpp>
+#include <catch/catch.hpp>
+#include <string>
+#include <vector>
+
+using namespace jsoncons;
+
+namespace {
+
+const json example = json::parse(R"(
+   {
+      "foo": ["bar", "baz"],
+      "": 0,
+      "a/b": 1,
+      "c%d": 2,
+      "e^f": 3,
+      "g|h": 4,
+      "i\\j": 5,
+      "k\"l": 6,
+      " ": 7,
+      "m~n": 8,
+      "01": 9
+   }
+)");
+
+}
+
+TEST_CASE("json_pointer parse")
+{
+    SECTION("tokens are unescaped")
+    {
+        jsonpointer::json_pointer ptr("/m~0n/a~1b/~01");
+        REQUIRE(ptr.size() == 3);
+        CHECK(ptr[0] == "m~n");
+        CHECK(ptr[1] == "a/b");
+        CHECK(ptr[2] == "~1");
+        CHECK(ptr.to_string() == "/m~0n/a~1b/~01");
+    }
+    SECTION("whole document")
+    {
+        jsonpointer::json_pointer ptr("");
+        CHECK(ptr.empty());
+        CHECK(ptr.to_string().empty());
+        CHECK(ptr == jsonpointer::json_pointer());
+    }
+    SECTION("empty tokens")
+    {
+        jsonpointer::json_pointer ptr("//");
+        REQUIRE(ptr.size() == 2);
+        CHECK(ptr[0].empty());
+        CHECK(ptr[1].empty());
+    }
+    SECTION("errors")
+    {
+        std::error_code ec;
+        jsonpointer::json_pointer ptr("foo", ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::expected_slash);
+
+        jsonpointer::json_pointer ptr2("/a~2", ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::expected_0_or_1);
+
+        CHECK_THROWS_AS(jsonpointer::json_pointer("/a~"), jsonpointer::jsonpointer_error);
+    }
+}
+
+TEST_CASE("json_pointer append")
+{
+    jsonpointer::json_pointer ptr;
+    ptr /= "a/b";
+    ptr /= 10;
+    auto ptr2 = ptr / "m~n" / 0;
+
+    CHECK(ptr.to_string() == "/a~1b/10");
+    CHECK(ptr2.to_string() == "/a~1b/10/m~0n/0");
+    CHECK(ptr2 == jsonpointer::json_pointer("/a~1b/10/m~0n/0"));
+    CHECK(ptr2 != ptr);
+}
+
+TEST_CASE("json_pointer get")
+{
+    std::vector<std::string> pointers = {"", "/foo", "/foo/0", "/foo/1", "/", "/a~1b", "/c%d", "/e^f", 
+                                         "/g|h", "/i\\j", "/k\"l", "/ ", "/m~0n", "/01"};
+    for (const auto& s : pointers)
+    {
+        jsonpointer::json_pointer ptr(s);
+        CHECK(jsonpointer::get(example, ptr) == jsonpointer::get(example, s));
+        CHECK(jsonpointer::contains(example, ptr));
+    }
+
+    SECTION("errors")
+    {
+        std::error_code ec;
+        jsonpointer::get(example, jsonpointer::json_pointer("/foo/2"), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::index_exceeds_array_size);
+        jsonpointer::get(example, jsonpointer::json_pointer("/foo/01"), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::unexpected_leading_zero);
+        jsonpointer::get(example, jsonpointer::json_pointer("/foo/x"), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::expected_digit_or_dash);
+        jsonpointer::get(example, jsonpointer::json_pointer("/foo/-"), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::index_exceeds_array_size);
+        jsonpointer::get(example, jsonpointer::json_pointer("/bar"), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::name_not_found);
+        jsonpointer::get(example, jsonpointer::json_pointer("/foo/0/0"), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::expected_object_or_array);
+
+        CHECK_FALSE(jsonpointer::contains(example, jsonpointer::json_pointer("/foo/2")));
+        CHECK_THROWS_AS(jsonpointer::get(example, jsonpointer::json_pointer("/bar")), jsonpointer::jsonpointer_error);
+    }
+}
+
+TEST_CASE("json_pointer get by reference")
+{
+    json doc = example;
+    json& val = jsonpointer::get(doc, jsonpointer::json_pointer("/foo") / 1);
+    val = "qux";
+    CHECK(doc["foo"][1] == json("qux"));
+}
+
+TEST_CASE("json_pointer modify")
+{
+    json doc = json::parse(R"({"foo": ["bar", "baz"], "qux": {"a": 1}})");
+    jsonpointer::json_pointer foo("/foo");
+
+    SECTION("insert_or_assign")
+    {
+        jsonpointer::insert_or_assign(doc, foo / 1, json("x"));
+        jsonpointer::insert_or_assign(doc, foo / "-", json("y"));
+        jsonpointer::insert_or_assign(doc, jsonpointer::json_pointer("/qux/a"), json(2));
+        jsonpointer::insert_or_assign(doc, jsonpointer::json_pointer("/qux/b"), json(3));
+        CHECK(doc == json::parse(R"({"foo": ["bar", "x", "baz", "y"], "qux": {"a": 2, "b": 3}})"));
+
+        std::error_code ec;
+        jsonpointer::insert_or_assign(doc, foo / 5, json("z"), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::index_exceeds_array_size);
+    }
+    SECTION("insert")
+    {
+        std::error_code ec;
+        jsonpointer::insert(doc, jsonpointer::json_pointer("/qux/a"), json(2), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::key_already_exists);
+        jsonpointer::insert(doc, foo / 2, json("x"));
+        CHECK(doc["foo"] == json::parse(R"(["bar", "baz", "x"])"));
+    }
+    SECTION("remove")
+    {
+        jsonpointer::remove(doc, foo / 0);
+        jsonpointer::remove(doc, jsonpointer::json_pointer("/qux/a"));
+        CHECK(doc == json::parse(R"({"foo": ["baz"], "qux": {}})"));
+
+        std::error_code ec;
+        jsonpointer::remove(doc, foo / "-", ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::index_exceeds_array_size);
+        jsonpointer::remove(doc, jsonpointer::json_pointer("/qux/a"), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::name_not_found);
+    }
+    SECTION("replace")
+    {
+        jsonpointer::replace(doc, foo / 1, json("x"));
+        CHECK(doc["foo"][1] == json("x"));
+
+        std::error_code ec;
+        jsonpointer::replace(doc, jsonpointer::json_pointer("/qux/b"), json(1), ec);
+        CHECK(ec == jsonpointer::jsonpointer_errc::name_not_found);
+    }
+}
+
+TEST_CASE("wjson_pointer")
+{
+    wjson doc = wjson::parse(LR"({"a~b": [1, 2]})");
+    jsonpointer::wjson_pointer ptr(L"/a~0b");
+    CHECK(jsonpointer::get(doc, ptr / 1) == wjson(2));
+    CHECK(ptr.to_string() == L"/a~0b");
+}
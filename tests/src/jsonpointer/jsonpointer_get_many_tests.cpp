@@ -0,0 +1,96 @@
+// Copyright 2019 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpointer/jsonpointer.hpp>
+#include <catch/catch.hpp>
+#include <string>
+#include <vector>
+
+using namespace jsoncons;
+
+namespace {
+
+const std::string input = R"(
+{
+    "a": {
+        "b": {
+            "c": {"x": 1, "y": 2},
+            "d": [10, 20, 30]
+        },
+        "e": "f"
+    },
+    "g": [{"h": true}, {"h": false}]
+}
+)";
+
+template <class Json>
+void check_get_many(const Json& doc, const std::vector<std::string>& pointers)
+{
+    std::vector<jsonpointer::get_result<const Json>> results;
+    jsonpointer::get_many(doc, pointers, results);
+    REQUIRE(results.size() == pointers.size());
+
+    for (size_t i = 0; i < pointers.size(); ++i)
+    {
+        std::error_code ec;
+        jsonpointer::json_pointer ptr(pointers[i], ec);
+        const Json& expected = ec ? doc : jsonpointer::get(doc, ptr, ec);
+        CHECK(bool(results[i].ec) == bool(ec));
+        CHECK(results[i].ec.value() == ec.value());
+        if (!ec)
+        {
+            CHECK(jsonpointer::get(doc, pointers[i]) == expected);
+            REQUIRE(results[i].value != nullptr);
+            CHECK(results[i].value == std::addressof(expected));
+        }
+        else
+        {
+            CHECK(results[i].value == nullptr);
+        }
+    }
+}
+
+}
+
+TEST_CASE("jsonpointer get_many")
+{
+    std::vector<std::string> pointers = {"/a/b/c/x", "/a/b/c/y", "/a/b/d", "/a/b/d/2", "/a/e", "/g/1/h",
+                                         "/g/0/h", "", "/a/b/c/x", "/a/b/c/z", "/a/b/d/3", "/a/b/d/01", 
+                                         "/a/b/d/-", "/a/e/f", "/a/b/c/x/y", "/q/r", "a", "/a~2"};
+
+    SECTION("json")
+    {
+        check_get_many(json::parse(input), pointers);
+    }
+    SECTION("ojson")
+    {
+        check_get_many(ojson::parse(input), pointers);
+    }
+}
+
+TEST_CASE("jsonpointer get_many json_pointer")
+{
+    json doc = json::parse(input);
+
+    std::vector<jsonpointer::json_pointer> pointers;
+    jsonpointer::json_pointer b("/a/b");
+    pointers.push_back(b / "c" / "x");
+    pointers.push_back(b / "d" / 1);
+    pointers.push_back(b / "c" / "w");
+
+    std::vector<jsonpointer::get_result<json>> results;
+    jsonpointer::get_many(doc, pointers, results);
+    REQUIRE(results.size() == 3);
+
+    REQUIRE(results[0].value != nullptr);
+    CHECK(*results[0].value == json(1));
+    REQUIRE(results[1].value != nullptr);
+    *results[1].value = 21;
+    CHECK(doc["a"]["b"]["d"][1] == json(21));
+    CHECK(results[2].value == nullptr);
+    CHECK(results[2].ec == jsonpointer::jsonpointer_errc::name_not_found);
+}
@@ -0,0 +1,268 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#if defined(_MSC_VER)
+#include "windows.h" // test no inadvertant macro expansions
+#endif
+#include <jsoncons/json.hpp>
+#include <jsoncons/staj_iterator.hpp>
+#include <jsoncons_ext/msgpack/msgpack.hpp>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <utility>
+#include <ctime>
+#include <limits>
+#include <catch/catch.hpp>
+
+using namespace jsoncons;
+using namespace jsoncons::msgpack;
+
+TEST_CASE("msgpack_staj_reader events")
+{
+    ojson j = ojson::parse(R"(
+    {
+        "name" : "Tom",
+        "age" : 55,
+        "balance" : -12,
+        "ratio" : 0.5,
+        "tags" : ["a", true, null]
+    }
+    )");
+
+    std::vector<uint8_t> v;
+    encode_msgpack(j, v);
+
+    msgpack_buffer_staj_reader reader(v);
+
+    std::vector<staj_event_type> expected = {staj_event_type::begin_object,
+        staj_event_type::name, staj_event_type::string_value,
+        staj_event_type::name, staj_event_type::uint64_value,
+        staj_event_type::name, staj_event_type::int64_value,
+        staj_event_type::name, staj_event_type::double_value,
+        staj_event_type::name, staj_event_type::begin_array,
+        staj_event_type::string_value, staj_event_type::bool_value, staj_event_type::null_value,
+        staj_event_type::end_array,
+        staj_event_type::end_object};
+
+    std::vector<staj_event_type> actual;
+    for (; !reader.done(); reader.next())
+    {
+        actual.push_back(reader.current().event_type());
+    }
+    actual.push_back(reader.current().event_type());
+    CHECK(actual == expected);
+}
+
+TEST_CASE("msgpack_staj_reader staj_array_iterator")
+{
+    json j = json::parse(R"(
+    [
+        {"enrollmentNo" : 100, "firstName" : "Tom", "mark" : 55},
+        {"enrollmentNo" : 101, "firstName" : "Catherine", "mark" : 95},
+        {"enrollmentNo" : 102, "firstName" : "William", "mark" : 60}
+    ]
+    )");
+
+    std::vector<uint8_t> v;
+    encode_msgpack(j, v);
+
+    SECTION("decode elements to json")
+    {
+        msgpack_buffer_staj_reader reader(v);
+        staj_array_iterator<json> it(reader);
+
+        std::vector<json> elements;
+        for (const auto& val : it)
+        {
+            elements.push_back(val);
+        }
+        REQUIRE(elements.size() == 3);
+        CHECK(elements[0] == j[0]);
+        CHECK(elements[2] == j[2]);
+    }
+
+    SECTION("decode elements to map")
+    {
+        std::string s(v.begin(), v.end());
+        std::istringstream is(s);
+        msgpack_staj_reader reader(is);
+        staj_array_iterator<std::map<std::string,json>> it(reader);
+
+        std::vector<std::map<std::string,json>> records;
+        for (const auto& record : it)
+        {
+            records.push_back(record);
+        }
+        REQUIRE(records.size() == 3);
+        CHECK(records[1].at("firstName").as<std::string>() == "Catherine");
+        CHECK(records[1].at("mark").as<int>() == 95);
+    }
+}
+
+TEST_CASE("msgpack_staj_reader decode_stream")
+{
+    std::vector<double> u = {1.5, -2.0, 1000000.25};
+    json j(u);
+
+    std::vector<uint8_t> v;
+    encode_msgpack(j, v);
+
+    msgpack_buffer_staj_reader reader(v);
+    std::vector<double> w;
+    decode_stream(reader, w);
+    CHECK(w == u);
+}
+
+TEST_CASE("msgpack_staj_reader skip unwanted elements")
+{
+    json j = json::parse(R"(
+    [
+        {"id" : 1, "payload" : [1,2,[3,4,{"x":"y"}],"long string that is not small"]},
+        "skip me",
+        {"id" : 2, "payload" : {"a":{"b":[]},"c":-1000000,"d":1.5}}
+    ]
+    )");
+
+    std::vector<uint8_t> v;
+    encode_msgpack(j, v);
+
+    msgpack_buffer_staj_reader reader(v);
+    REQUIRE(reader.current().event_type() == staj_event_type::begin_array);
+
+    std::vector<int> ids;
+    std::vector<staj_event_type> events;
+    for (reader.next(); !reader.done(); reader.next())
+    {
+        const auto& event = reader.current();
+        events.push_back(event.event_type());
+        if (event.event_type() == staj_event_type::name && event.as<std::string>() == "id")
+        {
+            reader.next();
+            ids.push_back(reader.current().as<int>());
+            events.push_back(reader.current().event_type());
+        }
+        else if (event.event_type() == staj_event_type::name && event.as<std::string>() == "payload")
+        {
+            reader.next();
+            REQUIRE((reader.current().event_type() == staj_event_type::begin_array || 
+                     reader.current().event_type() == staj_event_type::begin_object));
+            reader.skip();
+            CHECK((reader.current().event_type() == staj_event_type::end_array || 
+                   reader.current().event_type() == staj_event_type::end_object));
+        }
+    }
+    CHECK(reader.current().event_type() == staj_event_type::end_array);
+
+    CHECK(ids == std::vector<int>{1,2});
+
+    // None of the events inside the payloads are delivered
+    std::vector<staj_event_type> expected = {
+        staj_event_type::begin_object,
+        staj_event_type::name, staj_event_type::uint64_value,
+        staj_event_type::name,
+        staj_event_type::end_object,
+        staj_event_type::string_value,
+        staj_event_type::begin_object,
+        staj_event_type::name, staj_event_type::uint64_value,
+        staj_event_type::name,
+        staj_event_type::end_object};
+    CHECK(events == expected);
+}
+
+TEST_CASE("msgpack_staj_reader skip_to_end_of_container")
+{
+    json j = json::parse(R"({"a":[1,[2,3],"x"],"b":{"c":true,"d":[4]},"e":5})");
+
+    std::vector<uint8_t> v;
+    encode_msgpack(j, v);
+
+    msgpack_buffer_staj_reader reader(v);
+    reader.next(); // "a"
+    reader.next(); // begin_array
+    reader.next(); // 1
+    REQUIRE(reader.current().as<int>() == 1);
+    reader.skip_to_end_of_container();
+    CHECK(reader.current().event_type() == staj_event_type::end_array);
+    reader.next();
+    CHECK(reader.current().as<std::string>() == "b");
+    reader.next(); // begin_object
+    reader.next(); // "c"
+    reader.skip_to_end_of_container();
+    CHECK(reader.current().event_type() == staj_event_type::end_object);
+    reader.next();
+    CHECK(reader.current().as<std::string>() == "e");
+    reader.next();
+    CHECK(reader.current().as<int>() == 5);
+    reader.next();
+    CHECK(reader.current().event_type() == staj_event_type::end_object);
+    CHECK(reader.done());
+}
+
+TEST_CASE("msgpack_staj_reader accept stops when handler returns false")
+{
+    json j = json::parse(R"([[1,2,3],4])");
+
+    std::vector<uint8_t> v;
+    encode_msgpack(j, v);
+
+    msgpack_buffer_staj_reader reader(v);
+    reader.next();
+    REQUIRE(reader.current().event_type() == staj_event_type::begin_array);
+
+    // json_decoder returns false once the nested array is complete
+    json_decoder<json> decoder;
+    reader.accept(decoder);
+    CHECK(decoder.get_result() == json::parse("[1,2,3]"));
+
+    reader.next();
+    CHECK(reader.current().as<int>() == 4);
+}
+
+TEST_CASE("msgpack_staj_reader byte strings and long strings")
+{
+    json j = json::array();
+    j.push_back(json(byte_string({'H','e','l','l','o'})));
+    j.push_back(std::string(200,'x'));
+    j.push_back(std::string(70000,'y'));
+
+    std::vector<uint8_t> v;
+    encode_msgpack(j, v);
+
+    msgpack_buffer_staj_reader reader(v);
+    reader.next();
+    REQUIRE(reader.current().event_type() == staj_event_type::byte_string_value);
+    CHECK(reader.current().as<byte_string>() == byte_string({'H','e','l','l','o'}));
+    reader.next();
+    CHECK(reader.current().as<std::string>() == std::string(200,'x'));
+    reader.next();
+    CHECK(reader.current().as<std::string>().size() == 70000);
+    reader.next();
+    CHECK(reader.current().event_type() == staj_event_type::end_array);
+    CHECK(reader.done());
+}
+
+TEST_CASE("msgpack_staj_reader errors")
+{
+    SECTION("truncated")
+    {
+        std::vector<uint8_t> v = {0x92,0x01};
+        std::error_code ec;
+        msgpack_buffer_staj_reader reader(v, ec);
+        REQUIRE(!ec);
+        reader.next(ec);
+        REQUIRE(!ec);
+        reader.next(ec);
+        CHECK(ec == msgpack_errc::unexpected_eof);
+    }
+    SECTION("non-string key")
+    {
+        std::vector<uint8_t> v = {0x81,0x01,0x01};
+        std::error_code ec;
+        msgpack_buffer_staj_reader reader(v, ec);
+        REQUIRE(!ec);
+        reader.next(ec);
+        CHECK(ec == msgpack_errc::expected_name);
+    }
+}
+
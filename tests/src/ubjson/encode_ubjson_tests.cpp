@@ -11,6 +11,7 @@
 #include <utility>
 #include <ctime>
 #include <limits>
+#include <algorithm>
 #include <catch/catch.hpp>
 
 using namespace jsoncons;
@@ -176,3 +177,93 @@ TEST_CASE("encode indefinite length ubjson arrays and maps")
     }
 }
 
+namespace {
+
+// Values around the length and integer limits of the encoding
+json make_ubjson_limit_values()
+{
+    json j = json::array();
+    const int64_t ints[] = {0, 23, 24, 31, 32, 127, 128, 255, 256, 32767, 32768, 65535, 65536,
+                            2147483647LL, 2147483648LL, 4294967295LL, 4294967296LL,
+                            -1, -24, -25, -32, -33, -128, -129, -256, -257, -32768, -32769, 
+                            -65536, -65537, -2147483647LL - 1, -2147483647LL - 2,
+                            (std::numeric_limits<int64_t>::max)(), (std::numeric_limits<int64_t>::lowest)()};
+    for (auto val : ints)
+    {
+        j.push_back(val);
+    }
+    j.push_back(static_cast<uint64_t>(4294967296ULL));
+    j.push_back(1.5);
+    j.push_back(0.1);
+    j.push_back(true);
+    j.push_back(json::null());
+    const size_t lengths[] = {0, 15, 16, 23, 24, 31, 32, 255, 256, 32767, 32768, 65535, 65536};
+    json members;
+    for (auto length : lengths)
+    {
+        j.push_back(std::string(length, 'a'));
+        std::vector<uint8_t> bytes(length, 'b');
+        j.push_back(json(byte_string(bytes.data(), bytes.size())));
+        json items = json::array();
+        for (size_t i = 0; i < length && i < 300; ++i)
+        {
+            items.push_back(i);
+        }
+        j.push_back(items);
+        members[std::string(length, 'k')] = length;
+    }
+    j.push_back(members);
+    j.push_back(json::object());
+    j.push_back(json::parse("{\"\\u20ac\":[\"\\u00e9t\\u00e9\",[],{}]}"));
+    return j;
+}
+
+}
+
+TEST_CASE("encode_ubjson sizes the output exactly")
+{
+    json j = make_ubjson_limit_values();
+
+    // The serializer writes the same bytes without sizing them first
+    std::vector<uint8_t> expected;
+    {
+        ubjson_buffer_serializer serializer(expected);
+        j.dump(serializer);
+    }
+
+    SECTION("empty buffer")
+    {
+        std::vector<uint8_t> v;
+        encode_ubjson(j, v);
+        CHECK(v == expected);
+    }
+
+    SECTION("buffer with data")
+    {
+        std::vector<uint8_t> v = {1,2,3};
+        encode_ubjson(j, v);
+        REQUIRE(v.size() == expected.size() + 3);
+        CHECK(std::equal(expected.begin(), expected.end(), v.begin() + 3));
+    }
+
+    SECTION("wide characters")
+    {
+        json_decoder<wjson> decoder;
+        basic_utf8_adaptor<wchar_t> adaptor(decoder);
+        j.dump(adaptor);
+        wjson wj = decoder.get_result();
+        std::vector<uint8_t> v;
+        encode_ubjson(wj, v);
+        CHECK(v == expected);
+    }
+
+    SECTION("invalid UTF-8")
+    {
+        json bad = json::array();
+        bad.push_back("a");
+        bad.push_back(std::string("\xff"));
+        std::vector<uint8_t> v = {1,2,3};
+        CHECK_THROWS(encode_ubjson(bad, v));
+        CHECK(v == std::vector<uint8_t>{1,2,3});
+    }
+}